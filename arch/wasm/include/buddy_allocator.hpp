@@ -6,6 +6,12 @@
 // as described in
 // https://github.com/miguelperes/custom-malloc
 //
+// Free blocks are kept on one circular doubly linked list per order (block
+// size 2^order), and a bitmap of which orders are non-empty. malloc picks the
+// smallest non-empty order that fits with one bit scan and splits it down;
+// free merges with its buddy while the buddy is free, unlinking it in O(1).
+// Both are O(log heap) no matter how fragmented the heap is.
+//
 // Block header layout — three size_t words immediately before the pointer
 // returned to the caller:
 //
@@ -15,10 +21,11 @@
 //                           caller's original request size when ALLOCATED
 //
 // Slot [ptr-1] (BLKHDR_PAYLOAD) is safely reused because:
-//   - when a block is on the free list, it holds the prev pointer
+//   - when a block is on a free list, it holds the prev pointer
 //   - when a block is allocated, remove_block sets BLKHDR_NEXT to 0 and
 //     malloc immediately writes the request size into BLKHDR_PAYLOAD before
 //     returning — so free() can always recover the original size from there
+// The lists are circular, so a free block's next pointer is never 0.
 
 #define BLKHDR_SIZE(b) (((size_t *)(b))[0])
 #define BLKHDR_NEXT(b) (((size_t *)(b))[1])
@@ -48,10 +55,14 @@
 #endif
 
 struct BuddyAllocator {
+  // one free list per block order; orders below min_block_size stay empty
+  static constexpr int num_orders = sizeof(size_t) * 8;
+
   unsigned char *heap_base_ptr;
-  size_t first_free;
+  size_t free_heads[num_orders] = {}; // 0 when the order has no free block
+  size_t free_orders;                 // bit k set when free_heads[k] != 0
   size_t root_size;
-  int status; // 0 = uninitialized, 1 = active, 2 = exhausted
+  int status; // 0 = uninitialized, 1 = active
 
   size_t live_alloc_count_;
   size_t live_useful_bytes_;
@@ -97,7 +108,7 @@ struct BuddyAllocator {
 
   explicit BuddyAllocator(unsigned char *base,
                           [[maybe_unused]] size_t buf_bytes)
-      : heap_base_ptr(base), first_free((size_t)base), root_size(initial_root),
+      : heap_base_ptr(base), free_orders(0), root_size(initial_root),
         status(0), live_alloc_count_(0), live_useful_bytes_(0),
         live_block_bytes_(0)
 #ifndef WASM_MEMORY_BACKEND
@@ -139,60 +150,115 @@ struct BuddyAllocator {
       memory_grow((int)((total >> 16) - (size >> 16) + 1));
   }
 
+  // order of a power of 2 block size
+  static int order_of(size_t size) {
+    return __builtin_ctzll((unsigned long long)size);
+  }
+
+  // smallest order whose blocks hold n bytes, header included
+  static int order_for(size_t n) {
+    if (n <= min_block_size)
+      return order_of(min_block_size);
+    return (int)(sizeof(unsigned long long) * 8) -
+           __builtin_clzll((unsigned long long)(n - 1));
+  }
+
   void link_block(size_t before, size_t after) {
     BLKHDR_NEXT(before) = after;
     BLKHDR_PAYLOAD(after) = before;
   }
 
+  // Pushes a block onto the front of its order's list, so the most recently
+  // freed block of a size is the first one reused.
+  void insert_block(size_t block) {
+    int order = order_of(BLKHDR_SIZE(block));
+    size_t head = free_heads[order];
+    if (head == 0) {
+      link_block(block, block);
+      free_orders |= (size_t)1 << order;
+    } else {
+      link_block(BLKHDR_PAYLOAD(head), block);
+      link_block(block, head);
+    }
+    free_heads[order] = block;
+  }
+
   void remove_block(size_t block) {
+    int order = order_of(BLKHDR_SIZE(block));
     size_t before = BLKHDR_PAYLOAD(block);
     size_t after = BLKHDR_NEXT(block);
-    link_block(before, after);
-    if (first_free == block) {
-      first_free = BLKHDR_NEXT(block);
-      if (first_free == block)
-        status = 2;
+    if (after == block) {
+      free_heads[order] = 0;
+      free_orders &= ~((size_t)1 << order);
+    } else {
+      link_block(before, after);
+      if (free_heads[order] == block)
+        free_heads[order] = after;
     }
     BLKHDR_NEXT(block) = 0;
   }
 
-  void append_tail(size_t r) {
-    if (status == 2) {
-      first_free = r;
-      link_block(first_free, first_free);
-      return;
+  // Doubles the heap: the new upper half becomes one free block.
+  void grow_root() {
+    ensure_root_size(root_size << 1);
+    size_t big_block = (size_t)heap_base_ptr + root_size;
+    BLKHDR_SIZE(big_block) = root_size;
+    insert_block(big_block);
+    BUDDY_POISON((void *)(big_block + HDR), root_size - HDR);
+    root_size <<= 1;
+  }
+
+  void *take_block(int order) {
+    int found = order + __builtin_ctzll(
+                            (unsigned long long)(free_orders >> order));
+    size_t cur = free_heads[found];
+    remove_block(cur);
+    // split the block down to the requested order
+    while (found > order) {
+      found--;
+      size_t cur_size = (size_t)1 << found;
+      size_t sibling = cur + cur_size;
+      // The sibling's header [sibling, sibling+HDR) sits inside the parent
+      // block's user payload, which may be poisoned (freed earlier).
+      // Unpoison it before the header write; re-poison the sibling's own
+      // user payload afterwards.
+      BUDDY_UNPOISON((void *)sibling, HDR);
+      BLKHDR_SIZE(sibling) = BLKHDR_SIZE(cur) = cur_size;
+      insert_block(sibling);
+      BUDDY_POISON((void *)(sibling + HDR), cur_size - HDR);
     }
-    size_t second_free = BLKHDR_NEXT(first_free);
-    link_block(first_free, r);
-    link_block(r, second_free);
+    return (void *)(cur + HDR);
   }
 
-  void *search_block(size_t n) {
-    size_t cur = first_free;
-    do {
-      size_t cur_size = BLKHDR_SIZE(cur);
-      size_t next = BLKHDR_NEXT(cur);
-      if (cur_size < n) {
-        cur = next;
+  // Whether the block at r can reach the given order by merging with the
+  // free blocks to its right, doubling the heap when r is all of it.
+  bool can_grow_in_place(size_t r, int order) const {
+    const size_t root = (size_t)heap_base_ptr;
+    size_t want = (size_t)1 << order;
+    for (size_t size = BLKHDR_SIZE(r); size < want; size <<= 1) {
+      // r must stay the left half of every merged block
+      if ((r - root) & size)
+        return false;
+      if (size >= root_size)
         continue;
-      }
-      // split the block while it's too large but still above minimum size
-      while (cur_size > min_block_size && 2 * n <= cur_size) {
-        cur_size >>= 1;
-        size_t sibling = cur + cur_size;
-        // The sibling's header [sibling, sibling+HDR) sits inside the parent
-        // block's user payload, which may be poisoned (freed earlier).
-        // Unpoison it before the header write; re-poison the sibling's own
-        // user payload afterwards.
-        BUDDY_UNPOISON((void *)sibling, HDR);
-        BLKHDR_SIZE(sibling) = BLKHDR_SIZE(cur) = cur_size;
-        append_tail(sibling);
-        BUDDY_POISON((void *)(sibling + HDR), cur_size - HDR);
-      }
-      remove_block(cur);
-      return (void *)(cur + HDR);
-    } while (cur != first_free);
-    return nullptr;
+      size_t sibling = r + size;
+      if (BLKHDR_NEXT(sibling) == 0 || BLKHDR_SIZE(sibling) != size)
+        return false;
+    }
+    return true;
+  }
+
+  void grow_in_place(size_t r, int order) {
+    size_t want = (size_t)1 << order;
+    size_t size = BLKHDR_SIZE(r);
+    live_block_bytes_ -= size;
+    for (; size < want; size <<= 1) {
+      if (size >= root_size)
+        grow_root();
+      remove_block(r + size);
+      BLKHDR_SIZE(r) = size << 1;
+    }
+    live_block_bytes_ += size;
   }
 
   void track_alloc(void *result, size_t useful_n) {
@@ -222,37 +288,17 @@ struct BuddyAllocator {
     if (status == 0) {
       status = 1;
       ensure_root_size(root_size);
-      BLKHDR_SIZE(first_free) = root_size;
-      link_block(first_free, first_free);
-      BUDDY_POISON((void *)(first_free + HDR), root_size - HDR);
+      size_t root = (size_t)heap_base_ptr;
+      BLKHDR_SIZE(root) = root_size;
+      insert_block(root);
+      BUDDY_POISON((void *)(root + HDR), root_size - HDR);
     }
-    // all memory used: expand
-    if (status == 2) {
-      status = 1;
-      ensure_root_size(root_size << 1);
-      first_free = (size_t)heap_base_ptr + root_size;
-      BLKHDR_SIZE(first_free) = root_size;
-      link_block(first_free, first_free);
-      BUDDY_POISON((void *)(first_free + HDR), root_size - HDR);
-      root_size <<= 1;
-    }
-    void *result = search_block(n);
-    if (result != nullptr) {
-      track_alloc(result, useful_n);
-      return result;
-    }
-    // memory available but no block large enough: expand
-    do {
-      ensure_root_size(root_size << 1);
-      size_t big_block = (size_t)heap_base_ptr + root_size;
-      BLKHDR_SIZE(big_block) = root_size;
-      append_tail(big_block);
-      BUDDY_POISON((void *)(big_block + HDR), root_size - HDR);
-      root_size <<= 1;
-    } while ((root_size >> 1) < n);
-    result = search_block(n);
-    if (result != nullptr)
-      track_alloc(result, useful_n);
+    int order = order_for(n);
+    // no free block large enough: expand
+    while ((free_orders >> order) == 0)
+      grow_root();
+    void *result = take_block(order);
+    track_alloc(result, useful_n);
     return result;
   }
 
@@ -263,6 +309,37 @@ struct BuddyAllocator {
     return mem;
   }
 
+  // Grows in place when the blocks to the right are free, and keeps the block
+  // when shrinking. Otherwise moves to a new block.
+  void *realloc(void *p, size_t n) {
+    if (p == nullptr)
+      return malloc(n);
+    if (n == 0) {
+      free(p);
+      return nullptr;
+    }
+    size_t r = (size_t)p - HDR;
+    size_t old_n = BLKHDR_PAYLOAD(r);
+    size_t need = -((-n) & ~(sizeof(size_t) - 1)) + HDR;
+    if (BLKHDR_SIZE(r) < need) {
+      int order = order_for(need);
+      if (!can_grow_in_place(r, order)) {
+        void *result = malloc(n);
+        memcpy(result, p, old_n < n ? old_n : n);
+        free(p);
+        return result;
+      }
+      grow_in_place(r, order);
+    }
+    BLKHDR_PAYLOAD(r) = n;
+    live_useful_bytes_ = live_useful_bytes_ - old_n + n;
+    size_t block_payload = BLKHDR_SIZE(r) - HDR;
+    BUDDY_UNPOISON(p, n);
+    if (block_payload > n)
+      BUDDY_POISON((unsigned char *)p + n, block_payload - n);
+    return p;
+  }
+
   void free(void *p) {
     if (p == nullptr)
       return;
@@ -296,7 +373,7 @@ struct BuddyAllocator {
         r = sibling;
       BLKHDR_SIZE(r) = r_size = r_size << 1;
     }
-    append_tail(r);
+    insert_block(r);
   }
 
   // ── counters ──────────────────────────────────────────────────────────────
@@ -0,0 +1,294 @@
+#pragma once
+#include "buddy_allocator.hpp"
+
+// Size class slab front end for BuddyAllocator.
+//
+// Requests up to max_small bytes are rounded up to one of a few size classes
+// and served from slabs: slab_size byte buddy blocks cut into equal objects.
+// Objects carry no header, a free object holds the link of its slab's free
+// list in its first word, and malloc and free are O(1). Larger requests go
+// straight to the buddy allocator.
+//
+// Slab layout, starting at the buddy block:
+//
+//   [buddy header][Slab][pad to 8][object 0][object 1] ... [object capacity-1]
+//
+// Every slab starts on a slab_size boundary relative to the heap base, so
+// free finds the slab of a pointer by masking it. slab_map has one byte per
+// slab_size region of the heap and says which regions are slabs; pointers in
+// other regions belong to the buddy allocator.
+struct SlabAllocator {
+  static constexpr size_t slab_size = 4096;
+  static constexpr int num_classes = 10;
+  static constexpr size_t class_sizes[num_classes] = {8,  16, 24,  32,  48,
+                                                      64, 96, 128, 192, 256};
+  static constexpr size_t max_small = 256;
+
+  struct Slab {
+    Slab *prev; // in the class's list of slabs with free objects
+    Slab *next;
+    void *free_list;       // objects freed back to this slab
+    unsigned short cls;    // index into class_sizes
+    unsigned short used;   // live objects
+    unsigned short carved; // objects handed out from the untouched tail
+    unsigned short capacity;
+  };
+
+  static_assert(slab_size <= 65536, "object counts must fit a short");
+  static_assert((slab_size & (slab_size - 1)) == 0,
+                "slab_size must be a power of 2 so slabs are buddy blocks");
+
+  BuddyAllocator &buddy;
+  Slab *partial[num_classes] = {}; // slabs with at least one free object
+  unsigned char *slab_map = nullptr;
+  size_t slab_map_len = 0;
+
+  size_t live_objects_ = 0;       // small allocations
+  size_t live_object_bytes_ = 0;  // their class sizes
+  size_t live_slabs_ = 0;         // slab pages
+  size_t live_buddy_equiv_ = 0;   // buddy blocks the objects would have used
+  size_t internal_allocs_ = 0;    // buddy allocations made for slabs and map
+  size_t internal_useful_ = 0;
+
+  explicit SlabAllocator(BuddyAllocator &b) : buddy(b) {}
+
+  // ── internals ─────────────────────────────────────────────────────────────
+
+  // class index by (n + 7) / 8, so picking a class is one load
+  static constexpr unsigned char class_index[max_small / 8 + 1] = {
+      0, 0, 1, 2, 3, 4, 4, 5, 5, 6, 6, 6, 6, 7, 7, 7, 7,
+      8, 8, 8, 8, 8, 8, 8, 8, 9, 9, 9, 9, 9, 9, 9, 9};
+
+  static int class_of(size_t n) { return class_index[(n + 7) >> 3]; }
+
+  static unsigned char *objects_of(Slab *slab) {
+    size_t start = (size_t)(slab + 1);
+    return (unsigned char *)((start + 7) & ~(size_t)7);
+  }
+
+  size_t region_of(size_t addr) const {
+    return (addr - (size_t)buddy.heap_base_ptr) / slab_size;
+  }
+
+  Slab *slab_of(void *p) const {
+    size_t base = (size_t)buddy.heap_base_ptr;
+    size_t block = base + (((size_t)p - base) & ~(slab_size - 1));
+    return (Slab *)(block + BuddyAllocator::HDR);
+  }
+
+  bool is_slab_object(void *p) const {
+    size_t region = region_of((size_t)p);
+    return region < slab_map_len && slab_map[region];
+  }
+
+  void *internal_malloc(size_t n) {
+    internal_allocs_++;
+    internal_useful_ += n;
+    return buddy.malloc(n);
+  }
+
+  void internal_free(void *p, size_t n) {
+    internal_allocs_--;
+    internal_useful_ -= n;
+    buddy.free(p);
+  }
+
+  void mark_region(size_t region, unsigned char value) {
+    if (region >= slab_map_len) {
+      size_t len = slab_map_len ? slab_map_len : 64;
+      while (len <= region)
+        len <<= 1;
+      unsigned char *map = (unsigned char *)internal_malloc(len);
+      memset(map, 0, len);
+      if (slab_map) {
+        memcpy(map, slab_map, slab_map_len);
+        internal_free(slab_map, slab_map_len);
+      }
+      slab_map = map;
+      slab_map_len = len;
+    }
+    slab_map[region] = value;
+  }
+
+  void push_partial(Slab *slab) {
+    Slab *head = partial[slab->cls];
+    slab->prev = nullptr;
+    slab->next = head;
+    if (head)
+      head->prev = slab;
+    partial[slab->cls] = slab;
+  }
+
+  void remove_partial(Slab *slab) {
+    if (slab->prev)
+      slab->prev->next = slab->next;
+    else
+      partial[slab->cls] = slab->next;
+    if (slab->next)
+      slab->next->prev = slab->prev;
+  }
+
+  Slab *new_slab(int cls) {
+    Slab *slab = (Slab *)internal_malloc(slab_size - BuddyAllocator::HDR);
+    size_t block = (size_t)slab - BuddyAllocator::HDR;
+    mark_region(region_of(block), 1);
+    unsigned char *objects = objects_of(slab);
+    slab->free_list = nullptr;
+    slab->cls = (unsigned short)cls;
+    slab->used = 0;
+    slab->carved = 0;
+    slab->capacity =
+        (unsigned short)((block + slab_size - (size_t)objects) /
+                         class_sizes[cls]);
+    // objects stay poisoned until handed out
+    BUDDY_POISON(objects, block + slab_size - (size_t)objects);
+    push_partial(slab);
+    live_slabs_++;
+    return slab;
+  }
+
+  void free_slab(Slab *slab) {
+    size_t block = (size_t)slab - BuddyAllocator::HDR;
+    remove_partial(slab);
+    mark_region(region_of(block), 0);
+    live_slabs_--;
+    internal_free(slab, slab_size - BuddyAllocator::HDR);
+  }
+
+  // buddy block size a request of n bytes would take
+  static size_t buddy_block_size(size_t n) {
+    n = -((-n) & ~(sizeof(size_t) - 1));
+    return (size_t)1 << BuddyAllocator::order_for(n + BuddyAllocator::HDR);
+  }
+
+  void *malloc_small(size_t n) {
+    int cls = class_of(n);
+    size_t size = class_sizes[cls];
+    Slab *slab = partial[cls];
+    if (!slab)
+      slab = new_slab(cls);
+    unsigned char *obj;
+    if (slab->free_list) {
+      obj = (unsigned char *)slab->free_list;
+      BUDDY_UNPOISON(obj, sizeof(void *));
+      slab->free_list = *(void **)obj;
+    } else {
+      obj = objects_of(slab) + slab->carved * size;
+      slab->carved++;
+    }
+    if (++slab->used == slab->capacity)
+      remove_partial(slab);
+    BUDDY_UNPOISON(obj, n);
+    if (size > n)
+      BUDDY_POISON(obj + n, size - n);
+    live_objects_++;
+    live_object_bytes_ += size;
+    live_buddy_equiv_ += buddy_block_size(size);
+    return obj;
+  }
+
+  void free_small(void *p) {
+    Slab *slab = slab_of(p);
+    size_t size = class_sizes[slab->cls];
+    live_objects_--;
+    live_object_bytes_ -= size;
+    live_buddy_equiv_ -= buddy_block_size(size);
+    if (slab->used-- == slab->capacity)
+      push_partial(slab);
+    // keep one empty slab per class so a malloc/free pair on an otherwise
+    // empty class does not allocate a slab every time
+    if (slab->used == 0 && (slab->prev || slab->next)) {
+      free_slab(slab);
+      return;
+    }
+    BUDDY_UNPOISON(p, sizeof(void *));
+    *(void **)p = slab->free_list;
+    slab->free_list = p;
+    BUDDY_POISON(p, size);
+  }
+
+  // ── public API ────────────────────────────────────────────────────────────
+
+  void *malloc(size_t n) {
+    if (n == 0)
+      return nullptr;
+    if (n <= max_small)
+      return malloc_small(n);
+    return buddy.malloc(n);
+  }
+
+  void *calloc(size_t nmemb, size_t size) {
+    void *mem = malloc(nmemb * size);
+    if (mem)
+      memset(mem, 0, nmemb * size);
+    return mem;
+  }
+
+  // Small objects stay put while the new size fits their class. Buddy
+  // allocations stay with the buddy allocator whatever the new size.
+  void *realloc(void *p, size_t n) {
+    if (p == nullptr)
+      return malloc(n);
+    if (n == 0) {
+      free(p);
+      return nullptr;
+    }
+    if (!is_slab_object(p))
+      return buddy.realloc(p, n);
+    size_t size = class_sizes[slab_of(p)->cls];
+    if (n > size) {
+      void *result = malloc(n);
+      // the object's request size is not kept, so copy the whole class
+      BUDDY_UNPOISON(p, size);
+      memcpy(result, p, size);
+      free_small(p);
+      return result;
+    }
+    BUDDY_UNPOISON(p, n);
+    if (size > n)
+      BUDDY_POISON((unsigned char *)p + n, size - n);
+    return p;
+  }
+
+  void free(void *p) {
+    if (p == nullptr)
+      return;
+    if (!is_slab_object(p)) {
+      buddy.free(p);
+      return;
+    }
+    // Double-free guard, as in BuddyAllocator::free: a freed object is
+    // poisoned, so reading it makes ASan report the second free.
+    if (BUDDY_IS_POISONED(p)) {
+      volatile char bad = *(volatile char *)p;
+      (void)bad;
+    }
+    free_small(p);
+  }
+
+  // ── counters ──────────────────────────────────────────────────────────────
+  //
+  // The live counters count what callers see: every small object is one
+  // allocation of its class size, and slabs and the slab map are not counted
+  // as allocations. Block bytes is everything taken from the buddy heap, so
+  // block bytes minus useful bytes is the total fragmentation.
+
+  size_t total_memory_used_bytes() const {
+    return buddy.total_memory_used_bytes();
+  }
+  size_t live_alloc_count_get() const {
+    return buddy.live_alloc_count_get() - internal_allocs_ + live_objects_;
+  }
+  size_t live_useful_bytes_get() const {
+    return buddy.live_useful_bytes_get() - internal_useful_ +
+           live_object_bytes_;
+  }
+  size_t live_block_bytes_get() const { return buddy.live_block_bytes_get(); }
+  size_t live_slab_bytes_get() const { return live_slabs_ * slab_size; }
+  // Buddy bytes the live small objects would take without slabs, minus the
+  // bytes their slabs take. Negative while slabs are mostly empty.
+  ptrdiff_t live_slab_saved_bytes_get() const {
+    return (ptrdiff_t)live_buddy_equiv_ -
+           (ptrdiff_t)(live_slabs_ * slab_size);
+  }
+};
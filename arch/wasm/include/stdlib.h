@@ -6,6 +6,7 @@ extern "C" {
 
 void *malloc(size_t size);
 void *calloc(size_t nmemb, size_t size);
+void *realloc(void *ptr, size_t size);
 void free(void *ptr);
 
 // Total wasm linear memory pages × 64 KiB.
@@ -16,13 +17,22 @@ size_t total_memory_used_bytes();
 size_t malloc_live_alloc_count();
 
 // Sum of raw sizes callers passed to malloc() for all live allocations.
+// Allocations of up to 256 bytes count the size class they were rounded to.
 // Does not include header overhead or buddy-block rounding waste.
 size_t malloc_live_useful_bytes();
 
-// Sum of buddy block sizes for all live allocations.
-// Includes 12-byte headers and power-of-2 rounding waste.
+// Sum of buddy block sizes for all live allocations, slabs included.
+// Includes 12-byte headers and power-of-2 rounding waste, so this minus
+// malloc_live_useful_bytes() is the heap's fragmentation.
 size_t malloc_live_block_bytes();
 
+// Bytes of live 4 KiB slabs, which hold the allocations of up to 256 bytes.
+size_t malloc_live_slab_bytes();
+
+// Buddy bytes the live slab allocations would take without slabs, minus
+// malloc_live_slab_bytes(). Negative while slabs are mostly empty.
+ptrdiff_t malloc_live_slab_saved_bytes();
+
 #ifdef __cplusplus
 };
 #endif
@@ -29,25 +29,44 @@ template <class T> const T &max(const T &a, const T &b) {
   return (a < b) ? b : a;
 }
 
+// <utility>
+
+template <class T> struct remove_reference {
+  typedef T type;
+};
+template <class T> struct remove_reference<T &> {
+  typedef T type;
+};
+template <class T> struct remove_reference<T &&> {
+  typedef T type;
+};
+
+template <class T> typename remove_reference<T>::type &&move(T &&t) {
+  return static_cast<typename remove_reference<T>::type &&>(t);
+}
+
+template <class T> T &&forward(typename remove_reference<T>::type &t) {
+  return static_cast<T &&>(t);
+}
+
 // <vector>
 
+// Storage is only allocated on the first insert or reserve, so an empty
+// vector costs no heap memory.
 template <typename T> struct vector {
   T *_storage;
   size_t _capacity;
   size_t _size;
-  vector() {
-    _capacity = VECTOR_DEFAULT_CAPACITY;
-    _size = 0;
-    _storage = (T *)malloc(_capacity * sizeof(T));
+  vector() : _storage(nullptr), _capacity(0), _size(0) {}
+  vector(const vector<T> &other) : _storage(nullptr), _capacity(0), _size(0) {
+    _copy_from(other);
   }
-  vector(const vector<T> &other) {
-    _capacity = other._capacity;
-    _size = other._size;
-    _storage = (T *)malloc(_capacity * sizeof(T));
-    for (size_t i = 0; i < _size; ++i) {
-      _new<T>(_storage + i);
-      _storage[i] = other[i];
-    }
+  vector(vector<T> &&other)
+      : _storage(other._storage), _capacity(other._capacity),
+        _size(other._size) {
+    other._storage = nullptr;
+    other._capacity = 0;
+    other._size = 0;
   }
   ~vector() {
     for (size_t i = 0; i < _size; ++i) {
@@ -56,12 +75,34 @@ template <typename T> struct vector {
     free(_storage);
   }
   size_t size() const { return _size; }
-  void _expand() {
-    size_t _new_capacity = _capacity << 1;
+  size_t capacity() const { return _capacity; }
+  void _copy_from(const vector<T> &other) {
+    if (other._size == 0) {
+      return;
+    }
+    _ensure_capacity(other._size);
+    if (__is_trivially_copyable(T)) {
+      memcpy(_storage, other._storage, other._size * sizeof(T));
+      _size = other._size;
+      return;
+    }
+    for (size_t i = 0; i < other._size; ++i) {
+      _new<T>(_storage + i);
+      _storage[i] = other[i];
+    }
+    _size = other._size;
+  }
+  void _reallocate(size_t _new_capacity) {
+    if (__is_trivially_copyable(T)) {
+      // elements can move as bytes, and realloc may not move them at all
+      _storage = (T *)realloc(_storage, _new_capacity * sizeof(T));
+      _capacity = _new_capacity;
+      return;
+    }
     T *_new_storage = (T *)malloc(_new_capacity * sizeof(T));
     for (size_t i = 0; i < _size; ++i) {
       _new<T>(_new_storage + i);
-      _new_storage[i] = _storage[i];
+      _new_storage[i] = move(_storage[i]);
       _storage[i].~T();
     }
     free(_storage);
@@ -69,18 +110,48 @@ template <typename T> struct vector {
     _capacity = _new_capacity;
   }
   void _ensure_capacity(size_t _new_size) {
-    while (_new_size > _capacity) {
-      _expand();
+    if (_new_size <= _capacity) {
+      return;
+    }
+    size_t _new_capacity = _capacity ? _capacity : VECTOR_DEFAULT_CAPACITY;
+    while (_new_size > _new_capacity) {
+      _new_capacity <<= 1;
+    }
+    _reallocate(_new_capacity);
+  }
+  void reserve(size_t new_capacity) {
+    if (new_capacity > _capacity) {
+      _reallocate(new_capacity);
     }
   }
+  void shrink_to_fit() {
+    if (_size == _capacity) {
+      return;
+    }
+    if (_size == 0) {
+      free(_storage);
+      _storage = nullptr;
+      _capacity = 0;
+      return;
+    }
+    _reallocate(_size);
+  }
   void push_back(const T &value) {
     T value_copy = value; // copy before alloc in case it's our own data
+    push_back(move(value_copy));
+  }
+  void push_back(T &&value) {
     _ensure_capacity(_size + 1);
     _size++;
     _new<T>(_storage + _size - 1);
-    _storage[_size - 1] = value_copy;
+    _storage[_size - 1] = move(value);
+  }
+  // Constructs the element first, then moves it in: there is no placement new
+  // on wasm (see _new).
+  template <typename... Args> T &emplace_back(Args &&...args) {
+    push_back(T(forward<Args>(args)...));
+    return _storage[_size - 1];
   }
-  void emplace_back() { push_back(T()); }
   T &operator[](size_t index) const { return _storage[index]; }
   void clear() {
     for (size_t i = 0; i < _size; ++i) {
@@ -91,17 +162,25 @@ template <typename T> struct vector {
   T *begin() { return _storage; }
   T *end() { return _storage + _size; }
   vector<T> &operator=(const vector<T> &other) {
-    for (size_t i = 0; i < _size; ++i) {
-      _storage[i].~T();
+    if (this == &other) {
+      return *this;
+    }
+    clear();
+    _copy_from(other);
+    return *this;
+  }
+  vector<T> &operator=(vector<T> &&other) {
+    if (this == &other) {
+      return *this;
     }
+    clear();
     free(_storage);
+    _storage = other._storage;
     _capacity = other._capacity;
     _size = other._size;
-    _storage = (T *)malloc(_capacity * sizeof(T));
-    for (size_t i = 0; i < _size; ++i) {
-      _new<T>(_storage + i);
-      _storage[i] = other[i];
-    }
+    other._storage = nullptr;
+    other._capacity = 0;
+    other._size = 0;
     return *this;
   }
   void resize(size_t new_size) {
@@ -133,6 +212,7 @@ struct string {
   char *c_str();
   void append(char);
   string &operator=(const string &other);
+  string &operator=(string &&other);
   string &operator=(const char *other);
   string &operator+=(char);
   string &operator+=(const string &other);
@@ -170,11 +250,9 @@ template <typename A, typename B> pair<A, B> make_pair(A first, B second) {
 
 // <unordered_map> mock
 
-enum class EntryState { EMPTY, OCCUPIED, DELETED };
-
 // BasicHasher: Deviation from std::unordered_map which uses std::hash.
 // User must provide specializations for custom types if default cast is not
-// suitable.
+// suitable. The map scrambles the result itself, so plain casts are fine.
 template <typename K> struct BasicHasher {
   size_t operator()(const K &key) const { return static_cast<size_t>(key); }
 };
@@ -185,102 +263,143 @@ template <> struct BasicHasher<void *> {
   }
 };
 
+// Robin Hood hashing: open addressing with linear probing, where an entry
+// being inserted takes the slot of any entry that sits closer to its own
+// home slot, so probe lengths stay short and even. Erasing shifts the
+// following entries back instead of leaving tombstones.
 template <typename K, typename V, typename Hasher = BasicHasher<K>>
 struct unordered_map {
 private:
   struct Entry {
     K key;
     V value;
-    EntryState state;
-
-    Entry() : state(EntryState::EMPTY) {}
-    Entry(const K &k, const V &v)
-        : key(k), value(v), state(EntryState::OCCUPIED) {}
+    uint32_t dist; // 0 when empty, else 1 + distance from the home slot
   };
 
   vector<Entry> buckets;
   size_t num_elements;
-  size_t num_buckets;
-  const float max_load_factor = 0.75f;
+  size_t num_buckets; // 0 or a power of 2
+
+  // Fibonacci hashing: the multiply mixes every key bit into the top bits,
+  // so pointers, whose low bits are always zero, spread as well as counters.
+  size_t _home(const K &key) const {
+    Hasher hasher;
+    uint64_t h = (uint64_t)hasher(key) * 0x9e3779b97f4a7c15ull;
+    return (size_t)(h >> 32) & (num_buckets - 1);
+  }
+
+  // at most 7/8 full
+  static bool _fits(size_t elements, size_t bucket_count) {
+    return elements * 8 <= bucket_count * 7;
+  }
 
   size_t _find_slot(const K &key) const {
     if (num_elements == 0) {
       return num_buckets;
     }
-
-    Hasher hasher;
-    size_t index = hasher(key) % num_buckets;
-    size_t start_index = index;
-
-    while (buckets[index].state != EntryState::EMPTY) {
-      if (buckets[index].state == EntryState::OCCUPIED &&
-          buckets[index].key == key) {
-        return index;
+    size_t mask = num_buckets - 1;
+    size_t index = _home(key);
+    for (uint32_t dist = 1;; ++dist) {
+      const Entry &entry = buckets[index];
+      // past the point where an entry for key would have been placed
+      if (entry.dist < dist) {
+        return num_buckets;
       }
-      index = (index + 1) % num_buckets;
-      if (index == start_index) {
-        break;
+      if (entry.key == key) {
+        return index;
       }
+      index = (index + 1) & mask;
     }
-    return num_buckets;
   }
 
-  size_t _find_insert_slot(const K &key) const {
-    Hasher hasher;
-    size_t index = hasher(key) % num_buckets;
-    size_t start_index = index;
-    size_t first_deleted_slot = num_buckets;
-
-    while (buckets[index].state != EntryState::EMPTY) {
-      if (buckets[index].state == EntryState::OCCUPIED) {
-        if (buckets[index].key == key) {
-          return index;
-        }
-      } else { // EntryState::DELETED
-        if (first_deleted_slot == num_buckets) {
-          first_deleted_slot = index;
-        }
+  // Places an entry whose key is not in the table. Returns its slot.
+  size_t _place(Entry entry) {
+    size_t mask = num_buckets - 1;
+    size_t index = _home(entry.key);
+    size_t placed = num_buckets;
+    entry.dist = 1;
+    while (true) {
+      Entry &slot = buckets[index];
+      if (slot.dist == 0) {
+        slot = move(entry);
+        return placed == num_buckets ? index : placed;
       }
-      index = (index + 1) % num_buckets;
-      if (index == start_index) {
-        return num_buckets;
+      if (slot.dist < entry.dist) {
+        Entry displaced = move(slot);
+        slot = move(entry);
+        entry = move(displaced);
+        if (placed == num_buckets) {
+          placed = index;
+        }
       }
+      index = (index + 1) & mask;
+      entry.dist++;
     }
-    return (first_deleted_slot != num_buckets) ? first_deleted_slot : index;
   }
 
   void _rehash(size_t new_bucket_count) {
-    vector<Entry> old_buckets = buckets;
-
-    buckets.clear();
+    vector<Entry> old_buckets = move(buckets);
     buckets.resize(new_bucket_count);
     for (size_t i = 0; i < new_bucket_count; ++i) {
-      buckets[i].state = EntryState::EMPTY;
+      buckets[i].dist = 0;
     }
-
     num_buckets = new_bucket_count;
-    num_elements = 0;
-
     for (size_t i = 0; i < old_buckets.size(); ++i) {
-      if (old_buckets[i].state == EntryState::OCCUPIED) {
-        pair<K, V> data_to_insert;
-        data_to_insert.first = old_buckets[i].key;
-        data_to_insert.second = old_buckets[i].value;
-        insert(data_to_insert);
+      if (old_buckets[i].dist != 0) {
+        _place(move(old_buckets[i]));
       }
     }
   }
 
-  void _check_and_rehash() {
-    if (num_buckets == 0 ||
-        static_cast<float>(num_elements + 1) / num_buckets > max_load_factor) {
-      size_t new_size = (num_buckets == 0) ? 16 : num_buckets * 2;
-      _rehash(new_size);
+public:
+  // buckets are allocated on the first insert
+  unordered_map() : num_elements(0), num_buckets(0) {}
+  unordered_map(const unordered_map &other)
+      : buckets(other.buckets), num_elements(other.num_elements),
+        num_buckets(other.num_buckets) {}
+  unordered_map(unordered_map &&other)
+      : buckets(move(other.buckets)), num_elements(other.num_elements),
+        num_buckets(other.num_buckets) {
+    other.num_elements = 0;
+    other.num_buckets = 0;
+  }
+  unordered_map &operator=(const unordered_map &other) {
+    buckets = other.buckets;
+    num_elements = other.num_elements;
+    num_buckets = other.num_buckets;
+    return *this;
+  }
+  unordered_map &operator=(unordered_map &&other) {
+    buckets = move(other.buckets);
+    num_elements = other.num_elements;
+    num_buckets = other.num_buckets;
+    other.num_elements = 0;
+    other.num_buckets = 0;
+    return *this;
+  }
+
+  size_t size() const { return num_elements; }
+  bool empty() const { return num_elements == 0; }
+  size_t bucket_count() const { return num_buckets; }
+
+  // Compliant with std::unordered_map::reserve: makes room for count
+  // elements without rehashing.
+  void reserve(size_t count) {
+    size_t new_bucket_count = num_buckets ? num_buckets : 16;
+    while (!_fits(count, new_bucket_count)) {
+      new_bucket_count <<= 1;
+    }
+    if (new_bucket_count != num_buckets) {
+      _rehash(new_bucket_count);
     }
   }
 
-public:
-  unordered_map() : num_elements(0), num_buckets(0) { _check_and_rehash(); }
+  void clear() {
+    for (size_t i = 0; i < num_buckets; ++i) {
+      buckets[i].dist = 0;
+    }
+    num_elements = 0;
+  }
 
   // Compliant with std::unordered_map::count.
   size_t count(const K &key) const {
@@ -289,20 +408,37 @@ public:
 
   // Compliant with std::unordered_map::insert return type.
   pair<bool, V &> insert(const pair<K, V> &data) {
-    _check_and_rehash();
-
-    size_t slot_index = _find_insert_slot(data.first);
-
-    if (buckets[slot_index].state == EntryState::OCCUPIED &&
-        buckets[slot_index].key == data.first) {
-      return {false, buckets[slot_index].value};
-    } else {
-      buckets[slot_index].key = data.first;
-      buckets[slot_index].value = data.second;
-      buckets[slot_index].state = EntryState::OCCUPIED;
-      num_elements++;
-      return {true, buckets[slot_index].value};
+    size_t index = _find_slot(data.first);
+    if (index != num_buckets) {
+      return {false, buckets[index].value};
+    }
+    reserve(num_elements + 1);
+    Entry entry;
+    entry.key = data.first;
+    entry.value = data.second;
+    index = _place(move(entry));
+    num_elements++;
+    return {true, buckets[index].value};
+  }
+
+  // Compliant with std::unordered_map::erase(key).
+  size_t erase(const K &key) {
+    size_t index = _find_slot(key);
+    if (index == num_buckets) {
+      return 0;
+    }
+    size_t mask = num_buckets - 1;
+    // shift the rest of the probe run back by one
+    size_t next = (index + 1) & mask;
+    while (buckets[next].dist > 1) {
+      buckets[index] = move(buckets[next]);
+      buckets[index].dist--;
+      index = next;
+      next = (next + 1) & mask;
     }
+    buckets[index].dist = 0;
+    num_elements--;
+    return 1;
   }
 
   // Deviation from std::unordered_map::at: Does not throw std::out_of_range.
@@ -305,7 +305,8 @@ let gl_env = {
   },
 
   glBufferData(target, size, data, usage) {
-    gl.bufferData(target, make_view(data, size), usage);
+    // a null pointer only allocates, as in GLES
+    gl.bufferData(target, data ? make_view(data, size) : size, usage);
   },
 
   glBufferSubData(target, offset, size, data) {
@@ -482,6 +483,13 @@ let gl_env = {
     clearInterval(id);
   },
 
+  start_worker(func, arg) {
+    // no shared-memory threads here; callers fall back to the main thread
+    return -1;
+  },
+
+  wake_workers() {},
+
   is_dark_mode() {
     return window.matchMedia &&
       window.matchMedia("(prefers-color-scheme: dark)").matches
@@ -548,6 +556,7 @@ function canvas_draw(timestamp) {
     gl.viewport(0, 0, width, height);
     inst.exports.resize(width, height);
   }
+  inst.exports.publish();
   inst.exports.draw();
   window.requestAnimationFrame(canvas_draw);
 }
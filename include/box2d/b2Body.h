@@ -71,10 +71,12 @@ struct b2Body {
   b2Vec2 m_position; // center of mass position
   float64 m_rotation;
   b2Mat22 m_R;
+  float64 m_RAngle; // the angle m_R was last computed from
 
   // Conservative advancement data.
   b2Vec2 m_position0;
   float64 m_rotation0;
+  b2Mat22 m_R0;
 
   b2Vec2 m_linearVelocity;
   float64 m_angularVelocity;
@@ -117,6 +119,13 @@ void b2Body_dtor(b2Body *body);
 
 void b2Body_SynchronizeShapes(b2Body *body);
 
+// Recompute m_R after m_rotation changed. The trig is skipped when the
+// angle is bit-identical to the one m_R was last computed from.
+void b2Body_SynchronizeRotation(b2Body *body);
+
+// Store the current transform for conservative advancement.
+void b2Body_SaveTransform(b2Body *body);
+
 // This is called when the child shape has no proxy.
 void b2Body_Freeze(b2Body *body);
 
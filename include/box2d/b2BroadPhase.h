@@ -127,4 +127,10 @@ void b2BroadPhase_MoveProxy(b2BroadPhase *broad_phase, int32 proxyId,
 
 void b2BroadPhase_Commit(b2BroadPhase *broad_phase);
 
+// Calls callback with the user data of every committed pair the proxy is in.
+void b2BroadPhase_QueryPairs(b2BroadPhase *broad_phase, int32 proxyId,
+                             void (*callback)(void *pairUserData,
+                                              void *context),
+                             void *context);
+
 #endif
@@ -60,7 +60,8 @@ static float64 b2Vec2_Normalize(b2Vec2 *v) {
 }
 
 static void b2Mat22_SetAngle(b2Mat22 *m, float64 angle) {
-  float64 c = fp_cos(angle), s = fp_sin(angle);
+  float64 c, s;
+  fp_sincos(angle, &s, &c);
   m->col1.x = c;
   m->col2.x = -s;
   m->col1.y = s;
@@ -28,6 +28,9 @@ struct b2World;
 typedef struct b2Contact b2Contact;
 struct b2Contact;
 
+typedef struct b2Shape b2Shape;
+struct b2Shape;
+
 typedef struct b2ContactManager b2ContactManager;
 struct b2ContactManager {
   b2PairCallback m_pairCallback;
@@ -64,6 +67,16 @@ static void b2ContactManager_ctor(b2ContactManager *manager) {
 
 void b2ContactManager_Collide(b2ContactManager *manager);
 
+void b2ContactManager_CollideContact(b2ContactManager *manager, b2Contact *c);
+
+// Collides only the contacts of one shape and returns how many are touching.
+int32 b2ContactManager_CollideShape(b2ContactManager *manager, b2Shape *shape);
+
+// Calls callback for every contact of one shape, touching or not.
+void b2ContactManager_QueryShape(b2ContactManager *manager, b2Shape *shape,
+                                 void (*callback)(b2Contact *c, void *context),
+                                 void *context);
+
 void b2ContactManager_CleanContactList(b2ContactManager *manager);
 
 #ifdef __cplusplus
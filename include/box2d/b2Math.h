@@ -84,7 +84,8 @@ static void b2Mat22_Set(b2Mat22 *m, const b2Vec2 &c1, const b2Vec2 &c2) {
 }
 
 static void b2Mat22_SetAngle(b2Mat22 *m, float64 angle) {
-  float64 c = fp_cos(angle), s = fp_sin(angle);
+  float64 c, s;
+  fp_sincos(angle, &s, &c);
   m->col1.x = c;
   m->col2.x = -s;
   m->col1.y = s;
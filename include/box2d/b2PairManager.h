@@ -131,4 +131,8 @@ void b2PairManager_RemoveBufferedPair(b2PairManager *manager, int32 proxyId1,
 
 void b2PairManager_Commit(b2PairManager *manager);
 
+// Returns the pair of the two proxies, or NULL if they are not paired.
+b2Pair *b2PairManager_Find(b2PairManager *manager, int32 proxyId1,
+                           int32 proxyId2);
+
 #endif
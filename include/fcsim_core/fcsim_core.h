@@ -0,0 +1,101 @@
+#ifndef __FCSIM_CORE_H__
+#define __FCSIM_CORE_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Headless simulation, built as libfcsim_core: load a design, make a world
+// from it, step it and read it back, with no arena, graphics or timers. A run
+// gives the same ticks as run_single_design_xml.
+//
+// A loaded design is never modified, so any number of worlds on any threads
+// may be created from it. Each world simulates its own copy of the design;
+// different worlds may be stepped on different threads at once, but one
+// world must only be used by one thread at a time.
+
+#define FCSIM_CORE_API_VERSION 1
+
+// The library is built with everything else hidden, so its internals (which
+// have names like step) neither clash with nor bind to a host's symbols.
+#define FCSIM_CORE_API __attribute__((visibility("default")))
+
+struct fcsim_design;
+struct fcsim_world;
+
+// A block as loaded. Blocks are numbered level blocks first, then player
+// blocks, each in document order, which is also the order of body states.
+struct fcsim_block_info {
+  int32_t id;   // the XML id, -1 if absent
+  int32_t type; // FCSIM_* type id from graph.h: 0 static rect, 1 static
+                // circle, 2 dynamic rect, 3 dynamic circle, 4 goal rect,
+                // 5-7 goal wheels, 8-10 wheels, 11 water rod, 12 solid rod
+  int32_t goal; // 1 for goal pieces
+  int32_t level; // 1 for level blocks, 0 for player blocks
+};
+
+// Body state of one block. All doubles and no padding, so an array of them is
+// also an array of FCSIM_BODY_STATE_FIELDS doubles per block.
+struct fcsim_body_state {
+  double x, y;
+  double angle;
+  double vx, vy;
+  double angular_velocity;
+};
+
+#define FCSIM_BODY_STATE_FIELDS 6
+
+// Loads a retrieveLevel XML or a binary design (design_bin.h) from buf, which
+// is not kept. Returns NULL if it does not parse.
+FCSIM_CORE_API struct fcsim_design *fcsim_design_load(const char *buf,
+                                                      size_t len);
+// Loads the token format run_single_design reads (design_ftlib.h), which
+// starts with a tick limit; that goes to *max_ticks.
+FCSIM_CORE_API struct fcsim_design *
+fcsim_design_load_ftlib(const char *text, size_t len, int64_t *max_ticks);
+FCSIM_CORE_API void fcsim_design_free(struct fcsim_design *design);
+
+// design_fingerprint of the design: equal for designs that simulate the same
+FCSIM_CORE_API uint64_t
+fcsim_design_fingerprint(const struct fcsim_design *design);
+FCSIM_CORE_API int fcsim_design_block_count(const struct fcsim_design *design);
+// Returns 0, or -1 if index is out of range.
+FCSIM_CORE_API int fcsim_design_block_info(const struct fcsim_design *design,
+                                           int index,
+                                           struct fcsim_block_info *info);
+
+// Returns a world at tick 0.
+FCSIM_CORE_API struct fcsim_world *
+fcsim_world_create(const struct fcsim_design *design);
+FCSIM_CORE_API void fcsim_world_free(struct fcsim_world *world);
+
+// Steps exactly ticks ticks, noting the first tick the goal is reached on.
+// Returns the tick the world is at afterwards.
+FCSIM_CORE_API int64_t fcsim_world_step(struct fcsim_world *world,
+                                        int64_t ticks);
+// Steps until the goal is reached or the world is at max_ticks, as the
+// runners do; a negative max_ticks means no limit, and a world already at or
+// past max_ticks returns at once. Returns the solve tick.
+FCSIM_CORE_API int64_t fcsim_world_run(struct fcsim_world *world,
+                                       int64_t max_ticks);
+
+FCSIM_CORE_API int64_t fcsim_world_tick(const struct fcsim_world *world);
+// first tick the goal was reached on, -1 if it has not been
+FCSIM_CORE_API int64_t fcsim_world_solve_tick(const struct fcsim_world *world);
+// 1 if every goal piece is inside the goal area now (and there is one)
+FCSIM_CORE_API int fcsim_world_goal_reached(const struct fcsim_world *world);
+
+// Writes the state of up to count blocks into out, in block order, and
+// returns how many it wrote.
+FCSIM_CORE_API int fcsim_world_snapshot(const struct fcsim_world *world,
+                                        struct fcsim_body_state *out,
+                                        int count);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
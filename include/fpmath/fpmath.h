@@ -1,14 +1,38 @@
 #ifndef __FPMATH_H__
 #define __FPMATH_H__
 
+#include <stdint.h>
+
 #ifdef __cplusplus
 extern "C" {
 #endif
 
 double fp_sin(double x);
 double fp_cos(double x);
+void fp_sincos(double x, double *s, double *c);
 double fp_atan2(double y, double x);
 int fp_strtod(const char *str, int len, double *res);
+// The original digit-by-digit parser; fp_strtod must agree with it bit for
+// bit on every input.
+int fp_strtod_reference(const char *str, int len, double *res);
+
+// Writes text that fp_strtod reads back as exactly val into buf
+// (FP_DTOA_BUFSIZE bytes) with a terminating zero, and returns its length.
+// Usually that is the nearest 15, 16 or 17 digits laid out like JavaScript's
+// Number.toString; where fp_strtod rounds those wrongly it is other digits
+// with an exponent. Infinities are written as 1e999 and -1e999, and NaNs as
+// 0e999 or -0e999, which fp_strtod reads back as 0 * infinity. fp_strtod
+// cannot produce most doubles under 1e-290, so below FP_DTOA_MIN_EXACT in
+// magnitude (zero aside) the nearest 17 digits may be all there is.
+#define FP_DTOA_MIN_EXACT 1e-280
+#define FP_DTOA_BUFSIZE 48
+int fp_dtoa(char *buf, double val);
+
+// The unspecialised software atan2; fp_atan2 must agree with it bit for bit
+// (except in the USE_FPATAN build, which uses the x87 instruction).
+double fp_atan2_reference(double y, double x);
+// Number of fp_atan2 calls that missed the fast path.
+uint64_t fp_atan2_slow_path_count(void);
 
 #ifdef __cplusplus
 }
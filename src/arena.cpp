@@ -8,6 +8,7 @@
 #define ARENA_C
 extern "C" {
 #include "arena.h"
+#include "design_bin.h"
 #include "gen.h"
 #include "gl.h"
 #include "graph.h"
@@ -17,6 +18,9 @@ extern "C" {
 #include <box2d/b2Body.h>
 #include <box2d/b2CMath.h>
 #include <box2d/b2World.h>
+#ifdef VERIFY_EDIT_WORLD
+#include <assert.h>
+#endif
 #include <math.h>
 #include <stdlib.h>
 #include <string.h>
@@ -58,8 +62,78 @@ struct MoveState {
   std::vector<JointMoveEntry> root_joints;
 };
 
+/*
+ * EditorIndex is a spatial hash over the design's joints and blocks, so the
+ * editor's hit tests only look at pieces near the cursor.
+ *
+ *   joints       — filed by position in cells of EDITOR_INDEX_CELL.
+ *   blocks       — filed by shell centre in the first of EDITOR_INDEX_LEVELS
+ *                  cell sizes (each 4x the last) that covers their hit radius.
+ *   big_*        — pieces too far out or too large to file; always checked.
+ *   floating     — blocks that move during the current edit (the drag set
+ *                  while moving, the new block while creating). They and
+ *                  their joints are never filed and are checked live instead,
+ *                  so the move and create paths can keep the index current
+ *                  without refiling anything, see editor_index_keep.
+ *
+ * Each entry records its position in the design's list so hit tests pick the
+ * same piece as a scan in list order would. The index is rebuilt whenever
+ * modcount, the edit mode or the new block changes behind its back.
+ */
+enum editor_index_mode {
+  EDITOR_INDEX_NORMAL,
+  EDITOR_INDEX_MOVE,
+  EDITOR_INDEX_CREATE,
+};
+
+struct JointIndexEntry {
+  struct joint *joint;
+  int order; // position in design->joints, -1 if unknown
+};
+
+struct BlockIndexEntry {
+  struct block *block;
+  int order; // position in design->design_blocks
+};
+
+struct EditorIndex {
+  bool valid;
+  int modcount;
+  enum editor_index_mode mode;
+  struct block *new_block;
+
+  // buckets are ranges [start[i], start[i + 1]) of the entry arrays
+  unsigned int mask;
+  std::vector<int> joint_start;
+  std::vector<JointIndexEntry> joints;
+  std::vector<int> block_start;
+  std::vector<BlockIndexEntry> blocks;
+
+  std::vector<JointIndexEntry> big_joints;
+  std::vector<BlockIndexEntry> big_blocks;
+  std::vector<BlockIndexEntry> floating;
+
+  // scratch space for rebuilds
+  std::vector<unsigned int> joint_bucket;
+  std::vector<unsigned int> block_bucket;
+};
+
+/*
+ * The editor's world, set aside while a run is in progress. The editor keeps
+ * its world current piece by piece (update_body, delete_block), so stop() can
+ * hand it back instead of generating a new one. bodies holds each block's
+ * body in list order, design blocks first, as of modcount.
+ */
+struct EditWorld {
+  b2World *world;
+  std::vector<b2Body *> bodies;
+  int modcount;
+};
+
 void arena_move_init(struct arena *arena) {
   arena->move_state = _new<MoveState>();
+  arena->editor_index = _new<EditorIndex>();
+  arena->edit_world = _new<EditWorld>();
 }
 
 #define MAX_RENDER_TEXT_LENGTH 1000
@@ -182,6 +256,8 @@ bool arena_compile_shaders(void) {
   return true;
 }
 
+void drop_edit_world(struct arena *arena);
+
 int num_times_init_called = 0;
 void arena_init(struct arena *arena, float w, float h, char *xml, int len) {
   struct xml_level level;
@@ -192,19 +268,23 @@ void arena_init(struct arena *arena, float w, float h, char *xml, int len) {
     if (arena->world) {
       free_world(arena->world, &arena->design);
     }
-    if (arena->preview_world) {
-      free_world(arena->preview_world, arena->preview_design);
-    }
-    if (arena->preview_design) {
-      free_design(arena->preview_design);
-    }
+    drop_edit_world(arena);
+    preview_cancel(arena);
   }
 
-  /* parse incoming xml into a temporary design */
+  /* parse incoming xml (or a binary design) into a temporary design */
   memset(&tmp, 0, sizeof(tmp));
-  xml_parse(xml, len, &level);
-  convert_xml(&level, &tmp);
-  xml_free(&level); /* avoid leak */
+  memset(&level, 0, sizeof(level));
+  if (design_bin_is_binary(xml, len)) {
+    /* a truncated or other-version binary design gets what XML that fails
+       before its level gets: the empty level, converted */
+    if (design_bin_load(xml, len, &tmp))
+      convert_xml(&level, &tmp);
+  } else {
+    xml_parse(xml, len, &level);
+    convert_xml(&level, &tmp);
+    xml_free(&level); /* avoid leak */
+  }
 
   if (num_times_init_called == 0) {
     /* first-time initialization of view/tools/etc. */
@@ -228,6 +308,13 @@ void arena_init(struct arena *arena, float w, float h, char *xml, int len) {
 
     arena_move_init(arena);
 
+    arena->preview_worker = NULL;
+
+    arena->tick_last_ms = time_precise_ms();
+    arena->tick_debt = 0;
+    arena->tick_cost_ms = 1;
+    arena->ival = set_interval(tick_func, MIN_MSPT, arena);
+
     /* first design replaces arena->design entirely */
     arena->design = tmp;
 
@@ -250,8 +337,6 @@ void arena_init(struct arena *arena, float w, float h, char *xml, int len) {
   arena->tick = 0;
   arena->has_won = false;
   arena->preview_goal_piece_trajectory = false;
-  arena->preview_design = NULL;
-  arena->preview_world = NULL;
   arena->preview_has_won = false;
   arena->lock_if_preview_solves = false;
 
@@ -259,6 +344,12 @@ void arena_init(struct arena *arena, float w, float h, char *xml, int len) {
 
   arena->design.expect_checksum = 0;
   arena->design.actual_checksum = 0;
+  /* the memo must not keep handing out the checksum zeroed above */
+  arena->design.checksum_valid = false;
+
+#ifndef CLI
+  render_snapshot_publish(arena);
+#endif
 
   num_times_init_called++;
 }
@@ -285,43 +376,201 @@ void arena_key_up_event(struct arena *arena, int key) {
   update_tool(arena);
 }
 
-static int block_inside_area(struct block *block, struct area *area);
+#ifdef VERIFY_EDIT_WORLD
+static bool same_bits(const void *a, const void *b, size_t n) {
+  return memcmp(a, b, n) == 0;
+}
 
-bool goal_blocks_inside_goal_area(struct design *design) {
-  struct block *block;
-  bool any = false;
+static bool same_body(b2Body *a, b2Body *b) {
+  if (!same_bits(&a->m_position, &b->m_position, sizeof(b2Vec2)) ||
+      !same_bits(&a->m_rotation, &b->m_rotation, sizeof(float64)) ||
+      !same_bits(&a->m_mass, &b->m_mass, sizeof(float64)) ||
+      !same_bits(&a->m_I, &b->m_I, sizeof(float64)) ||
+      !same_bits(&a->m_linearDamping, &b->m_linearDamping, sizeof(float64)) ||
+      !same_bits(&a->m_angularDamping, &b->m_angularDamping,
+                 sizeof(float64)) ||
+      a->m_shapeCount != b->m_shapeCount)
+    return false;
 
-  for (block = design->design_blocks.head; block; block = block->next) {
-    if (block->goal) {
-      any = true;
-      if (!block_inside_area(block, &design->goal_area))
+  b2Shape *sa = a->m_shapeList;
+  b2Shape *sb = b->m_shapeList;
+  for (; sa && sb; sa = sa->m_next, sb = sb->m_next) {
+    if (sa->m_type != sb->m_type || sa->m_userData != sb->m_userData ||
+        !same_bits(&sa->m_position, &sb->m_position, sizeof(b2Vec2)) ||
+        !same_bits(&sa->m_R, &sb->m_R, sizeof(b2Mat22)) ||
+        !same_bits(&sa->m_friction, &sb->m_friction, sizeof(float64)) ||
+        !same_bits(&sa->m_restitution, &sb->m_restitution, sizeof(float64)))
+      return false;
+    if (sa->m_type == e_circleShape) {
+      b2CircleShape *ca = (b2CircleShape *)sa;
+      b2CircleShape *cb = (b2CircleShape *)sb;
+      if (!same_bits(&ca->m_radius, &cb->m_radius, sizeof(float64)))
+        return false;
+    } else {
+      b2PolyShape *pa = (b2PolyShape *)sa;
+      b2PolyShape *pb = (b2PolyShape *)sb;
+      if (pa->m_vertexCount != pb->m_vertexCount ||
+          !same_bits(pa->m_vertices, pb->m_vertices,
+                     pa->m_vertexCount * sizeof(b2Vec2)))
         return false;
     }
   }
+  return sa == sb;
+}
+
+struct collect_contacts_state {
+  struct block *self;
+  std::vector<struct block *> *others;
+};
+
+static void collect_contact(b2Contact *c, void *arg) {
+  collect_contacts_state *st = (collect_contacts_state *)arg;
+  struct block *b1 = (struct block *)c->m_shape1->m_userData;
+  struct block *b2 = (struct block *)c->m_shape2->m_userData;
+
+  st->others->push_back(b1 == st->self ? b2 : b1);
+}
 
-  return any;
+// blocks the body's shapes have a (non-filtered) contact with
+static void collect_contacts(b2World *world, struct block *block,
+                             std::vector<struct block *> *others) {
+  collect_contacts_state st;
+  st.self = block;
+  st.others = others;
+  others->clear();
+  for (b2Shape *shape = block->body->m_shapeList; shape; shape = shape->m_next)
+    b2ContactManager_QueryShape(&world->m_contactManager, shape,
+                                collect_contact, &st);
 }
 
+static bool same_contacts(std::vector<struct block *> &a,
+                          std::vector<struct block *> &b) {
+  if (a.size() != b.size())
+    return false;
+  for (struct block *x : a) {
+    bool found = false;
+    for (struct block *y : b)
+      found = found || x == y;
+    if (!found)
+      return false;
+  }
+  return true;
+}
+
+/*
+ * Checks the editor's world against a fresh gen_world of the design: every
+ * block's body and shapes must match bit for bit, and every block must pair
+ * with the same blocks. Joints are not compared. gen_world makes them
+ * collideConnected, so they never change the pairs, and runs always start
+ * from a fresh world anyway.
+ */
+static bool verify_edit_world(struct arena *arena) {
+  struct design *design = &arena->design;
+  b2World *world = arena->world;
+  std::vector<b2Body *> bodies;
+  struct block *block;
+
+  b2ContactManager_CleanContactList(&world->m_contactManager);
+  b2World_CleanBodyList(world);
+
+  for (block = design->design_blocks.head; block; block = block->next)
+    bodies.push_back(block->body);
+  for (block = design->level_blocks.head; block; block = block->next)
+    bodies.push_back(block->body);
+
+  b2World *fresh = gen_world(design);
+  std::vector<struct block *> edit_contacts;
+  std::vector<struct block *> fresh_contacts;
+  bool ok = true;
+  size_t i = 0;
+
+  for (int list = 0; list < 2; list++) {
+    block = list == 0 ? design->design_blocks.head : design->level_blocks.head;
+    for (; block && ok; block = block->next, i++) {
+      b2Body *body = bodies[i];
+      if (!body || body->m_world != world ||
+          (body->m_flags & b2Body_e_destroyFlag) ||
+          !same_body(body, block->body)) {
+        ok = false;
+        break;
+      }
+      collect_contacts(fresh, block, &fresh_contacts);
+      block->body = body;
+      collect_contacts(world, block, &edit_contacts);
+      ok = same_contacts(edit_contacts, fresh_contacts);
+    }
+  }
+
+  free_world(fresh, design);
+  i = 0;
+  for (block = design->design_blocks.head; block; block = block->next)
+    block->body = bodies[i++];
+  for (block = design->level_blocks.head; block; block = block->next)
+    block->body = bodies[i++];
+
+  return ok;
+}
+#endif
+
+// Sets the editor's world aside for stop() and gives the run a fresh one.
+// Runs always start from gen_world, so they do not depend on edit history.
 void start(struct arena *arena) {
-  free_world(arena->world, &arena->design);
+  EditWorld *ew = static_cast<EditWorld *>(arena->edit_world);
+  struct block *block;
+
+  if (ew->world) {
+    free_world(arena->world, &arena->design);
+  } else {
+    ew->world = arena->world;
+    ew->modcount = arena->design.modcount;
+    ew->bodies.clear();
+    for (block = arena->design.design_blocks.head; block; block = block->next)
+      ew->bodies.push_back(block->body);
+    for (block = arena->design.level_blocks.head; block; block = block->next)
+      ew->bodies.push_back(block->body);
+  }
+
   arena->world = gen_world(&arena->design);
-  // arena->ival = set_interval(tick_func, arena->tick_ms, arena);
   arena->hover_joint = NULL;
   arena->tick = 0;
   arena->has_won = false;
 }
 
+// Frees the world set aside by start(), if any.
+void drop_edit_world(struct arena *arena) {
+  EditWorld *ew = static_cast<EditWorld *>(arena->edit_world);
+
+  if (ew->world) {
+    b2World_dtor(ew->world);
+    free(ew->world);
+    ew->world = NULL;
+  }
+}
+
 void stop(struct arena *arena) {
+  EditWorld *ew = static_cast<EditWorld *>(arena->edit_world);
+  struct block *block;
+  size_t i = 0;
+
   free_world(arena->world, &arena->design);
-  arena->world = gen_world(&arena->design);
-  // clear_interval(arena->ival);
-}
 
-void change_speed(struct arena *arena, int ms, int multiply) {
-  arena->tick_ms = ms;
-  arena->tick_multiply = multiply;
-  clear_interval(arena->ival);
-  arena->ival = set_interval(tick_func, ms, arena);
+  // the design cannot be edited while running, but be safe
+  if (ew->world && ew->modcount == arena->design.modcount) {
+    arena->world = ew->world;
+    ew->world = NULL;
+    for (block = arena->design.design_blocks.head; block; block = block->next)
+      block->body = ew->bodies[i++];
+    for (block = arena->design.level_blocks.head; block; block = block->next)
+      block->body = ew->bodies[i++];
+  } else {
+    drop_edit_world(arena);
+    arena->world = gen_world(&arena->design);
+  }
+
+#ifdef VERIFY_EDIT_WORLD
+  assert(verify_edit_world(arena));
+#endif
+  // clear_interval(arena->ival);
 }
 
 double _fcsim_speed_factor = 2;
@@ -343,12 +592,8 @@ void change_speed_factor(struct arena *arena, double new_factor,
   int base_fps = _fcsim_base_fps_table[_fcsim_base_fps_mod];
   if (factor < 1)
     factor = 1;
+  // tick_func paces itself against this
   _fcsim_target_tps = factor * base_fps;
-  double mspt = 1000 / (base_fps * factor);
-  long long int multiples = 1 + (long long int)(MIN_MSPT / mspt);
-  long long int mspt_int =
-      (long long int)(1000 * multiples / (base_fps * factor));
-  change_speed(arena, (int)mspt_int, (int)multiples);
 }
 
 void change_speed_preset(struct arena *arena, int preset_index) {
@@ -526,38 +771,237 @@ static float distance(float x0, float y0, float x1, float y1) {
 
 static const double EDITOR_JOINT_EDGE_MAX_DISTANCE = 8.0;
 
-struct joint *joint_hit_test(struct arena *arena, float x, float y) {
+static const double EDITOR_INDEX_CELL = 32.0;
+static const int EDITOR_INDEX_LEVELS = 4;
+// pieces further out are not filed, which keeps float rounding in the hit
+// tests far below a cell
+static const double EDITOR_INDEX_MAX_COORD = 1e6;
+
+static enum editor_index_mode editor_index_mode(struct arena *arena) {
+  switch (arena->state) {
+  case STATE_MOVE:
+    return EDITOR_INDEX_MOVE;
+  case STATE_NEW_ROD:
+  case STATE_NEW_WHEEL:
+    return EDITOR_INDEX_CREATE;
+  default:
+    return EDITOR_INDEX_NORMAL;
+  }
+}
+
+static bool editor_index_in_range(double x, double y) {
+  return fabs(x) < EDITOR_INDEX_MAX_COORD && fabs(y) < EDITOR_INDEX_MAX_COORD;
+}
+
+static double editor_index_cell_size(int level) {
+  return EDITOR_INDEX_CELL * (1 << (2 * level));
+}
+
+static int editor_index_cell(double v, double size) {
+  int cell = (int)(v / size);
+
+  if (cell * size > v)
+    cell--;
+
+  return cell;
+}
+
+static unsigned int editor_index_hash(int level, int cx, int cy) {
+  return (unsigned int)cx * 73856093u ^ (unsigned int)cy * 19349663u ^
+         (unsigned int)level * 83492791u;
+}
+
+static bool editor_index_block_floats(struct arena *arena,
+                                      enum editor_index_mode mode,
+                                      struct block *block) {
+  switch (mode) {
+  case EDITOR_INDEX_MOVE:
+    return block->in_drag_set;
+  case EDITOR_INDEX_CREATE:
+    return block == arena->new_block;
+  default:
+    return false;
+  }
+}
+
+// floating joints are exactly the joints of floating blocks that may move
+static bool editor_index_joint_floats(struct arena *arena,
+                                      enum editor_index_mode mode,
+                                      struct joint *joint) {
+  struct attach_node *node;
+
+  switch (mode) {
+  case EDITOR_INDEX_MOVE:
+    return joint->in_drag_set;
+  case EDITOR_INDEX_CREATE:
+    if (joint->gen)
+      return joint->gen == arena->new_block;
+    for (node = joint->att.head; node; node = node->next) {
+      if (node->block != arena->new_block)
+        return false;
+    }
+    return joint->att.head != NULL;
+  default:
+    return false;
+  }
+}
+
+// radius around the shell centre outside of which block_is_hit is false
+static double block_hit_radius(struct shell *shell) {
+  double w_half, h_half;
+
+  if (shell->type == SHELL_CIRC)
+    return fabs(shell->circ.radius) + 8.0 + 1.0;
+
+  w_half = fabs(shell->rect.w) / 2 + 8.0;
+  h_half = fabs(shell->rect.h) / 2 + 8.0;
+  return sqrt(w_half * w_half + h_half * h_half) + 1.0;
+}
+
+// sort entries into buckets; start[b] ends up as the first entry of bucket b
+template <typename Entry>
+static void editor_index_fill(unsigned int mask, std::vector<Entry> &scratch,
+                              std::vector<unsigned int> &hashes,
+                              std::vector<int> &start,
+                              std::vector<Entry> &entries) {
+  unsigned int buckets = mask + 1;
+  unsigned int b;
+  int i;
+  int n = (int)scratch.size();
+
+  start.clear();
+  start.resize(buckets + 1);
+  for (i = 0; i < n; i++)
+    start[hashes[i] & mask]++;
+  for (b = 1; b < buckets; b++)
+    start[b] += start[b - 1];
+  start[buckets] = n;
+
+  entries.clear();
+  entries.resize(n);
+  for (i = n - 1; i >= 0; i--)
+    entries[--start[hashes[i] & mask]] = scratch[i];
+}
+
+static void editor_index_rebuild(struct arena *arena,
+                                 struct EditorIndex *index) {
   struct design *design = &arena->design;
-  struct joint *best_joint = NULL;
+  enum editor_index_mode mode = editor_index_mode(arena);
+  std::vector<JointIndexEntry> joint_scratch;
+  std::vector<BlockIndexEntry> block_scratch;
   struct joint *joint;
-  double best_dist = EDITOR_JOINT_EDGE_MAX_DISTANCE;
-  double dist;
+  struct block *block;
+  struct shell shell;
+  unsigned int size = 64;
+  double radius, cell_size;
+  int order;
+  int level;
+
+  index->valid = true;
+  index->modcount = design->modcount;
+  index->mode = mode;
+  index->new_block = mode == EDITOR_INDEX_CREATE ? arena->new_block : NULL;
+  index->big_joints.clear();
+  index->big_blocks.clear();
+  index->floating.clear();
+  index->joint_bucket.clear();
+  index->block_bucket.clear();
+
+  order = 0;
+  for (joint = design->joints.head; joint; joint = joint->next, order++) {
+    JointIndexEntry e;
+    e.joint = joint;
+    e.order = order;
+    if (editor_index_joint_floats(arena, mode, joint))
+      continue;
+    if (!editor_index_in_range(joint->x, joint->y)) {
+      index->big_joints.push_back(e);
+      continue;
+    }
+    joint_scratch.push_back(e);
+    index->joint_bucket.push_back(editor_index_hash(
+        0, editor_index_cell(joint->x, EDITOR_INDEX_CELL),
+        editor_index_cell(joint->y, EDITOR_INDEX_CELL)));
+  }
 
-  for (joint = design->joints.head; joint; joint = joint->next) {
-    dist = distance(x, y, joint->x, joint->y);
-    if (dist < best_dist) {
-      best_dist = dist;
-      best_joint = joint;
+  order = 0;
+  for (block = design->design_blocks.head; block;
+       block = block->next, order++) {
+    BlockIndexEntry e;
+    e.block = block;
+    e.order = order;
+    if (editor_index_block_floats(arena, mode, block)) {
+      index->floating.push_back(e);
+      continue;
     }
+    get_shell(&shell, &block->shape);
+    radius = block_hit_radius(&shell);
+    for (level = 0; level < EDITOR_INDEX_LEVELS; level++) {
+      if (radius <= editor_index_cell_size(level))
+        break;
+    }
+    if (level == EDITOR_INDEX_LEVELS ||
+        !editor_index_in_range(shell.x, shell.y)) {
+      index->big_blocks.push_back(e);
+      continue;
+    }
+    cell_size = editor_index_cell_size(level);
+    block_scratch.push_back(e);
+    index->block_bucket.push_back(
+        editor_index_hash(level, editor_index_cell(shell.x, cell_size),
+                          editor_index_cell(shell.y, cell_size)));
   }
 
-  return best_joint;
+  while (size < 2 * (joint_scratch.size() + block_scratch.size()))
+    size *= 2;
+  index->mask = size - 1;
+  editor_index_fill(index->mask, joint_scratch, index->joint_bucket,
+                    index->joint_start, index->joints);
+  editor_index_fill(index->mask, block_scratch, index->block_bucket,
+                    index->block_start, index->blocks);
 }
 
-struct joint *joint_hit_test_exclude_rod(struct arena *arena, float x, float y,
-                                         struct rod *rod, bool attached) {
-  struct design *design = &arena->design;
+static struct EditorIndex *editor_index_get(struct arena *arena) {
+  struct EditorIndex *index = static_cast<EditorIndex *>(arena->editor_index);
+  enum editor_index_mode mode = editor_index_mode(arena);
+
+  if (!index->valid || index->modcount != arena->design.modcount ||
+      index->mode != mode ||
+      (mode == EDITOR_INDEX_CREATE && index->new_block != arena->new_block))
+    editor_index_rebuild(arena, index);
+
+  return index;
+}
+
+/*
+ * Called by the move and create paths after they changed only floating pieces
+ * and bumped modcount. If the index was current before, it still is.
+ */
+static void editor_index_keep(struct arena *arena, int modcount) {
+  struct EditorIndex *index = static_cast<EditorIndex *>(arena->editor_index);
+
+  if (index->valid && index->modcount == modcount &&
+      index->mode == editor_index_mode(arena))
+    index->modcount = arena->design.modcount;
+}
+
+typedef bool (*joint_filter)(struct design *design, struct joint *joint,
+                             void *arg);
+
+/*
+ * Closest joint within EDITOR_JOINT_EDGE_MAX_DISTANCE that the filter accepts,
+ * the first in the joint list on ties.
+ */
+static struct joint *closest_joint_scan(struct design *design, float x,
+                                        float y, joint_filter filter,
+                                        void *arg) {
   struct joint *best_joint = NULL;
   struct joint *joint;
   double best_dist = EDITOR_JOINT_EDGE_MAX_DISTANCE;
   double dist;
 
   for (joint = design->joints.head; joint; joint = joint->next) {
-    if (joint == rod->from)
-      continue;
-    if (!attached && joint == rod->to)
-      continue;
-    if (!attached && share_block(design, rod->from, joint))
+    if (filter && !filter(design, joint, arg))
       continue;
     dist = distance(x, y, joint->x, joint->y);
     if (dist < best_dist) {
@@ -569,6 +1013,121 @@ struct joint *joint_hit_test_exclude_rod(struct arena *arena, float x, float y,
   return best_joint;
 }
 
+struct closest_joint_state {
+  struct design *design;
+  float x, y;
+  joint_filter filter;
+  void *arg;
+  struct joint *best_joint;
+  double best_dist;
+  int best_order;
+  bool ambiguous;
+};
+
+static void closest_joint_consider(struct closest_joint_state *st,
+                                   struct joint *joint, int order) {
+  double dist;
+
+  if (st->filter && !st->filter(st->design, joint, st->arg))
+    return;
+  dist = distance(st->x, st->y, joint->x, joint->y);
+  if (dist < st->best_dist) {
+    st->best_dist = dist;
+    st->best_joint = joint;
+    st->best_order = order;
+    st->ambiguous = false;
+  } else if (dist == st->best_dist && st->best_joint &&
+             joint != st->best_joint) {
+    if (order < 0 || st->best_order < 0) {
+      st->ambiguous = true;
+    } else if (order < st->best_order) {
+      st->best_joint = joint;
+      st->best_order = order;
+    }
+  }
+}
+
+// Same answer as closest_joint_scan, looking only at joints near (x, y).
+static struct joint *closest_joint(struct arena *arena, float x, float y,
+                                   joint_filter filter, void *arg) {
+  struct EditorIndex *index;
+  struct closest_joint_state st;
+  struct joint *joints[5];
+  unsigned int b;
+  int cx, cy, i, j, k, n;
+
+  if (!editor_index_in_range(x, y))
+    return closest_joint_scan(&arena->design, x, y, filter, arg);
+  index = editor_index_get(arena);
+
+  st.design = &arena->design;
+  st.x = x;
+  st.y = y;
+  st.filter = filter;
+  st.arg = arg;
+  st.best_joint = NULL;
+  st.best_dist = EDITOR_JOINT_EDGE_MAX_DISTANCE;
+  st.best_order = -1;
+  st.ambiguous = false;
+
+  cx = editor_index_cell(x, EDITOR_INDEX_CELL);
+  cy = editor_index_cell(y, EDITOR_INDEX_CELL);
+  for (j = cy - 1; j <= cy + 1; j++) {
+    for (i = cx - 1; i <= cx + 1; i++) {
+      b = editor_index_hash(0, i, j) & index->mask;
+      for (k = index->joint_start[b]; k < index->joint_start[b + 1]; k++)
+        closest_joint_consider(&st, index->joints[k].joint,
+                               index->joints[k].order);
+    }
+  }
+  for (JointIndexEntry &e : index->big_joints)
+    closest_joint_consider(&st, e.joint, e.order);
+  // floating joints may have been created since the rebuild: order unknown
+  for (BlockIndexEntry &e : index->floating) {
+    n = get_block_joints(e.block, joints);
+    for (i = 0; i < n; i++)
+      closest_joint_consider(&st, joints[i], -1);
+  }
+
+  // a tie the orders cannot settle is left to the scan
+  if (st.ambiguous)
+    return closest_joint_scan(&arena->design, x, y, filter, arg);
+
+  return st.best_joint;
+}
+
+struct joint *joint_hit_test(struct arena *arena, float x, float y) {
+  return closest_joint(arena, x, y, NULL, NULL);
+}
+
+struct exclude_rod_arg {
+  struct rod *rod;
+  bool attached;
+};
+
+static bool exclude_rod_filter(struct design *design, struct joint *joint,
+                               void *arg) {
+  struct exclude_rod_arg *ex = (struct exclude_rod_arg *)arg;
+  struct rod *rod = ex->rod;
+
+  if (joint == rod->from)
+    return false;
+  if (!ex->attached && joint == rod->to)
+    return false;
+  if (!ex->attached && share_block(design, rod->from, joint))
+    return false;
+  return true;
+}
+
+struct joint *joint_hit_test_exclude_rod(struct arena *arena, float x, float y,
+                                         struct rod *rod, bool attached) {
+  struct exclude_rod_arg ex;
+
+  ex.rod = rod;
+  ex.attached = attached;
+  return closest_joint(arena, x, y, exclude_rod_filter, &ex);
+}
+
 bool has_wheel(struct joint *joint, struct wheel *not_this_one) {
   struct attach_node *node;
 
@@ -584,36 +1143,39 @@ bool has_wheel(struct joint *joint, struct wheel *not_this_one) {
   return false;
 }
 
+struct exclude_wheel_arg {
+  struct wheel *wheel;
+  bool attached;
+};
+
+static bool exclude_wheel_filter(struct design *design, struct joint *joint,
+                                 void *arg) {
+  struct exclude_wheel_arg *ex = (struct exclude_wheel_arg *)arg;
+  struct wheel *wheel = ex->wheel;
+
+  if (!ex->attached && joint == wheel->center)
+    return false;
+  if (joint == wheel->spokes[0])
+    return false;
+  if (joint == wheel->spokes[1])
+    return false;
+  if (joint == wheel->spokes[2])
+    return false;
+  if (joint == wheel->spokes[3])
+    return false;
+  if (has_wheel(joint, wheel))
+    return false;
+  return true;
+}
+
 struct joint *joint_hit_test_exclude_wheel(struct arena *arena, float x,
                                            float y, struct wheel *wheel,
                                            bool attached) {
-  struct design *design = &arena->design;
-  struct joint *best_joint = NULL;
-  struct joint *joint;
-  double best_dist = EDITOR_JOINT_EDGE_MAX_DISTANCE;
-  double dist;
+  struct exclude_wheel_arg ex;
 
-  for (joint = design->joints.head; joint; joint = joint->next) {
-    if (!attached && joint == wheel->center)
-      continue;
-    if (joint == wheel->spokes[0])
-      continue;
-    if (joint == wheel->spokes[1])
-      continue;
-    if (joint == wheel->spokes[2])
-      continue;
-    if (joint == wheel->spokes[3])
-      continue;
-    if (has_wheel(joint, wheel))
-      continue;
-    dist = distance(x, y, joint->x, joint->y);
-    if (dist < best_dist) {
-      best_dist = dist;
-      best_joint = joint;
-    }
-  }
-
-  return best_joint;
+  ex.wheel = wheel;
+  ex.attached = attached;
+  return closest_joint(arena, x, y, exclude_wheel_filter, &ex);
 }
 
 bool rect_is_hit(struct shell *shell, float x, float y) {
@@ -648,8 +1210,8 @@ bool block_is_hit(struct block *block, float x, float y) {
     return rect_is_hit(&shell, x, y);
 }
 
-struct block *block_hit_test(struct arena *arena, float x, float y) {
-  struct design *design = &arena->design;
+static struct block *block_hit_test_scan(struct design *design, float x,
+                                         float y) {
   struct block *block;
 
   for (block = design->design_blocks.tail; block; block = block->prev) {
@@ -660,100 +1222,83 @@ struct block *block_hit_test(struct arena *arena, float x, float y) {
   return NULL;
 }
 
-static void get_rect_bb(struct shell *shell, struct area *area) {
-  // replicate truncation weirdness
-  float angle_degrees = shell->angle * 57.295779513082320876763;
-  if (fabs(angle_degrees) >= 32768) {
-    angle_degrees = -32768;
-  } else {
-    // likewise with ftlib, we're not sure enough truncation is a good change
-    // angle_degrees = (int)angle_degrees;
+// The last block in the list that is hit, looking only at blocks near (x, y).
+struct block *block_hit_test(struct arena *arena, float x, float y) {
+  struct EditorIndex *index;
+  struct block *best_block = NULL;
+  int best_order = -1;
+  double cell_size;
+  unsigned int b;
+  int cx, cy, i, j, k, level;
+
+  if (!editor_index_in_range(x, y))
+    return block_hit_test_scan(&arena->design, x, y);
+  index = editor_index_get(arena);
+
+  for (level = 0; level < EDITOR_INDEX_LEVELS; level++) {
+    cell_size = editor_index_cell_size(level);
+    cx = editor_index_cell(x, cell_size);
+    cy = editor_index_cell(y, cell_size);
+    for (j = cy - 1; j <= cy + 1; j++) {
+      for (i = cx - 1; i <= cx + 1; i++) {
+        b = editor_index_hash(level, i, j) & index->mask;
+        for (k = index->block_start[b]; k < index->block_start[b + 1]; k++) {
+          BlockIndexEntry &e = index->blocks[k];
+          if (e.order > best_order && block_is_hit(e.block, x, y)) {
+            best_block = e.block;
+            best_order = e.order;
+          }
+        }
+      }
+    }
   }
-  float angle_radians = angle_degrees * 0.017453292519943295769245;
-
-  float sina = fp_sin(angle_radians);
-  float cosa = fp_cos(angle_radians);
-  float wc = shell->rect.w * cosa;
-  float ws = shell->rect.w * sina;
-  float hc = shell->rect.h * cosa;
-  float hs = shell->rect.h * sina;
-
-  area->x = shell->x;
-  area->y = shell->y;
-  area->w = fabs(wc) + fabs(hs);
-  area->h = fabs(ws) + fabs(hc);
-  area->expand = 0;
-}
-
-static void get_circ_bb(struct shell *shell, struct area *area) {
-  area->x = shell->x;
-  area->y = shell->y;
-  area->w = shell->circ.radius * 2;
-  area->h = shell->circ.radius * 2;
-  area->expand = 0;
-}
-
-static void get_block_bb(struct block *block, struct area *area) {
-  struct shell shell;
-
-  get_shell(&shell, &block->shape);
-  if (block->body) {
-    shell.x = block->body->m_position.x;
-    shell.y = block->body->m_position.y;
-    shell.angle = block->body->m_rotation;
+  for (BlockIndexEntry &e : index->big_blocks) {
+    if (e.order > best_order && block_is_hit(e.block, x, y)) {
+      best_block = e.block;
+      best_order = e.order;
+    }
+  }
+  for (BlockIndexEntry &e : index->floating) {
+    if (e.order > best_order && block_is_hit(e.block, x, y)) {
+      best_block = e.block;
+      best_order = e.order;
+    }
   }
 
-  if (shell.type == SHELL_CIRC)
-    get_circ_bb(&shell, area);
-  else
-    get_rect_bb(&shell, area);
-}
-
-static int block_inside_area(struct block *block, struct area *area) {
-  struct area bb;
-
-  get_block_bb(block, &bb);
-
-  const double modified_w = area->w + area->expand;
-  const double modified_h = area->h + area->expand;
-
-  return bb.x - bb.w / 2 >= area->x - modified_w / 2 &&
-         bb.x + bb.w / 2 <= area->x + modified_w / 2 &&
-         bb.y - bb.h / 2 >= area->y - modified_h / 2 &&
-         bb.y + bb.h / 2 <= area->y + modified_h / 2;
+  return best_block;
 }
 
+/*
+ * Only the drag set and the new block can be flagged, so only their shapes
+ * are collided, against the pairs the broadphase already has for them. The
+ * rest of the world's contacts are left as they were.
+ */
 void mark_overlaps(struct arena *arena) {
-  b2Contact *contact;
   struct block *block;
 
   b2ContactManager_CleanContactList(&arena->world->m_contactManager);
   b2World_CleanBodyList(arena->world);
-  b2ContactManager_Collide(&arena->world->m_contactManager);
 
   for (block = arena->design.design_blocks.head; block; block = block->next) {
     block->overlap = false;
+    if (!block->in_drag_set && block != arena->new_block)
+      continue;
     if (!block_inside_area(block, &arena->design.build_area))
       block->overlap = true;
-  }
-
-  for (contact = arena->world->m_contactList; contact;
-       contact = contact->m_next) {
-    if (contact->m_manifoldCount > 0) {
-      block = (struct block *)contact->m_shape1->m_userData;
-      block->overlap = true;
-      block = (struct block *)contact->m_shape2->m_userData;
-      block->overlap = true;
+    for (b2Shape *shape = block->body->m_shapeList; shape;
+         shape = shape->m_next) {
+      if (b2ContactManager_CollideShape(&arena->world->m_contactManager,
+                                        shape) > 0)
+        block->overlap = true;
     }
   }
 
-  for (block = arena->design.design_blocks.head; block; block = block->next) {
-    if (!block->in_drag_set && block != arena->new_block)
-      block->overlap = false;
-  }
-
   for (block = arena->design.level_blocks.head; block; block = block->next)
     block->overlap = false;
+
+#ifdef VERIFY_EDIT_WORLD
+  assert(verify_edit_world(arena));
+#endif
 }
 
 void delete_rod_joints(struct design *design, struct rod *rod) {
@@ -986,6 +1531,7 @@ void move_root_block(struct block *block, double x, double y) {
 
 void update_move(struct arena *arena, double dx, double dy) {
   MoveState *ms = static_cast<MoveState *>(arena->move_state);
+  int modcount = arena->design.modcount;
 
   for (JointMoveEntry &e : ms->root_joints) {
     e.joint->x = e.orig_x + dx;
@@ -1004,6 +1550,8 @@ void update_move(struct arena *arena, double dx, double dy) {
   mark_overlaps(arena);
 
   arena->design.modcount++;
+  // only the drag set moved
+  editor_index_keep(arena, modcount);
 }
 
 void action_move(struct arena *arena, int x, int y) {
@@ -1130,12 +1678,14 @@ void action_new_rod(struct arena *arena, int x, int y) {
   float y_world;
   struct joint *joint;
   bool attached;
+  int modcount;
 
   pixel_to_world(&arena->view, x, y, &x_world, &y_world);
 
   attached = new_rod_attached(rod);
 
   joint = joint_hit_test_exclude_rod(arena, x_world, y_world, rod, attached);
+  modcount = arena->design.modcount;
 
   if (!attached) {
     if (joint) {
@@ -1156,6 +1706,8 @@ void action_new_rod(struct arena *arena, int x, int y) {
 
   update_body(arena, arena->new_block);
   mark_overlaps(arena);
+  // only the new block and its own joints changed
+  editor_index_keep(arena, modcount);
 
   arena->hover_joint = joint_hit_test(arena, x_world, y_world);
 }
@@ -1170,6 +1722,7 @@ void action_new_wheel(struct arena *arena, int x, int y) {
   float y_world;
   struct joint *joint;
   bool attached;
+  int modcount;
 
   pixel_to_world(&arena->view, x, y, &x_world, &y_world);
 
@@ -1177,6 +1730,7 @@ void action_new_wheel(struct arena *arena, int x, int y) {
 
   joint =
       joint_hit_test_exclude_wheel(arena, x_world, y_world, wheel, attached);
+  modcount = arena->design.modcount;
 
   if (!attached) {
     if (joint) {
@@ -1195,6 +1749,8 @@ void action_new_wheel(struct arena *arena, int x, int y) {
 
   update_body(arena, arena->new_block);
   mark_overlaps(arena);
+  // only the new block and its own joints changed
+  editor_index_keep(arena, modcount);
 
   arena->hover_joint = joint_hit_test(arena, x_world, y_world);
 }
@@ -1450,6 +2006,7 @@ void mouse_down_rod(struct arena *arena, float x, float y) {
   block->shape.rod.to = j1;
   block->shape.rod.to_att = att1;
   block->shape.rod.width = solid ? 8.0 : 4.0;
+  block->shape.rod.shell_cached = false;
   adjust_new_rod(&block->shape.rod);
 
   block->material = solid ? &solid_rod_material : &water_rod_material;
@@ -14,6 +14,9 @@
 #define MIN_MSPT 5
 #endif
 
+// the tick scheduler catches up on at most this much lost time
+#define MAX_TICK_DEBT_MS 100
+
 #define TAU 6.28318530718
 
 struct view {
@@ -48,9 +51,11 @@ struct arena {
   struct design design;
   b2World *world;
 
+  // tick scheduler state, see tick_func
   int ival;
-  int tick_ms;
-  int tick_multiply;
+  double tick_last_ms;
+  double tick_debt;
+  double tick_cost_ms;
 
   struct view view;
 
@@ -78,10 +83,19 @@ struct arena {
 
   struct block *new_block;
 
+  // spatial index for the editor's hit tests, see arena.cpp
+  void *editor_index; // actual type: EditorIndex*
+  // the editor's world while a run is in progress, see start()
+  void *edit_world; // actual type: EditWorld*
+
   // for game graphics
   void *block_graphics_v2; // actual type: block_graphics*
   // for ui graphics
   void *block_graphics_v2b; // actual type: block_graphics*
+  // for the preview trail, cached across frames
+  void *trail_graphics; // actual type: trail_graphics*
+  // renderable state, published for the renderer
+  void *render_snapshots; // actual type: render_snapshot_buffer_t*
 
   uint64_t frame_counter;
   uint64_t tick;
@@ -94,9 +108,8 @@ struct arena {
   bool autostop_on_solve;
 
   bool preview_goal_piece_trajectory;
-  struct design *preview_design;
-  b2World *preview_world;
-  void *preview_trail; // real type: multi_trail_t*
+  void *preview_worker; // real type: preview_worker_t*
+  void *preview_trail;  // real type: multi_trail_t*
   bool preview_has_won;
   bool lock_if_preview_solves;
 
@@ -126,14 +139,12 @@ void arena_mouse_button_down_event(struct arena *arena, int button);
 void arena_size_event(struct arena *arena, float w, float h);
 
 bool is_design_legal(struct design *design);
+void preview_cancel(struct arena *arena);
+void preview_update(struct arena *arena);
+void render_snapshot_publish(struct arena *arena);
 
-bool goal_blocks_inside_goal_area(struct design *design);
 void tick_func(void *arg);
 
-// recalculate checksum; store the value and return it
-// 31-bit checksum, always a positive value
-int recalculate_design_checksum(struct design *design);
-
 int block_list_len(struct block_list *list);
 int design_piece_count(struct block_list *list);
 
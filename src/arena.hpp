@@ -18,8 +18,43 @@ struct trail_t {
 
 struct multi_trail_t {
   std::vector<trail_t> trails;
-  bool accepting();
-  void submit_frame(design *);
+  // bumped on every clear so cached trail geometry can tell it is stale
+  uint64_t generation = 0;
+  void clear();
 };
 
+// Renderable state published by whoever steps or edits the design, and read
+// by the renderer without locking. Poses are listed level blocks first, in
+// list order.
+struct block_pose_t {
+  bool has_body;
+  b2Vec2 position;
+  float64 rotation;
+};
+
+struct render_snapshot_t {
+  uint64_t tick;
+  uint64_t tick_solve;
+  bool has_won;
+  int single_ticks_remaining;
+  bool autostop_on_solve;
+  std::vector<block_pose_t> poses;
+};
+
+// Triple buffer. Publishers fill the back slot and swap it with the ready
+// slot; the renderer swaps its front slot with the ready slot when that has
+// been refreshed. Publishers must be serialised with each other.
+#define RENDER_SNAPSHOT_INDEX 3
+#define RENDER_SNAPSHOT_FRESH 4
+
+struct render_snapshot_buffer_t {
+  render_snapshot_t slots[3];
+  int back = 0;  // publisher only
+  int ready = 1; // shared, accessed atomically
+  int front = 2; // renderer only
+};
+
+const render_snapshot_t *render_snapshot_acquire(arena *);
+const render_snapshot_t *render_snapshot_current(arena *);
+
 #endif // ARENA_HPP
@@ -9,297 +9,364 @@
 #include "interval.h"
 #include "stl_compat.h"
 
-struct checksum_state_t {
-  uint64_t value = 0;
-  uint64_t joint_uid = 0;
+// Trajectory preview.
+//
+// Each preview runs as a job: a packed snapshot of the design taken by the
+// renderer, which the preview worker unpacks, turns into a world and steps. Where
+// the platform can start a background worker that is a separate thread;
+// otherwise tick_func runs the worker in its leftover time budget. Goal piece
+// positions are written into a buffer allocated up front and published with a
+// release store of the frame count, so the renderer reads them without
+// locking. Jobs are owned by the renderer and only freed once the worker has
+// let go of them.
+
+const size_t PREVIEW_TICK_LIMIT = 10000;
+
+struct preview_job_t {
+  struct packed_design *packed;
+  // worker only, unpacked when the job is picked up
+  struct design *design;
+  b2World *world;
+  int modcount;
+  size_t goal_count;
+  bool legal;
+  // goal_count positions per frame
+  std::vector<b2Vec2> points;
+  // shared with the worker, accessed atomically
+  size_t frames;
+  bool has_won;
+  bool cancelled;
+  bool released;
+};
+
+struct preview_worker_t {
+  // handed to the worker, accessed atomically
+  preview_job_t *pending;
+  // worker only
+  preview_job_t *running;
+  // set before the worker is published
+  bool threaded;
+  // renderer only
+  preview_job_t *current;
+  std::vector<preview_job_t *> retired;
 };
 
-uint64_t _checksum_value_combine(uint64_t x, uint64_t y) {
-  x = x * 0x6a999a34a7c5df1bull + y + 0xd10dbc37a7c9b29bull;
-  x ^= x >> 33;
-  return x;
+static void preview_job_release(preview_job_t *job) {
+  __atomic_store_n(&job->released, true, __ATOMIC_RELEASE);
 }
 
-void _add_value_to_checksum(checksum_state_t &state, uint64_t x) {
-  state.value = _checksum_value_combine(state.value, x);
+static void preview_job_free(preview_job_t *job) {
+  if (job->design)
+    free_design(job->design);
+  free_packed_design(job->packed);
+  job->~preview_job_t();
+  free(job);
 }
 
-void _add_value_to_checksum(checksum_state_t &state, double x) {
-  union {
-    double as_double;
-    uint64_t as_uint64;
-  } union_value;
-  union_value.as_double = x;
-  _add_value_to_checksum(state, union_value.as_uint64);
+// Runs up to max_steps preview ticks on the calling thread. Returns whether
+// there was a job to work on.
+static bool preview_worker_run(preview_worker_t *worker, int max_steps) {
+  preview_job_t *job = worker->running;
+  if (!job) {
+    job = __atomic_exchange_n(&worker->pending, (preview_job_t *)NULL,
+                              __ATOMIC_ACQ_REL);
+    if (!job)
+      return false;
+    worker->running = job;
+    job->design = unpack_design(job->packed);
+    job->world = gen_world(job->design);
+    job->legal = is_design_legal(job->design);
+  }
+  for (int i = 0; i < max_steps; ++i) {
+    size_t frame = job->frames;
+    if (frame >= PREVIEW_TICK_LIMIT || job->goal_count == 0 ||
+        __atomic_load_n(&job->cancelled, __ATOMIC_ACQUIRE)) {
+      free_world(job->world, job->design);
+      job->world = NULL;
+      worker->running = NULL;
+      preview_job_release(job);
+      break;
+    }
+    b2Vec2 *out = &job->points[frame * job->goal_count];
+    for (block *the_block = job->design->design_blocks.head; the_block;
+         the_block = the_block->next) {
+      if (the_block->goal)
+        *out++ = the_block->body->m_position;
+    }
+    __atomic_store_n(&job->frames, frame + 1, __ATOMIC_RELEASE);
+    step(job->world);
+    if (job->legal && goal_blocks_inside_goal_area(job->design))
+      __atomic_store_n(&job->has_won, true, __ATOMIC_RELEASE);
+  }
+  return true;
 }
 
-void _add_area_to_checksum(checksum_state_t &state, struct area *area) {
-  _add_value_to_checksum(state, area->x);
-  _add_value_to_checksum(state, area->y);
-  _add_value_to_checksum(state, area->w);
-  _add_value_to_checksum(state, area->h);
-  //_add_value_to_checksum(state, area->expand);
+static int preview_worker_thread_func(void *arg) {
+  return preview_worker_run((preview_worker_t *)arg, 256);
 }
 
-void _add_joint_to_checksum(checksum_state_t &state, struct joint *joint) {
-  if (joint == nullptr) {
-    _add_value_to_checksum(state, (uint64_t)(0));
-    return;
+static preview_worker_t *preview_get_worker(arena *the_arena) {
+  if (the_arena->preview_worker == nullptr) {
+    preview_worker_t *worker = _new<preview_worker_t>();
+#ifdef CLI
+    worker->threaded = false;
+#else
+    worker->threaded =
+        start_worker(preview_worker_thread_func, (void *)worker) == 0;
+#endif
+    // tick_func may look for this from the simulation thread
+    __atomic_store_n(&the_arena->preview_worker, (void *)worker,
+                     __ATOMIC_RELEASE);
   }
-  _add_value_to_checksum(state, (uint64_t)(joint->_checksum_uid));
+  return (preview_worker_t *)the_arena->preview_worker;
 }
 
-void _assign_joint_uid(checksum_state_t &state, struct joint *joint,
-                       int phase) {
-  if (joint == nullptr) {
-    return;
-  }
-  switch (phase) {
-  case 0: {
-    // set initial id
-    joint->_checksum_uid = ++state.joint_uid;
-    break;
-  }
-  case 1: {
-    // count neighbours
-    if (joint->prev != nullptr) {
-      joint->_checksum_uid = _checksum_value_combine(joint->_checksum_uid, 1);
-      joint->_checksum_uid = _checksum_value_combine(
-          joint->_checksum_uid, joint->prev->_checksum_uid);
-    }
-    if (joint->next != nullptr) {
-      joint->_checksum_uid = _checksum_value_combine(joint->_checksum_uid, 2);
-      joint->_checksum_uid = _checksum_value_combine(
-          joint->_checksum_uid, joint->next->_checksum_uid);
-    }
-    break;
+static void preview_reclaim(preview_worker_t *worker) {
+  size_t kept = 0;
+  for (size_t i = 0; i < worker->retired.size(); ++i) {
+    preview_job_t *job = worker->retired[i];
+    if (__atomic_load_n(&job->released, __ATOMIC_ACQUIRE))
+      preview_job_free(job);
+    else
+      worker->retired[kept++] = job;
   }
+  worker->retired.resize(kept);
+}
+
+extern "C" void preview_cancel(struct arena *the_arena) {
+  preview_worker_t *worker = (preview_worker_t *)the_arena->preview_worker;
+  if (worker == nullptr || worker->current == nullptr)
+    return;
+  preview_job_t *job = worker->current;
+  worker->current = nullptr;
+  __atomic_store_n(&job->cancelled, true, __ATOMIC_RELEASE);
+  // a job the worker never picked up will not be released by it
+  preview_job_t *expected = job;
+  if (__atomic_compare_exchange_n(&worker->pending, &expected,
+                                  (preview_job_t *)NULL, false,
+                                  __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE))
+    preview_job_release(job);
+  worker->retired.push_back(job);
+  preview_reclaim(worker);
+}
+
+static void preview_start(arena *the_arena, preview_worker_t *worker) {
+  preview_cancel(the_arena);
+
+  preview_job_t *job = _new<preview_job_t>();
+  job->packed = pack_design(&the_arena->design);
+  job->design = nullptr;
+  job->world = nullptr;
+  job->modcount = the_arena->design.modcount;
+  job->goal_count = 0;
+  packed_block *blocks = packed_design_blocks(job->packed);
+  for (int i = job->packed->level_block_count; i < job->packed->block_count;
+       i++) {
+    if (blocks[i].goal)
+      job->goal_count++;
   }
+  job->points.resize(job->goal_count * PREVIEW_TICK_LIMIT);
+  job->frames = 0;
+  job->has_won = false;
+  job->cancelled = false;
+  job->released = false;
+  worker->current = job;
+  __atomic_store_n(&worker->pending, job, __ATOMIC_RELEASE);
+#ifndef CLI
+  if (worker->threaded)
+    wake_workers();
+#endif
+
+  the_arena->preview_has_won = false;
+  multi_trail_t *all_trails = (multi_trail_t *)the_arena->preview_trail;
+  all_trails->clear();
 }
 
-void _add_block_to_checksum(checksum_state_t &state, struct block *block,
-                            int phase) {
-  switch (phase) {
-  case 0:
-  case 1: {
-    // joint-only passes
-    switch (block->shape.type) {
-    case shape_type::SHAPE_BOX: {
-      _assign_joint_uid(state, block->shape.box.center, phase);
-      for (int i = 0; i < 4; ++i) {
-        _assign_joint_uid(state, block->shape.box.corners[i], phase);
-      }
-      break;
-    }
-    case shape_type::SHAPE_ROD: {
-      _assign_joint_uid(state, block->shape.rod.from, phase);
-      _assign_joint_uid(state, block->shape.rod.to, phase);
-      break;
-    }
-    case shape_type::SHAPE_WHEEL: {
-      _assign_joint_uid(state, block->shape.wheel.center, phase);
-      for (int i = 0; i < 4; ++i) {
-        _assign_joint_uid(state, block->shape.wheel.spokes[i], phase);
-      }
-      break;
-    }
-    }
-    break;
+// Copies newly published frames of the current job into the trails.
+static void preview_collect(arena *the_arena, preview_job_t *job) {
+  multi_trail_t *all_trails = (multi_trail_t *)the_arena->preview_trail;
+  size_t frames = __atomic_load_n(&job->frames, __ATOMIC_ACQUIRE);
+  while (all_trails->trails.size() < job->goal_count) {
+    all_trails->trails.emplace_back();
   }
-  case 2: {
-    // gather main hash
-    _add_value_to_checksum(state, (uint64_t)(block->type_id));
-    _add_value_to_checksum(state, (uint64_t)(block->shape.type));
-    switch (block->shape.type) {
-    case shape_type::SHAPE_RECT: {
-      _add_value_to_checksum(state, block->shape.rect.x);
-      _add_value_to_checksum(state, block->shape.rect.y);
-      _add_value_to_checksum(state, block->shape.rect.w);
-      _add_value_to_checksum(state, block->shape.rect.h);
-      _add_value_to_checksum(state, block->shape.rect.angle);
-      break;
-    }
-    case shape_type::SHAPE_CIRC: {
-      _add_value_to_checksum(state, block->shape.circ.x);
-      _add_value_to_checksum(state, block->shape.circ.y);
-      _add_value_to_checksum(state, block->shape.circ.radius);
-      break;
-    }
-    case shape_type::SHAPE_BOX: {
-      _add_value_to_checksum(state, block->shape.box.x);
-      _add_value_to_checksum(state, block->shape.box.y);
-      _add_value_to_checksum(state, block->shape.box.w);
-      _add_value_to_checksum(state, block->shape.box.h);
-      _add_value_to_checksum(state, block->shape.box.angle);
-      _add_joint_to_checksum(state, block->shape.box.center);
-      for (int i = 0; i < 4; ++i) {
-        _add_joint_to_checksum(state, block->shape.box.corners[i]);
-      }
-      break;
+  for (size_t goal = 0; goal < job->goal_count; ++goal) {
+    std::vector<b2Vec2> &datapoints = all_trails->trails[goal].datapoints;
+    for (size_t frame = datapoints.size(); frame < frames; ++frame) {
+      datapoints.push_back(job->points[frame * job->goal_count + goal]);
     }
-    case shape_type::SHAPE_ROD: {
-      _add_joint_to_checksum(state, block->shape.rod.from);
-      _add_joint_to_checksum(state, block->shape.rod.to);
-      _add_value_to_checksum(state, block->shape.rod.width);
-      break;
-    }
-    case shape_type::SHAPE_WHEEL: {
-      _add_joint_to_checksum(state, block->shape.wheel.center);
-      _add_value_to_checksum(state, block->shape.wheel.radius);
-      _add_value_to_checksum(state, block->shape.wheel.angle);
-      //_add_value_to_checksum(state, (uint64_t)(block->shape.wheel.spin));
-      for (int i = 0; i < 4; ++i) {
-        _add_joint_to_checksum(state, block->shape.wheel.spokes[i]);
-      }
-      break;
-    }
-    }
-    // shell is theoretically redundant, but we add it anyway
-    shell shell_normalized;
-    get_shell(&shell_normalized, &block->shape);
-    _add_value_to_checksum(state, shell_normalized.x);
-    _add_value_to_checksum(state, shell_normalized.y);
-    _add_value_to_checksum(state, shell_normalized.angle);
-    _add_value_to_checksum(state, (uint64_t)(shell_normalized.type));
-    switch (shell_normalized.type) {
-    case SHELL_CIRC: {
-      _add_value_to_checksum(state, shell_normalized.circ.radius);
-      break;
-    }
-    case SHELL_RECT: {
-      _add_value_to_checksum(state, shell_normalized.rect.w);
-      _add_value_to_checksum(state, shell_normalized.rect.h);
-      break;
-    }
-    }
-    break;
-  }
   }
+  if (__atomic_load_n(&job->has_won, __ATOMIC_ACQUIRE))
+    the_arena->preview_has_won = true;
 }
 
-extern "C" int recalculate_design_checksum(struct design *design) {
-  checksum_state_t state;
-  struct block *block;
-  for (int phase = 0; phase < 3; ++phase) {
-    for (block = design->level_blocks.head; block; block = block->next)
-      _add_block_to_checksum(state, block, phase);
-
-    for (block = design->design_blocks.head; block; block = block->next)
-      _add_block_to_checksum(state, block, phase);
+// Runs one tick. Returns false if ticking should stop for now.
+static bool tick_once(arena *the_arena) {
+  if (the_arena->single_ticks_remaining > 0)
+    the_arena->single_ticks_remaining--;
+#ifdef CLI
+  // log all blocks just before step
+  std::cerr << std::setprecision(17);
+  std::cerr << "Tick " << the_arena->tick << std::endl;
+  for (block *block_ptr = the_arena->design.design_blocks.head; block_ptr;
+       block_ptr = block_ptr->next) {
+    b2Body *body_ptr = block_ptr->body;
+    std::cerr << "- ID = " << block_ptr->uid
+              << ", Type = " << (int)block_ptr->type_id << ", Pos = ("
+              << body_ptr->m_position.x << ", " << body_ptr->m_position.y
+              << "), Vel = (" << body_ptr->m_linearVelocity.x << ", "
+              << body_ptr->m_linearVelocity.y
+              << "), Ang = " << body_ptr->m_rotation
+              << ", AngVel = " << body_ptr->m_angularVelocity << std::endl;
   }
-  _add_area_to_checksum(state, &design->build_area);
-  _add_area_to_checksum(state, &design->goal_area);
-  int result = (int)(state.value & 0x7fffffff);
-  // require not 0
-  if (result == 0) {
-    result = 1;
+#endif
+  step(the_arena->world);
+  the_arena->tick++;
+  if (!the_arena->has_won &&
+      goal_blocks_inside_goal_area(&the_arena->design)) {
+    the_arena->has_won = true;
+    the_arena->tick_solve = the_arena->tick;
+    if (the_arena->autostop_on_solve) {
+      the_arena->autostop_on_solve = false;
+      the_arena->single_ticks_remaining = 0;
+      return false;
+    }
   }
-  design->actual_checksum = result;
-  return result;
+  return true;
 }
 
+// Ticks are scheduled against real time. Each call adds the ticks owed since
+// the previous call to tick_debt, capped at MAX_TICK_DEBT_MS worth, and pays
+// them off in batches sized from the measured cost of a tick, so the clock is
+// only read between batches and no call runs for much longer than MIN_MSPT.
+// Explicit single steps run straight away.
 extern "C" void tick_func(void *arg) {
   arena *the_arena = (arena *)arg;
 
   double time_start = time_precise_ms();
-  for (int i = 0;
-       is_running(the_arena) && the_arena->single_ticks_remaining != 0 &&
-       i < the_arena->tick_multiply;
-       ++i) {
-    if (the_arena->single_ticks_remaining > 0)
-      the_arena->single_ticks_remaining--;
-#ifdef CLI
-    // log all blocks just before step
-    std::cerr << std::setprecision(17);
-    std::cerr << "Tick " << the_arena->tick << std::endl;
-    for (block *block_ptr = the_arena->design.design_blocks.head; block_ptr;
-         block_ptr = block_ptr->next) {
-      b2Body *body_ptr = block_ptr->body;
-      std::cerr << "- ID = " << block_ptr->uid
-                << ", Type = " << (int)block_ptr->type_id << ", Pos = ("
-                << body_ptr->m_position.x << ", " << body_ptr->m_position.y
-                << "), Vel = (" << body_ptr->m_linearVelocity.x << ", "
-                << body_ptr->m_linearVelocity.y
-                << "), Ang = " << body_ptr->m_rotation
-                << ", AngVel = " << body_ptr->m_angularVelocity << std::endl;
+  double time_limit = time_start + MIN_MSPT;
+  double elapsed = time_start - the_arena->tick_last_ms;
+  the_arena->tick_last_ms = time_start;
+  if (!is_running(the_arena) || the_arena->single_ticks_remaining != -1) {
+    // stopped, paused or single stepping: no ticks are owed
+    the_arena->tick_debt = 0;
+  } else {
+    double max_debt = _fcsim_target_tps * MAX_TICK_DEBT_MS / 1000;
+    the_arena->tick_debt = std::min(
+        the_arena->tick_debt + elapsed * _fcsim_target_tps / 1000, max_debt);
+  }
+
+  double now = time_start;
+  while (is_running(the_arena) && the_arena->single_ticks_remaining != 0 &&
+         now < time_limit) {
+    double owed = the_arena->single_ticks_remaining > 0
+                      ? the_arena->single_ticks_remaining
+                      : the_arena->tick_debt;
+    if (owed < 1)
+      break;
+    double affordable = the_arena->tick_cost_ms > 0
+                            ? (time_limit - now) / the_arena->tick_cost_ms
+                            : owed;
+    int64_t batch = (int64_t)std::max(1.0, std::min(owed, affordable));
+    int64_t done = 0;
+    bool keep_going = true;
+    while (keep_going && done < batch) {
+      keep_going = tick_once(the_arena);
+      done++;
     }
-#endif
-    step(the_arena->world);
-    the_arena->tick++;
-    if (!the_arena->has_won &&
-        goal_blocks_inside_goal_area(&the_arena->design)) {
-      the_arena->has_won = true;
-      the_arena->tick_solve = the_arena->tick;
-      if (the_arena->autostop_on_solve) {
-        the_arena->autostop_on_solve = false;
-        the_arena->single_ticks_remaining = 0;
-        break;
-      }
+    double then = time_precise_ms();
+    // batches too short for the clock to resolve say nothing about the cost
+    if (then > now) {
+      the_arena->tick_cost_ms =
+          (the_arena->tick_cost_ms + (then - now) / done) / 2;
     }
-    double time_end = time_precise_ms();
-    if (time_end - time_start >= the_arena->tick_ms)
+    now = then;
+    the_arena->tick_debt = std::max(0.0, the_arena->tick_debt - done);
+    if (!keep_going)
       break;
   }
 
-  if (the_arena->preview_goal_piece_trajectory) {
-    // use remaining time budget for preview hyperspeed
-    if (the_arena->preview_trail == nullptr) {
-      the_arena->preview_trail = _new<multi_trail_t>();
-    }
-    multi_trail_t *all_trails = (multi_trail_t *)the_arena->preview_trail;
-    if (the_arena->preview_design == nullptr ||
-        the_arena->preview_design->modcount != the_arena->design.modcount) {
-      // refresh preview design
-      // manually clear old data
-      the_arena->preview_has_won = false;
-      if (the_arena->preview_world) {
-        free_world(the_arena->preview_world, the_arena->preview_design);
-      }
-      the_arena->preview_world = nullptr;
-      if (the_arena->preview_design) {
-        free_design(the_arena->preview_design);
-      }
-      the_arena->preview_design = nullptr;
-      // populate new data from clone
-      the_arena->preview_design = clean_copy_design(&the_arena->design);
-      the_arena->preview_world = gen_world(the_arena->preview_design);
-      // clear trails
-      all_trails->trails.clear();
-    }
-    bool is_preview_design_legal = is_design_legal(the_arena->preview_design);
-    // tick until time budget is exhausted
-    while (all_trails->accepting()) {
-      all_trails->submit_frame(the_arena->preview_design);
-      step(the_arena->preview_world);
-      if (is_preview_design_legal &&
-          goal_blocks_inside_goal_area(the_arena->preview_design)) {
-        the_arena->preview_has_won = true;
-      }
-      double time_end = time_precise_ms();
-      if (time_end - time_start >= the_arena->tick_ms)
-        break;
+  preview_worker_t *worker = (preview_worker_t *)__atomic_load_n(
+      &the_arena->preview_worker, __ATOMIC_ACQUIRE);
+  if (worker && !worker->threaded) {
+    // no background worker: use the remaining time budget
+    while (now < time_limit && preview_worker_run(worker, 1)) {
+      now = time_precise_ms();
     }
   }
+
+#ifndef CLI
+  render_snapshot_publish(the_arena);
+#endif
+}
+
+extern "C" void preview_update(struct arena *the_arena) {
+  if (!the_arena->preview_goal_piece_trajectory) {
+    preview_cancel(the_arena);
+    return;
+  }
+  if (the_arena->preview_trail == nullptr) {
+    the_arena->preview_trail = _new<multi_trail_t>();
+  }
+  preview_worker_t *worker = preview_get_worker(the_arena);
+  if (worker->current == nullptr ||
+      worker->current->modcount != the_arena->design.modcount) {
+    preview_start(the_arena, worker);
+  }
+  preview_collect(the_arena, worker->current);
+  preview_reclaim(worker);
 }
 
-bool multi_trail_t::accepting() {
-  const size_t PREVIEW_TICK_LIMIT = 10000;
-  return trails.size() == 0 || trails[0].datapoints.size() < PREVIEW_TICK_LIMIT;
+void multi_trail_t::clear() {
+  trails.clear();
+  generation++;
 }
 
-void multi_trail_t::submit_frame(design *current_design) {
-  // scan for goal pieces
-  size_t trail_index = 0;
-  for (block *the_block = current_design->design_blocks.head; the_block;
-       the_block = the_block->next) {
-    if (the_block->goal) {
-      // record position in the corresponding location
-      while (trails.size() <= trail_index) {
-        trails.emplace_back();
+extern "C" void render_snapshot_publish(struct arena *the_arena) {
+  render_snapshot_buffer_t *buffer =
+      (render_snapshot_buffer_t *)the_arena->render_snapshots;
+  if (buffer == nullptr)
+    return;
+  render_snapshot_t &snapshot = buffer->slots[buffer->back];
+  snapshot.tick = the_arena->tick;
+  snapshot.tick_solve = the_arena->tick_solve;
+  snapshot.has_won = the_arena->has_won;
+  snapshot.single_ticks_remaining = the_arena->single_ticks_remaining;
+  snapshot.autostop_on_solve = the_arena->autostop_on_solve;
+  snapshot.poses.clear();
+  block_list *lists[2] = {&the_arena->design.level_blocks,
+                          &the_arena->design.design_blocks};
+  for (int i = 0; i < 2; ++i) {
+    for (block *the_block = lists[i]->head; the_block;
+         the_block = the_block->next) {
+      block_pose_t pose;
+      pose.has_body = the_block->body != nullptr;
+      if (pose.has_body) {
+        pose.position = the_block->body->m_position;
+        pose.rotation = the_block->body->m_rotation;
       }
-      const b2Vec2 position = the_block->body->m_position;
-      trails[trail_index].datapoints.push_back(position);
-      trail_index++;
+      snapshot.poses.push_back(pose);
     }
   }
+  buffer->back = __atomic_exchange_n(&buffer->ready,
+                                     buffer->back | RENDER_SNAPSHOT_FRESH,
+                                     __ATOMIC_ACQ_REL) &
+                 RENDER_SNAPSHOT_INDEX;
+}
+
+const render_snapshot_t *render_snapshot_acquire(arena *the_arena) {
+  render_snapshot_buffer_t *buffer =
+      (render_snapshot_buffer_t *)the_arena->render_snapshots;
+  if (__atomic_load_n(&buffer->ready, __ATOMIC_ACQUIRE) &
+      RENDER_SNAPSHOT_FRESH) {
+    buffer->front =
+        __atomic_exchange_n(&buffer->ready, buffer->front, __ATOMIC_ACQ_REL) &
+        RENDER_SNAPSHOT_INDEX;
+  }
+  return &buffer->slots[buffer->front];
+}
+
+const render_snapshot_t *render_snapshot_current(arena *the_arena) {
+  render_snapshot_buffer_t *buffer =
+      (render_snapshot_buffer_t *)the_arena->render_snapshots;
+  return &buffer->slots[buffer->front];
 }
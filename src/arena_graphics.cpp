@@ -51,6 +51,11 @@ struct block_graphics {
   // flags
   bool simple_graphics = false;
   bool wireframe = false;
+  // visible world rectangle; culling and level of detail only apply once a
+  // view has been set
+  bool has_view = false;
+  float view_x0, view_y0, view_x1, view_y1;
+  float world_per_pixel;
   // working values
   std::vector<block_graphics_layer> layers;
   // final values
@@ -71,6 +76,41 @@ struct block_graphics {
   uint32_t push_vertex(float x, float y, color col, int z_offset);
   void push_triangle(uint32_t v1, uint32_t v2, uint32_t v3, int z_offset);
   void push_all_layers();
+  void set_view(struct view *view);
+  bool is_visible(float x, float y, float radius);
+  int circle_segments(float radius);
+};
+
+// Preview trail geometry, kept across frames in its own buffers. Trails only
+// grow between clears, so each frame simplifies and appends the new points
+// instead of rebuilding every segment.
+struct trail_graphics_run {
+  size_t consumed = 0;         // datapoints already simplified
+  b2Vec2 anchor;               // end of the last emitted segment
+  std::vector<b2Vec2> pending; // points since anchor, not emitted yet
+};
+
+struct trail_graphics {
+  // what the cached geometry was built for
+  uint64_t generation = 0;
+  float tolerance = 0;
+  color col = {0, 0, 0, 0};
+  // working values
+  std::vector<trail_graphics_run> runs;
+  block_graphics_layer mesh;
+  // final values
+  GLuint _index_buffer;
+  GLuint _coord_buffer;
+  GLuint _color_buffer;
+  size_t _vertex_capacity = 0;
+  size_t _index_capacity = 0;
+  size_t _uploaded_vertices = 0;
+  size_t _uploaded_indices = 0;
+  // methods
+  void clear();
+  void add_point(trail_graphics_run &run, b2Vec2 point);
+  void upload();
+  void draw(struct view *view);
 };
 
 struct ui_button_id {
@@ -185,6 +225,36 @@ void block_graphics::push_all_layers() {
 
 void block_graphics::clear() { layers.clear(); }
 
+void block_graphics::set_view(struct view *view) {
+  // inverse of the transform in block_graphics_draw
+  has_view = true;
+  view_x0 = view->x - view->width * view->scale;
+  view_x1 = view->x + view->width * view->scale;
+  view_y0 = view->y - view->height * view->scale;
+  view_y1 = view->y + view->height * view->scale;
+  world_per_pixel = 2 * view->scale;
+}
+
+bool block_graphics::is_visible(float x, float y, float radius) {
+  if (!has_view)
+    return true;
+  return x + radius >= view_x0 && x - radius <= view_x1 &&
+         y + radius >= view_y0 && y - radius <= view_y1;
+}
+
+int block_graphics::circle_segments(float radius) {
+  const int default_segments = 24;
+  const int min_segments = 8;
+  const int max_segments = 64;
+  if (!has_view)
+    return default_segments;
+  // keep each chord within a quarter pixel of the true circle:
+  // r * (1 - cos(pi / n)) <= 1/4 gives n >= pi * sqrt(2 * r) for r in pixels
+  float radius_px = std::abs(radius) / world_per_pixel;
+  int segments = (int)(TAU / 2 * sqrt(2 * radius_px)) + 1;
+  return std::min(std::max(segments, min_segments), max_segments);
+}
+
 void fps_tracker_t::push_record(int64_t tick_value) {
   // get new sample values
   double time_value = time_precise_ms();
@@ -216,10 +286,18 @@ void fps_tracker_t::clear() {
   samples = 0;
 }
 
-shell get_shell(block *block) {
+// Reads the body through the published pose when there is one, since the
+// simulation may be stepping the body at the same time.
+shell get_shell(block *block, const block_pose_t *pose) {
   shell shell;
   get_shell(&shell, &block->shape);
-  if (block->body) {
+  if (pose) {
+    if (pose->has_body) {
+      shell.x = pose->position.x;
+      shell.y = pose->position.y;
+      shell.angle = pose->rotation;
+    }
+  } else if (block->body) {
     shell.x = block->body->m_position.x;
     shell.y = block->body->m_position.y;
     shell.angle = block->body->m_rotation;
@@ -234,11 +312,11 @@ joint joint_from_xy(float x, float y) {
   return result;
 }
 
-std::vector<joint> generate_joints(block *block) {
+std::vector<joint> generate_joints(block *block, const block_pose_t *pose) {
   // The order here may not match the data model; visually it makes no
   // difference
   const int type_id = block->type_id;
-  shell shell = get_shell(block);
+  shell shell = get_shell(block, pose);
   std::vector<joint> result;
   float sina_half = sinf(shell.angle) / 2;
   float cosa_half = cosf(shell.angle) / 2;
@@ -372,8 +450,9 @@ static void block_graphics_add_area(struct block_graphics *graphics,
   block_graphics_add_rect(graphics, area_shell, type_id, 0, color{0, 0, 0, 0});
 }
 
-void block_graphics_add_line(block_graphics *graphics, b2Vec2 start, b2Vec2 end,
-                             double radius, color col, int z_offset) {
+static void block_graphics_layer_add_line(block_graphics_layer &layer,
+                                         b2Vec2 start, b2Vec2 end,
+                                         double radius, color col) {
   const double dx1 = end.x - start.x;
   const double dy1 = end.y - start.y;
 
@@ -386,22 +465,27 @@ void block_graphics_add_line(block_graphics *graphics, b2Vec2 start, b2Vec2 end,
   const double dx3 = dx2 - dy2;
   const double dy3 = dx2 + dy2;
 
-  uint32_t v1 = graphics->push_vertex(end.x + dx3, end.y + dy3, col, z_offset);
-  uint32_t v2 = graphics->push_vertex(end.x + dy3, end.y - dx3, col, z_offset);
-  uint32_t v3 =
-      graphics->push_vertex(start.x - dx3, start.y - dy3, col, z_offset);
-  uint32_t v4 =
-      graphics->push_vertex(start.x - dy3, start.y + dx3, col, z_offset);
+  uint32_t v1 = layer.push_vertex(end.x + dx3, end.y + dy3, col);
+  uint32_t v2 = layer.push_vertex(end.x + dy3, end.y - dx3, col);
+  uint32_t v3 = layer.push_vertex(start.x - dx3, start.y - dy3, col);
+  uint32_t v4 = layer.push_vertex(start.x - dy3, start.y + dx3, col);
 
-  graphics->push_triangle(v1, v2, v3, z_offset);
-  graphics->push_triangle(v1, v4, v3, z_offset);
+  layer.push_triangle(v1, v2, v3);
+  layer.push_triangle(v1, v4, v3);
+}
+
+void block_graphics_add_line(block_graphics *graphics, b2Vec2 start, b2Vec2 end,
+                             double radius, color col, int z_offset) {
+  graphics->ensure_layer(z_offset);
+  block_graphics_layer_add_line(graphics->layers[z_offset], start, end, radius,
+                                col);
 }
 
 static void block_graphics_add_circ_single(struct block_graphics *graphics,
                                            struct shell shell, color col,
                                            int z_offset) {
-  const int circle_segments = 24;
-  uint32_t v_last;
+  const int circle_segments = graphics->circle_segments(shell.circ.radius);
+  uint32_t v_last = 0;
 
   float a;
   int i;
@@ -449,8 +533,8 @@ void block_graphics_add_joint(block_graphics *graphics, joint joint,
   const int z_offset = 4;
   color col = alpha_over(get_color_by_type(FCSIM_JOINT, 1), overlay);
 
-  const int circle_segments = 24;
-  uint32_t v_last;
+  const int circle_segments = graphics->circle_segments(JOINT_OUTER_RADIUS);
+  uint32_t v_last = 0;
 
   float a;
   int i;
@@ -476,8 +560,23 @@ void block_graphics_add_joint(block_graphics *graphics, joint joint,
 }
 
 static void block_graphics_add_block(struct block_graphics *graphics,
-                                     struct block *block) {
-  struct shell shell = get_shell(block);
+                                     struct block *block,
+                                     const block_pose_t *pose) {
+  struct shell shell = get_shell(block, pose);
+
+  // bounding circle of everything drawn below: outlines grow rects by up to
+  // 10 units, hollow rods are drawn at double height, and joint rings stick
+  // out past the shell
+  float bound;
+  if (shell.type == SHELL_CIRC) {
+    bound = std::abs(shell.circ.radius);
+  } else {
+    float w = std::abs(shell.rect.w) + 10;
+    float h = 2 * std::abs(shell.rect.h) + 10;
+    bound = sqrt(w * w + h * h) / 2;
+  }
+  if (!graphics->is_visible(shell.x, shell.y, bound + JOINT_OUTER_RADIUS))
+    return;
 
   color overlay;
 
@@ -494,7 +593,7 @@ static void block_graphics_add_block(struct block_graphics *graphics,
   else
     block_graphics_add_rect(graphics, shell, block->type_id, 2, overlay);
 
-  std::vector<joint> joints_generated = generate_joints(block);
+  std::vector<joint> joints_generated = generate_joints(block, pose);
   for (auto it = joints_generated.begin(); it != joints_generated.end(); ++it) {
     block_graphics_add_joint(graphics, *it, color{0, 0, 0, 0});
   }
@@ -518,11 +617,25 @@ void block_graphics_push_and_bind(block_graphics *graphics) {
                &(graphics->_colors[0]), GL_STATIC_DRAW);
 }
 
-void block_graphics_reset(arena *arena, struct design *design) {
+// Poses for the blocks of design in snapshot order, or NULL if the snapshot
+// was taken of a different set of blocks.
+static const block_pose_t *snapshot_poses(const render_snapshot_t *snapshot,
+                                          struct design *design) {
+  size_t count = block_list_len(&design->level_blocks) +
+                 block_list_len(&design->design_blocks);
+  if (snapshot->poses.size() != count || count == 0)
+    return NULL;
+  return &snapshot->poses[0];
+}
+
+void block_graphics_reset(arena *arena, struct design *design,
+                          const render_snapshot_t *snapshot) {
   block_graphics *graphics = (block_graphics *)arena->block_graphics_v2;
+  const block_pose_t *pose = snapshot_poses(snapshot, design);
 
   // clear old data
   graphics->clear();
+  graphics->set_view(&arena->view);
 
   // fill all layers
   block_graphics_add_area(graphics, design->build_area, FCSIM_BUILD_AREA);
@@ -530,16 +643,13 @@ void block_graphics_reset(arena *arena, struct design *design) {
 
   struct block *block;
   for (block = design->level_blocks.head; block; block = block->next)
-    block_graphics_add_block(graphics, block);
+    block_graphics_add_block(graphics, block, pose ? pose++ : NULL);
 
   for (block = design->design_blocks.head; block; block = block->next)
-    block_graphics_add_block(graphics, block);
+    block_graphics_add_block(graphics, block, pose ? pose++ : NULL);
 }
 
-void block_graphics_draw(struct block_graphics *graphics, struct view *view,
-                         bool use_world_transform = true) {
-  block_graphics_push_and_bind(graphics);
-
+static void block_program_use(struct view *view, bool use_world_transform) {
   glUseProgram(block_program);
 
   if (use_world_transform) {
@@ -553,6 +663,13 @@ void block_graphics_draw(struct block_graphics *graphics, struct view *view,
                 2.0f / view->height);
     glUniform2f(block_program_shift_uniform, -1, -1);
   }
+}
+
+void block_graphics_draw(struct block_graphics *graphics, struct view *view,
+                         bool use_world_transform = true) {
+  block_graphics_push_and_bind(graphics);
+
+  block_program_use(view, use_world_transform);
 
   glEnableVertexAttribArray(0);
   glEnableVertexAttribArray(1);
@@ -671,6 +788,7 @@ void on_button_clicked(arena *arena, ui_button_single &button) {
 
 void regenerate_ui_buttons(arena *arena) {
   ui_button_collection *all_buttons = (ui_button_collection *)arena->ui_buttons;
+  const render_snapshot_t *snapshot = render_snapshot_current(arena);
   all_buttons->buttons.clear();
 
   float vw = arena->view.width;
@@ -680,18 +798,18 @@ void regenerate_ui_buttons(arena *arena) {
     ui_button_single button{{0, 0}, 75, vh, 30, 30};
     button.enabled = !arena->ui_toolbar_opened;
     button.texts.push_back(ui_button_text{"v", 2});
-    all_buttons->buttons.push_back(button);
+    all_buttons->buttons.push_back(std::move(button));
   }
   {
     ui_button_single button{{1, 0}, 120 + 55 * 3, vh, 60 + 55 * 6 + 8, 128};
     button.enabled = arena->ui_toolbar_opened;
-    all_buttons->buttons.push_back(button);
+    all_buttons->buttons.push_back(std::move(button));
   }
   {
     ui_button_single button{{1, 1}, 75, vh, 30, 128, 2};
     button.enabled = arena->ui_toolbar_opened;
     button.texts.push_back(ui_button_text{"^", 2, 0, -30});
-    all_buttons->buttons.push_back(button);
+    all_buttons->buttons.push_back(std::move(button));
   }
   {
     ui_button_single button{{1, 2}, 120, vh - 30, 50, 50, 2};
@@ -699,7 +817,7 @@ void regenerate_ui_buttons(arena *arena) {
     button.texts.push_back(ui_button_text{"W", 2, 0, 5});
     button.texts.push_back(ui_button_text{"CW Wheel", 1, 0, -10});
     button.highlighted = arena->tool_hidden == TOOL_CW_WHEEL;
-    all_buttons->buttons.push_back(button);
+    all_buttons->buttons.push_back(std::move(button));
   }
   {
     ui_button_single button{{1, 3}, 120 + 55, vh - 30, 50, 50, 2};
@@ -707,7 +825,7 @@ void regenerate_ui_buttons(arena *arena) {
     button.texts.push_back(ui_button_text{"C", 2, 0, 5});
     button.texts.push_back(ui_button_text{"CCW Wheel", 1, 0, -10});
     button.highlighted = arena->tool_hidden == TOOL_CCW_WHEEL;
-    all_buttons->buttons.push_back(button);
+    all_buttons->buttons.push_back(std::move(button));
   }
   {
     ui_button_single button{{1, 4}, 120 + 55 * 2, vh - 30, 50, 50, 2};
@@ -715,7 +833,7 @@ void regenerate_ui_buttons(arena *arena) {
     button.texts.push_back(ui_button_text{"U", 2, 0, 5});
     button.texts.push_back(ui_button_text{"Wheel", 1, 0, -10});
     button.highlighted = arena->tool_hidden == TOOL_WHEEL;
-    all_buttons->buttons.push_back(button);
+    all_buttons->buttons.push_back(std::move(button));
   }
   {
     ui_button_single button{{1, 5}, 120 + 55 * 3, vh - 30, 50, 50, 2};
@@ -723,7 +841,7 @@ void regenerate_ui_buttons(arena *arena) {
     button.texts.push_back(ui_button_text{"R", 2, 0, 5});
     button.texts.push_back(ui_button_text{"Water", 1, 0, -10});
     button.highlighted = arena->tool_hidden == TOOL_ROD;
-    all_buttons->buttons.push_back(button);
+    all_buttons->buttons.push_back(std::move(button));
   }
   {
     ui_button_single button{{1, 6}, 120 + 55 * 4, vh - 30, 50, 50, 2};
@@ -731,7 +849,7 @@ void regenerate_ui_buttons(arena *arena) {
     button.texts.push_back(ui_button_text{"S", 2, 0, 5});
     button.texts.push_back(ui_button_text{"Wood", 1, 0, -10});
     button.highlighted = arena->tool_hidden == TOOL_SOLID_ROD;
-    all_buttons->buttons.push_back(button);
+    all_buttons->buttons.push_back(std::move(button));
   }
   {
     ui_button_single button{{1, 7}, 120 + 55 * 5, vh - 30, 50, 50, 2};
@@ -739,7 +857,7 @@ void regenerate_ui_buttons(arena *arena) {
     button.texts.push_back(ui_button_text{"M", 2, 0, 5});
     button.texts.push_back(ui_button_text{"Move", 1, 0, -10});
     button.highlighted = arena->tool_hidden == TOOL_MOVE;
-    all_buttons->buttons.push_back(button);
+    all_buttons->buttons.push_back(std::move(button));
   }
   {
     ui_button_single button{{1, 8}, 120 + 55 * 6, vh - 30, 50, 50, 2};
@@ -747,7 +865,7 @@ void regenerate_ui_buttons(arena *arena) {
     button.texts.push_back(ui_button_text{"D", 2, 0, 5});
     button.texts.push_back(ui_button_text{"Delete", 1, 0, -10});
     button.highlighted = arena->tool_hidden == TOOL_DELETE;
-    all_buttons->buttons.push_back(button);
+    all_buttons->buttons.push_back(std::move(button));
   }
   {
     ui_button_single button{{2, 0}, 30, vh - 30, 50, 50, 2};
@@ -755,26 +873,26 @@ void regenerate_ui_buttons(arena *arena) {
     button.texts.push_back(
         ui_button_text{is_running(arena) ? "Stop" : "Start", 1, 0, -8});
     button.highlighted = is_running(arena);
-    all_buttons->buttons.push_back(button);
+    all_buttons->buttons.push_back(std::move(button));
   }
   {
     ui_button_single button{{2, 1}, 30, vh - 55 - 20 * 0.5f + 4, 50, 20};
     button.texts.push_back(ui_button_text{
-        arena->single_ticks_remaining == -1 ? "Pause" : "Resume", 1});
-    button.highlighted = arena->single_ticks_remaining != -1;
-    all_buttons->buttons.push_back(button);
+        snapshot->single_ticks_remaining == -1 ? "Pause" : "Resume", 1});
+    button.highlighted = snapshot->single_ticks_remaining != -1;
+    all_buttons->buttons.push_back(std::move(button));
   }
   {
     ui_button_single button{{2, 2}, 30, vh - 55 - 20 * 1.5f + 4, 50, 20};
-    button.texts.push_back(
-        ui_button_text{arena->autostop_on_solve ? "Cancel" : "On solve", 1});
-    button.highlighted = arena->autostop_on_solve;
-    all_buttons->buttons.push_back(button);
+    button.texts.push_back(ui_button_text{
+        snapshot->autostop_on_solve ? "Cancel" : "On solve", 1});
+    button.highlighted = snapshot->autostop_on_solve;
+    all_buttons->buttons.push_back(std::move(button));
   }
   {
     ui_button_single button{{2, 3}, 30, vh - 55 - 20 * 2.5f + 4, 50, 20};
     button.texts.push_back(ui_button_text{"Step", 1});
-    all_buttons->buttons.push_back(button);
+    all_buttons->buttons.push_back(std::move(button));
   }
 
   float top_bar_x_offset = -50 + (!arena->ui_toolbar_opened ? 90 : 484);
@@ -783,19 +901,19 @@ void regenerate_ui_buttons(arena *arena) {
     ui_button_single button{{3, 0}, top_bar_x_offset + 75, vh, 30, 30};
     button.enabled = !arena->ui_speedbar_opened;
     button.texts.push_back(ui_button_text{"v", 2});
-    all_buttons->buttons.push_back(button);
+    all_buttons->buttons.push_back(std::move(button));
   }
   {
     ui_button_single button{
         {4, 0}, top_bar_x_offset + 120 + 55 * 4.5f, vh, 60 + 55 * 9 + 8, 128};
     button.enabled = arena->ui_speedbar_opened;
-    all_buttons->buttons.push_back(button);
+    all_buttons->buttons.push_back(std::move(button));
   }
   {
     ui_button_single button{{4, 1}, top_bar_x_offset + 75, vh, 30, 128, 2};
     button.enabled = arena->ui_speedbar_opened;
     button.texts.push_back(ui_button_text{"^", 2, 0, -30});
-    all_buttons->buttons.push_back(button);
+    all_buttons->buttons.push_back(std::move(button));
   }
   {
     ui_button_single button{{4, 2}, top_bar_x_offset + 120, vh - 30, 50, 50, 2};
@@ -803,7 +921,7 @@ void regenerate_ui_buttons(arena *arena) {
     button.texts.push_back(ui_button_text{"1", 2, 0, 5});
     button.texts.push_back(ui_button_text{"1x", 1, 0, -10});
     button.highlighted = _fcsim_speed_preset == 1;
-    all_buttons->buttons.push_back(button);
+    all_buttons->buttons.push_back(std::move(button));
   }
   {
     ui_button_single button{
@@ -812,7 +930,7 @@ void regenerate_ui_buttons(arena *arena) {
     button.texts.push_back(ui_button_text{"2", 2, 0, 5});
     button.texts.push_back(ui_button_text{"2x", 1, 0, -10});
     button.highlighted = _fcsim_speed_preset == 2;
-    all_buttons->buttons.push_back(button);
+    all_buttons->buttons.push_back(std::move(button));
   }
   {
     ui_button_single button{
@@ -821,7 +939,7 @@ void regenerate_ui_buttons(arena *arena) {
     button.texts.push_back(ui_button_text{"3", 2, 0, 5});
     button.texts.push_back(ui_button_text{"4x", 1, 0, -10});
     button.highlighted = _fcsim_speed_preset == 3;
-    all_buttons->buttons.push_back(button);
+    all_buttons->buttons.push_back(std::move(button));
   }
   {
     ui_button_single button{
@@ -830,7 +948,7 @@ void regenerate_ui_buttons(arena *arena) {
     button.texts.push_back(ui_button_text{"4", 2, 0, 5});
     button.texts.push_back(ui_button_text{"10x", 1, 0, -10});
     button.highlighted = _fcsim_speed_preset == 4;
-    all_buttons->buttons.push_back(button);
+    all_buttons->buttons.push_back(std::move(button));
   }
   {
     ui_button_single button{
@@ -839,7 +957,7 @@ void regenerate_ui_buttons(arena *arena) {
     button.texts.push_back(ui_button_text{"5", 2, 0, 5});
     button.texts.push_back(ui_button_text{"100x", 1, 0, -10});
     button.highlighted = _fcsim_speed_preset == 5;
-    all_buttons->buttons.push_back(button);
+    all_buttons->buttons.push_back(std::move(button));
   }
   {
     ui_button_single button{
@@ -848,7 +966,7 @@ void regenerate_ui_buttons(arena *arena) {
     button.texts.push_back(ui_button_text{"6", 2, 0, 5});
     button.texts.push_back(ui_button_text{"1000x", 1, 0, -10});
     button.highlighted = _fcsim_speed_preset == 6;
-    all_buttons->buttons.push_back(button);
+    all_buttons->buttons.push_back(std::move(button));
   }
   {
     ui_button_single button{
@@ -857,7 +975,7 @@ void regenerate_ui_buttons(arena *arena) {
     button.texts.push_back(ui_button_text{"7", 2, 0, 5});
     button.texts.push_back(ui_button_text{"10000x", 1, 0, -10});
     button.highlighted = _fcsim_speed_preset == 7;
-    all_buttons->buttons.push_back(button);
+    all_buttons->buttons.push_back(std::move(button));
   }
   {
     ui_button_single button{
@@ -866,7 +984,7 @@ void regenerate_ui_buttons(arena *arena) {
     button.texts.push_back(ui_button_text{"8", 2, 0, 5});
     button.texts.push_back(ui_button_text{"100000x", 1, 0, -10});
     button.highlighted = _fcsim_speed_preset == 8;
-    all_buttons->buttons.push_back(button);
+    all_buttons->buttons.push_back(std::move(button));
   }
   {
     ui_button_single button{
@@ -875,7 +993,7 @@ void regenerate_ui_buttons(arena *arena) {
     button.texts.push_back(ui_button_text{"9", 2, 0, 5});
     button.texts.push_back(ui_button_text{"MAX", 1, 0, -10});
     button.highlighted = _fcsim_speed_preset == 9;
-    all_buttons->buttons.push_back(button);
+    all_buttons->buttons.push_back(std::move(button));
   }
   {
     ui_button_single button{
@@ -884,27 +1002,27 @@ void regenerate_ui_buttons(arena *arena) {
     button.texts.push_back(ui_button_text{"0", 2, 0, 10});
     button.texts.push_back(ui_button_text{"Change", 1, 0, -5});
     button.texts.push_back(ui_button_text{"base TPS", 1, 0, -15});
-    all_buttons->buttons.push_back(button);
+    all_buttons->buttons.push_back(std::move(button));
   }
   {
     ui_button_single button{{5, 0}, vw - 30, vh - 30, 70, 50, 2};
     button.texts.push_back(ui_button_text{"Preview", 1, 0, 10});
     button.texts.push_back(ui_button_text{
         arena->preview_goal_piece_trajectory ? "ON" : "OFF", 1, 0, -10});
-    all_buttons->buttons.push_back(button);
+    all_buttons->buttons.push_back(std::move(button));
   }
   {
     ui_button_single button{{9, 0}, vw - 30, vh - 55 - 30 * 0.5f, 70, 30, 2};
     button.texts.push_back(ui_button_text{"Lock", 1, 0, 5});
     button.texts.push_back(ui_button_text{"if solve", 1, 0, -5});
     button.highlighted = arena->lock_if_preview_solves;
-    all_buttons->buttons.push_back(button);
+    all_buttons->buttons.push_back(std::move(button));
   }
   {
     ui_button_single button{{10, 0}, vw - 30, vh - 55 - 30 * 1.5f, 70, 30, 2};
     button.texts.push_back(ui_button_text{"Change", 1, 0, 5});
     button.texts.push_back(ui_button_text{"Color", 1, 0, -5});
-    all_buttons->buttons.push_back(button);
+    all_buttons->buttons.push_back(std::move(button));
   }
 }
 
@@ -919,22 +1037,23 @@ float draw_text_default(arena *arena, std::string text, float x, float y,
 }
 
 void draw_tick_counter(struct arena *arena) {
+  const render_snapshot_t *snapshot = render_snapshot_current(arena);
   const bool is_running_arena = is_running(arena);
   const bool is_running_arena_and_not_paused =
-      is_running_arena && arena->single_ticks_remaining == -1;
+      is_running_arena && snapshot->single_ticks_remaining == -1;
   block_graphics *graphics = (block_graphics *)arena->block_graphics_v2b;
   float x = 10;
-  x = draw_text_default(arena, std::to_string(arena->tick), x, 10);
+  x = draw_text_default(arena, std::to_string(snapshot->tick), x, 10);
   x = draw_text_default(arena, "ticks", x, 10, 1);
-  if (arena->has_won) {
+  if (snapshot->has_won) {
     x = std::max(x, 10 + FONT_X_INCREMENT * FONT_SCALE_DEFAULT * 8);
     x += FONT_X_INCREMENT * FONT_SCALE_DEFAULT * 1;
-    x = draw_text_default(arena, std::to_string(arena->tick_solve), x, 10);
+    x = draw_text_default(arena, std::to_string(snapshot->tick_solve), x, 10);
     x = draw_text_default(arena, "at solve", x, 10, 1);
   }
   // fps/tps counter
   graphics->fps_tracker.push_record(arena->frame_counter++);
-  graphics->tps_tracker.push_record(arena->tick);
+  graphics->tps_tracker.push_record(snapshot->tick);
   double fps_value = graphics->fps_tracker.get_tps();
   // try to average over 2 seconds
   size_t tps_interval =
@@ -1047,9 +1166,13 @@ void draw_tick_counter(struct arena *arena) {
   float yp = y;
   double sum_x = 0;
   double sum_y = 0;
-  for (block *b = arena->design.design_blocks.head; b; b = b->next) {
+  const block_pose_t *pose = snapshot_poses(snapshot, &arena->design);
+  if (pose)
+    pose += block_list_len(&arena->design.level_blocks);
+  for (block *b = arena->design.design_blocks.head; b;
+       b = b->next, pose = pose ? pose + 1 : NULL) {
     if (b->goal) {
-      const b2Vec2 position = b->body->m_position;
+      const b2Vec2 position = pose ? pose->position : b->body->m_position;
       // add to the sum
       sum_x += position.x;
       sum_y += position.y;
@@ -1104,27 +1227,182 @@ void draw_ui(arena *arena) {
   }
 }
 
-void preview_trail_draw(arena *arena) {
-  const double LINE_RADIUS = 2;
+#define TRAIL_LINE_RADIUS 2
+#define TRAIL_MAX_PENDING 64
 
-  block_graphics *graphics = (block_graphics *)arena->block_graphics_v2;
+static float trail_distance(b2Vec2 a, b2Vec2 b) {
+  float dx = a.x - b.x;
+  float dy = a.y - b.y;
+  return sqrt(dx * dx + dy * dy);
+}
+
+static float trail_segment_distance(b2Vec2 point, b2Vec2 start, b2Vec2 end) {
+  float dx = end.x - start.x;
+  float dy = end.y - start.y;
+  float len2 = dx * dx + dy * dy;
+  if (len2 == 0)
+    return trail_distance(point, start);
+  float t = ((point.x - start.x) * dx + (point.y - start.y) * dy) / len2;
+  t = std::min(std::max(t, 0.0f), 1.0f);
+  b2Vec2 closest;
+  closest.x = start.x + t * dx;
+  closest.y = start.y + t * dy;
+  return trail_distance(point, closest);
+}
+
+void trail_graphics::clear() {
+  runs.clear();
+  mesh.indices.clear();
+  mesh.coords.clear();
+  mesh.colors.clear();
+  _uploaded_vertices = 0;
+  _uploaded_indices = 0;
+}
+
+void trail_graphics::add_point(trail_graphics_run &run, b2Vec2 point) {
+  if (run.consumed == 0) {
+    run.anchor = point;
+    return;
+  }
+  // extend the current run while one segment from the anchor to this point
+  // stays within tolerance of every point it replaces
+  size_t n = run.pending.size();
+  bool fits = n < TRAIL_MAX_PENDING;
+  for (size_t i = 0; fits && i < n; i++)
+    fits = trail_segment_distance(run.pending[i], run.anchor, point) <=
+           tolerance;
+  if (!fits) {
+    b2Vec2 last = run.pending[n - 1];
+    block_graphics_layer_add_line(mesh, run.anchor, last, TRAIL_LINE_RADIUS,
+                                  col);
+    run.anchor = last;
+    run.pending.clear();
+  }
+  // points this close to the anchor are covered by any segment from it
+  if (trail_distance(point, run.anchor) > tolerance)
+    run.pending.push_back(point);
+}
+
+void trail_graphics::upload() {
+  size_t vertices = mesh.coords.size() / 2;
+  size_t indices = mesh.indices.size();
+  if (vertices > _vertex_capacity || indices > _index_capacity) {
+    // grow geometrically, then upload everything again
+    _vertex_capacity =
+        std::max(std::max(vertices, 2 * _vertex_capacity), (size_t)1024);
+    _index_capacity =
+        std::max(std::max(indices, 2 * _index_capacity), (size_t)1536);
+    glBindBuffer(GL_ARRAY_BUFFER, _coord_buffer);
+    glBufferData(GL_ARRAY_BUFFER, _vertex_capacity * 2 * sizeof(float), NULL,
+                 GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, _color_buffer);
+    glBufferData(GL_ARRAY_BUFFER, _vertex_capacity * 3 * sizeof(float), NULL,
+                 GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _index_buffer);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, _index_capacity * sizeof(uint32_t),
+                 NULL, GL_DYNAMIC_DRAW);
+    _uploaded_vertices = 0;
+    _uploaded_indices = 0;
+  }
+  if (vertices > _uploaded_vertices) {
+    size_t first = _uploaded_vertices;
+    size_t count = vertices - first;
+    glBindBuffer(GL_ARRAY_BUFFER, _coord_buffer);
+    glBufferSubData(GL_ARRAY_BUFFER, first * 2 * sizeof(float),
+                    count * 2 * sizeof(float), &mesh.coords[first * 2]);
+    glBindBuffer(GL_ARRAY_BUFFER, _color_buffer);
+    glBufferSubData(GL_ARRAY_BUFFER, first * 3 * sizeof(float),
+                    count * 3 * sizeof(float), &mesh.colors[first * 3]);
+  }
+  if (indices > _uploaded_indices) {
+    size_t first = _uploaded_indices;
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _index_buffer);
+    glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, first * sizeof(uint32_t),
+                    (indices - first) * sizeof(uint32_t), &mesh.indices[first]);
+  }
+  _uploaded_vertices = vertices;
+  _uploaded_indices = indices;
+}
+
+void trail_graphics::draw(struct view *view) {
+  // the unfinished tail of each run is appended past the committed segments
+  // for this frame only, and overwritten by the next upload
+  size_t committed_vertices = mesh.coords.size() / 2;
+  size_t committed_indices = mesh.indices.size();
+  for (auto it = runs.begin(); it != runs.end(); ++it) {
+    size_t n = it->pending.size();
+    if (n > 0) {
+      block_graphics_layer_add_line(mesh, it->anchor, it->pending[n - 1],
+                                    TRAIL_LINE_RADIUS, col);
+    }
+  }
+  size_t indices = mesh.indices.size();
+  if (indices > 0) {
+    upload();
 
+    block_program_use(view, true);
+
+    glEnableVertexAttribArray(0);
+    glEnableVertexAttribArray(1);
+
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _index_buffer);
+
+    glBindBuffer(GL_ARRAY_BUFFER, _coord_buffer);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 0, 0);
+
+    glBindBuffer(GL_ARRAY_BUFFER, _color_buffer);
+    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 0, 0);
+
+    glDrawElements(GL_TRIANGLES, indices, GL_UNSIGNED_INT, 0);
+
+    glDisableVertexAttribArray(0);
+    glDisableVertexAttribArray(1);
+  }
+  mesh.coords.resize(committed_vertices * 2);
+  mesh.colors.resize(committed_vertices * 3);
+  mesh.indices.resize(committed_indices);
+  _uploaded_vertices = std::min(_uploaded_vertices, committed_vertices);
+  _uploaded_indices = std::min(_uploaded_indices, committed_indices);
+}
+
+void preview_trail_draw(arena *arena) {
+  trail_graphics *graphics = (trail_graphics *)arena->trail_graphics;
   multi_trail_t *all_trails = (multi_trail_t *)arena->preview_trail;
+
+  // simplify to within half a pixel; the cache is rebuilt when the zoom
+  // changes enough that it would be visibly too coarse or wastefully fine
+  float tolerance = arena->view.scale;
+  color col = get_color_by_type(FCSIM_GOAL_CIRCLE, 0);
+  bool stale = graphics->generation != all_trails->generation ||
+               tolerance < graphics->tolerance / 2 ||
+               tolerance > graphics->tolerance * 2 ||
+               col.r != graphics->col.r || col.g != graphics->col.g ||
+               col.b != graphics->col.b ||
+               all_trails->trails.size() < graphics->runs.size();
+  for (size_t i = 0; !stale && i < graphics->runs.size(); ++i) {
+    stale =
+        all_trails->trails[i].datapoints.size() < graphics->runs[i].consumed;
+  }
+  if (stale) {
+    graphics->clear();
+    graphics->generation = all_trails->generation;
+    graphics->tolerance = tolerance;
+    graphics->col = col;
+  }
+
+  while (graphics->runs.size() < all_trails->trails.size()) {
+    graphics->runs.emplace_back();
+  }
   for (size_t trail_index = 0; trail_index < all_trails->trails.size();
        ++trail_index) {
     trail_t &the_trail = all_trails->trails[trail_index];
-    if (the_trail.datapoints.size() < 2) {
-      continue;
-    }
-    b2Vec2 last = the_trail.datapoints[0];
-    for (size_t datapoint_index = 1;
-         datapoint_index < the_trail.datapoints.size(); ++datapoint_index) {
-      b2Vec2 current = the_trail.datapoints[datapoint_index];
-      block_graphics_add_line(graphics, last, current, LINE_RADIUS,
-                              get_color_by_type(FCSIM_GOAL_CIRCLE, 0), 4);
-      last = current;
+    trail_graphics_run &run = graphics->runs[trail_index];
+    for (; run.consumed < the_trail.datapoints.size(); ++run.consumed) {
+      graphics->add_point(run, the_trail.datapoints[run.consumed]);
     }
   }
+
+  graphics->draw(&arena->view);
 }
 
 void arena_draw(struct arena *arena) {
@@ -1132,11 +1410,13 @@ void arena_draw(struct arena *arena) {
   glClearColor(sky_color.r, sky_color.g, sky_color.b, sky_color.a);
   glClear(GL_COLOR_BUFFER_BIT);
 
-  block_graphics_reset(arena, &arena->design);
+  const render_snapshot_t *snapshot = render_snapshot_acquire(arena);
+  block_graphics_reset(arena, &arena->design, snapshot);
+  block_graphics_draw((block_graphics *)arena->block_graphics_v2, &arena->view);
+  preview_update(arena);
   if (arena->preview_goal_piece_trajectory && arena->preview_trail) {
     preview_trail_draw(arena);
   }
-  block_graphics_draw((block_graphics *)arena->block_graphics_v2, &arena->view);
 
   regenerate_ui_buttons(arena);
   draw_ui(arena);
@@ -1154,11 +1434,19 @@ void block_graphics_init_single(void *&_graphics) {
 extern "C" void block_graphics_init(struct arena *ar) {
   block_graphics_init_single(ar->block_graphics_v2);
   block_graphics_init_single(ar->block_graphics_v2b);
+  trail_graphics *trails = _new<trail_graphics>();
+  glGenBuffers(1, &trails->_index_buffer);
+  glGenBuffers(1, &trails->_coord_buffer);
+  glGenBuffers(1, &trails->_color_buffer);
+  ar->trail_graphics = trails;
+  ar->render_snapshots = _new<render_snapshot_buffer_t>();
   ar->ui_buttons = _new<ui_button_collection>();
-  regenerate_ui_buttons(ar);
   ar->ui_toolbar_opened = false;
   ar->single_ticks_remaining = -1;
   ar->autostop_on_solve = false;
+  render_snapshot_publish(ar);
+  render_snapshot_acquire(ar);
+  regenerate_ui_buttons(ar);
   if (is_dark_mode()) {
     // default palette for dark mode
     piece_color_palette_offset = 2;
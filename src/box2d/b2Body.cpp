@@ -42,8 +42,8 @@ void b2Body_ctor(b2Body *body, const b2BodyDef *bd, b2World *world) {
   body->m_position = bd->position;
   body->m_rotation = bd->rotation;
   b2Mat22_SetAngle(&body->m_R, body->m_rotation);
-  body->m_position0 = body->m_position;
-  body->m_rotation0 = body->m_rotation;
+  body->m_RAngle = body->m_rotation;
+  b2Body_SaveTransform(body);
   body->m_world = world;
 
   body->m_linearDamping = b2Clamp(1.0 - bd->linearDamping, 0.0, 1.0);
@@ -151,13 +151,26 @@ b2Vec2 b2Body_GetOriginPosition(const b2Body *body) {
 }
 
 void b2Body_SynchronizeShapes(b2Body *body) {
-  b2Mat22 R0;
-  b2Mat22_SetAngle(&R0, body->m_rotation0);
   for (b2Shape *s = body->m_shapeList; s; s = s->m_next) {
-    s->Synchronize(s, body->m_position0, &R0, body->m_position, &body->m_R);
+    s->Synchronize(s, body->m_position0, &body->m_R0, body->m_position,
+                   &body->m_R);
   }
 }
 
+void b2Body_SynchronizeRotation(b2Body *body) {
+  // Compare bits, not values: -0.0 == 0.0 but their sines differ.
+  if (memcmp(&body->m_rotation, &body->m_RAngle, sizeof(float64)) == 0)
+    return;
+  b2Mat22_SetAngle(&body->m_R, body->m_rotation);
+  body->m_RAngle = body->m_rotation;
+}
+
+void b2Body_SaveTransform(b2Body *body) {
+  body->m_position0 = body->m_position;
+  body->m_rotation0 = body->m_rotation;
+  body->m_R0 = body->m_R;
+}
+
 void b2Body_Freeze(b2Body *body) {
   body->m_flags |= b2Body_e_frozenFlag;
   b2Vec2_SetZero(&body->m_linearVelocity);
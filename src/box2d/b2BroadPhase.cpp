@@ -507,6 +507,67 @@ void b2BroadPhase_MoveProxy(b2BroadPhase *broad_phase, int32 proxyId,
   }
 }
 
+// After a commit the pairs are exactly the proxies whose bounds overlap, so
+// the pairs of a proxy can be read back from the bound arrays: anything that
+// starts inside it on the x axis, plus the stabbing count's worth of proxies
+// that started before it and are still open, filtered on the y axis.
+static void b2BroadPhase_ReportPair(b2BroadPhase *broad_phase, b2Proxy *proxy,
+                                    int32 proxyId, int32 otherId,
+                                    void (*callback)(void *pairUserData,
+                                                     void *context),
+                                    void *context) {
+  b2Proxy *other = broad_phase->m_proxyPool + otherId;
+
+  if (other->lowerBounds[1] > proxy->upperBounds[1] ||
+      other->upperBounds[1] < proxy->lowerBounds[1]) {
+    return;
+  }
+
+  b2Pair *pair =
+      b2PairManager_Find(&broad_phase->m_pairManager, proxyId, otherId);
+  if (pair != NULL) {
+    callback(pair->userData, context);
+  }
+}
+
+void b2BroadPhase_QueryPairs(b2BroadPhase *broad_phase, int32 proxyId,
+                             void (*callback)(void *pairUserData,
+                                              void *context),
+                             void *context) {
+  if (proxyId == b2_nullProxy) {
+    return;
+  }
+
+  b2Proxy *proxy = broad_phase->m_proxyPool + proxyId;
+  b2Bound *bounds = broad_phase->m_bounds[0];
+  int32 lowerIndex = proxy->lowerBounds[0];
+  int32 upperIndex = proxy->upperBounds[0];
+
+  for (int32 i = lowerIndex + 1; i < upperIndex; ++i) {
+    if (b2Bound_IsLower(&bounds[i])) {
+      b2BroadPhase_ReportPair(broad_phase, proxy, proxyId, bounds[i].proxyId,
+                              callback, context);
+    }
+  }
+
+  if (lowerIndex > 0) {
+    int32 i = lowerIndex - 1;
+    int32 s = bounds[i].stabbingCount;
+
+    while (s) {
+      if (b2Bound_IsLower(&bounds[i])) {
+        b2Proxy *other = broad_phase->m_proxyPool + bounds[i].proxyId;
+        if (lowerIndex < other->upperBounds[0]) {
+          b2BroadPhase_ReportPair(broad_phase, proxy, proxyId,
+                                  bounds[i].proxyId, callback, context);
+          --s;
+        }
+      }
+      --i;
+    }
+  }
+}
+
 void b2BroadPhase_Commit(b2BroadPhase *broad_phase) {
   b2PairManager_Commit(&broad_phase->m_pairManager);
 }
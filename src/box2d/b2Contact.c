@@ -27,43 +27,29 @@
 #include <box2d/b2Shape.h>
 #include <box2d/b2World.h>
 
-static b2ContactRegister s_registers[e_shapeTypeCount][e_shapeTypeCount];
-static bool s_initialized = false;
-
-static void AddType(b2ContactCreateFcn *createFcn,
-                    b2ContactDestroyFcn *destoryFcn, b2ShapeType type1,
-                    b2ShapeType type2);
-
-static void InitializeRegisters() {
-  AddType(b2CircleContact_Create, b2CircleContact_Destroy, e_circleShape,
-          e_circleShape);
-  AddType(b2PolyAndCircleContact_Create, b2PolyAndCircleContact_Destroy,
-          e_polyShape, e_circleShape);
-  AddType(b2PolyContact_Create, b2PolyContact_Destroy, e_polyShape,
-          e_polyShape);
-}
-
-static void AddType(b2ContactCreateFcn *createFcn,
-                    b2ContactDestroyFcn *destoryFcn, b2ShapeType type1,
-                    b2ShapeType type2) {
-  s_registers[type1][type2].createFcn = createFcn;
-  s_registers[type1][type2].destroyFcn = destoryFcn;
-  s_registers[type1][type2].primary = true;
-
-  if (type1 != type2) {
-    s_registers[type2][type1].createFcn = createFcn;
-    s_registers[type2][type1].destroyFcn = destoryFcn;
-    s_registers[type2][type1].primary = false;
-  }
-}
+/* Filled in at compile time rather than on the first contact, so worlds
+ * created on different threads never race to initialise it. A pair whose
+ * register is not primary is created with its shapes swapped. */
+static const b2ContactRegister
+    s_registers[e_shapeTypeCount][e_shapeTypeCount] = {
+        [e_circleShape] =
+            {
+                [e_circleShape] = {b2CircleContact_Create,
+                                   b2CircleContact_Destroy, true},
+                [e_polyShape] = {b2PolyAndCircleContact_Create,
+                                 b2PolyAndCircleContact_Destroy, false},
+            },
+        [e_polyShape] =
+            {
+                [e_circleShape] = {b2PolyAndCircleContact_Create,
+                                   b2PolyAndCircleContact_Destroy, true},
+                [e_polyShape] = {b2PolyContact_Create, b2PolyContact_Destroy,
+                                 true},
+            },
+};
 
 b2Contact *b2Contact_Create(b2Shape *shape1, b2Shape *shape2,
                             b2BlockAllocator *allocator) {
-  if (s_initialized == false) {
-    InitializeRegisters();
-    s_initialized = true;
-  }
-
   b2ShapeType type1 = shape1->m_type;
   b2ShapeType type2 = shape2->m_type;
 
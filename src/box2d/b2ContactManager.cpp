@@ -17,6 +17,7 @@
  */
 
 #include <box2d/b2Body.h>
+#include <box2d/b2BroadPhase.h>
 #include <box2d/b2ContactManager.h>
 #include <box2d/b2Math.h>
 #include <box2d/b2World.h>
@@ -178,83 +179,149 @@ void b2ContactManager_CleanContactList(b2ContactManager *manager) {
   }
 }
 
+// Runs the narrow phase for one contact and keeps the island graph in step
+// with its manifold count.
+void b2ContactManager_CollideContact(b2ContactManager *manager, b2Contact *c) {
+  if (b2Body_IsSleeping(c->m_shape1->m_body) &&
+      b2Body_IsSleeping(c->m_shape2->m_body)) {
+    return;
+  }
+
+  int32 oldCount = c->m_manifoldCount;
+  c->Evaluate(c);
+
+  int32 newCount = c->m_manifoldCount;
+
+  if (oldCount == 0 && newCount > 0) {
+    // Connect to island graph.
+    b2Body *body1 = c->m_shape1->m_body;
+    b2Body *body2 = c->m_shape2->m_body;
+
+    // Connect to body 1
+    c->m_node1.contact = c;
+    c->m_node1.other = body2;
+
+    c->m_node1.prev = NULL;
+    c->m_node1.next = body1->m_contactList;
+    if (c->m_node1.next != NULL) {
+      c->m_node1.next->prev = &c->m_node1;
+    }
+    body1->m_contactList = &c->m_node1;
+
+    // Connect to body 2
+    c->m_node2.contact = c;
+    c->m_node2.other = body1;
+
+    c->m_node2.prev = NULL;
+    c->m_node2.next = body2->m_contactList;
+    if (c->m_node2.next != NULL) {
+      c->m_node2.next->prev = &c->m_node2;
+    }
+    body2->m_contactList = &c->m_node2;
+  } else if (oldCount > 0 && newCount == 0) {
+    // Disconnect from island graph.
+    b2Body *body1 = c->m_shape1->m_body;
+    b2Body *body2 = c->m_shape2->m_body;
+
+    // Remove from body 1
+    if (c->m_node1.prev) {
+      c->m_node1.prev->next = c->m_node1.next;
+    }
+
+    if (c->m_node1.next) {
+      c->m_node1.next->prev = c->m_node1.prev;
+    }
+
+    if (&c->m_node1 == body1->m_contactList) {
+      body1->m_contactList = c->m_node1.next;
+    }
+
+    c->m_node1.prev = NULL;
+    c->m_node1.next = NULL;
+
+    // Remove from body 2
+    if (c->m_node2.prev) {
+      c->m_node2.prev->next = c->m_node2.next;
+    }
+
+    if (c->m_node2.next) {
+      c->m_node2.next->prev = c->m_node2.prev;
+    }
+
+    if (&c->m_node2 == body2->m_contactList) {
+      body2->m_contactList = c->m_node2.next;
+    }
+
+    c->m_node2.prev = NULL;
+    c->m_node2.next = NULL;
+  }
+}
+
 // This is the top level collision call for the time step. Here
 // all the narrow phase collision is processed for the world
 // contact list.
 void b2ContactManager_Collide(b2ContactManager *manager) {
   for (b2Contact *c = manager->m_world->m_contactList; c; c = c->m_next) {
-    if (b2Body_IsSleeping(c->m_shape1->m_body) &&
-        b2Body_IsSleeping(c->m_shape2->m_body)) {
-      continue;
-    }
+    b2ContactManager_CollideContact(manager, c);
+  }
+}
 
-    int32 oldCount = c->m_manifoldCount;
-    c->Evaluate(c);
-
-    int32 newCount = c->m_manifoldCount;
-
-    if (oldCount == 0 && newCount > 0) {
-      // Connect to island graph.
-      b2Body *body1 = c->m_shape1->m_body;
-      b2Body *body2 = c->m_shape2->m_body;
-
-      // Connect to body 1
-      c->m_node1.contact = c;
-      c->m_node1.other = body2;
-
-      c->m_node1.prev = NULL;
-      c->m_node1.next = body1->m_contactList;
-      if (c->m_node1.next != NULL) {
-        c->m_node1.next->prev = &c->m_node1;
-      }
-      body1->m_contactList = &c->m_node1;
-
-      // Connect to body 2
-      c->m_node2.contact = c;
-      c->m_node2.other = body1;
-
-      c->m_node2.prev = NULL;
-      c->m_node2.next = body2->m_contactList;
-      if (c->m_node2.next != NULL) {
-        c->m_node2.next->prev = &c->m_node2;
-      }
-      body2->m_contactList = &c->m_node2;
-    } else if (oldCount > 0 && newCount == 0) {
-      // Disconnect from island graph.
-      b2Body *body1 = c->m_shape1->m_body;
-      b2Body *body2 = c->m_shape2->m_body;
-
-      // Remove from body 1
-      if (c->m_node1.prev) {
-        c->m_node1.prev->next = c->m_node1.next;
-      }
-
-      if (c->m_node1.next) {
-        c->m_node1.next->prev = c->m_node1.prev;
-      }
-
-      if (&c->m_node1 == body1->m_contactList) {
-        body1->m_contactList = c->m_node1.next;
-      }
-
-      c->m_node1.prev = NULL;
-      c->m_node1.next = NULL;
-
-      // Remove from body 2
-      if (c->m_node2.prev) {
-        c->m_node2.prev->next = c->m_node2.next;
-      }
-
-      if (c->m_node2.next) {
-        c->m_node2.next->prev = c->m_node2.prev;
-      }
-
-      if (&c->m_node2 == body2->m_contactList) {
-        body2->m_contactList = c->m_node2.next;
-      }
-
-      c->m_node2.prev = NULL;
-      c->m_node2.next = NULL;
-    }
+struct b2CollideShapeContext {
+  b2ContactManager *manager;
+  int32 touching;
+};
+
+static void b2ContactManager_CollidePair(void *pairUserData, void *context) {
+  b2CollideShapeContext *ctx = (b2CollideShapeContext *)context;
+  b2Contact *c = (b2Contact *)pairUserData;
+
+  if (c == NULL || c == &ctx->manager->m_nullContact.contact) {
+    return;
+  }
+
+  b2ContactManager_CollideContact(ctx->manager, c);
+  if (c->m_manifoldCount > 0) {
+    ++ctx->touching;
+  }
+}
+
+// Collide, restricted to the contacts of one shape. Returns how many of them
+// are touching.
+int32 b2ContactManager_CollideShape(b2ContactManager *manager,
+                                    b2Shape *shape) {
+  b2CollideShapeContext ctx;
+  ctx.manager = manager;
+  ctx.touching = 0;
+  b2BroadPhase_QueryPairs(manager->m_world->m_broadPhase, shape->m_proxyId,
+                          b2ContactManager_CollidePair, &ctx);
+  return ctx.touching;
+}
+
+struct b2QueryShapeContext {
+  b2ContactManager *manager;
+  void (*callback)(b2Contact *c, void *context);
+  void *context;
+};
+
+static void b2ContactManager_QueryPair(void *pairUserData, void *context) {
+  b2QueryShapeContext *ctx = (b2QueryShapeContext *)context;
+  b2Contact *c = (b2Contact *)pairUserData;
+
+  if (c == NULL || c == &ctx->manager->m_nullContact.contact) {
+    return;
   }
+
+  ctx->callback(c, ctx->context);
+}
+
+// Calls callback for every contact of one shape, touching or not.
+void b2ContactManager_QueryShape(b2ContactManager *manager, b2Shape *shape,
+                                 void (*callback)(b2Contact *c, void *context),
+                                 void *context) {
+  b2QueryShapeContext ctx;
+  ctx.manager = manager;
+  ctx.callback = callback;
+  ctx.context = context;
+  b2BroadPhase_QueryPairs(manager->m_world->m_broadPhase, shape->m_proxyId,
+                          b2ContactManager_QueryPair, &ctx);
 }
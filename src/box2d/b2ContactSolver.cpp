@@ -286,11 +286,11 @@ bool b2ContactSolver_SolvePositionConstraints(b2ContactSolver *solver,
 
       b1->m_position -= invMass1 * impulse;
       b1->m_rotation -= invI1 * b2Cross(r1, impulse);
-      b2Mat22_SetAngle(&b1->m_R, b1->m_rotation);
+      b2Body_SynchronizeRotation(b1);
 
       b2->m_position += invMass2 * impulse;
       b2->m_rotation += invI2 * b2Cross(r2, impulse);
-      b2Mat22_SetAngle(&b2->m_R, b2->m_rotation);
+      b2Body_SynchronizeRotation(b2);
     }
   }
 
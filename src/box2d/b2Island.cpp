@@ -155,8 +155,7 @@ void b2Island_Solve(b2Island *island, const b2TimeStep *step,
     b->m_angularVelocity *= b->m_angularDamping;
 
     // Store positions for conservative advancement.
-    b->m_position0 = b->m_position;
-    b->m_rotation0 = b->m_rotation;
+    b2Body_SaveTransform(b);
   }
 
   b2ContactSolver contactSolver;
@@ -189,7 +188,7 @@ void b2Island_Solve(b2Island *island, const b2TimeStep *step,
     b->m_position += step->dt * b->m_linearVelocity;
     b->m_rotation += step->dt * b->m_angularVelocity;
 
-    b2Mat22_SetAngle(&b->m_R, b->m_rotation);
+    b2Body_SynchronizeRotation(b);
   }
 
   // Solve position constraints.
@@ -221,7 +220,7 @@ void b2Island_Solve(b2Island *island, const b2TimeStep *step,
     if (b->m_invMass == 0.0)
       continue;
 
-    b2Mat22_SetAngle(&b->m_R, b->m_rotation);
+    b2Body_SynchronizeRotation(b);
 
     b2Body_SynchronizeShapes(b);
     b2Vec2_Set(&b->m_force, 0.0, 0.0);
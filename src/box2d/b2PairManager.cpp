@@ -76,8 +76,8 @@ static b2Pair *b2PairManager_FindHash(b2PairManager *manager, int32 proxyId1,
   return manager->m_pairs + index;
 }
 
-static b2Pair *b2PairManager_Find(b2PairManager *manager, int32 proxyId1,
-                                  int32 proxyId2) {
+b2Pair *b2PairManager_Find(b2PairManager *manager, int32 proxyId1,
+                           int32 proxyId2) {
   if (proxyId1 > proxyId2)
     b2Swap(proxyId1, proxyId2);
 
@@ -282,11 +282,11 @@ bool b2RevoluteJoint_SolvePositionConstraints(b2Joint *joint) {
 
   b1->m_position -= b1->m_invMass * impulse;
   b1->m_rotation -= b1->m_invI * b2Cross(r1, impulse);
-  b2Mat22_SetAngle(&b1->m_R, b1->m_rotation);
+  b2Body_SynchronizeRotation(b1);
 
   b2->m_position += b2->m_invMass * impulse;
   b2->m_rotation += b2->m_invI * b2Cross(r2, impulse);
-  b2Mat22_SetAngle(&b2->m_R, b2->m_rotation);
+  b2Body_SynchronizeRotation(b2);
 
   // Handle limits.
   float64 angularError = 0.0;
@@ -328,9 +328,9 @@ bool b2RevoluteJoint_SolvePositionConstraints(b2Joint *joint) {
     }
 
     b1->m_rotation -= b1->m_invI * limitImpulse;
-    b2Mat22_SetAngle(&b1->m_R, b1->m_rotation);
+    b2Body_SynchronizeRotation(b1);
     b2->m_rotation += b2->m_invI * limitImpulse;
-    b2Mat22_SetAngle(&b2->m_R, b2->m_rotation);
+    b2Body_SynchronizeRotation(b2);
   }
 
   return positionError <= b2_linearSlop && angularError <= b2_angularSlop;
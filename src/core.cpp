@@ -49,6 +49,8 @@ char *do_export(char *user, char *name, char *desc) {
   return export_design(&the_arena.design, user, name, desc);
 }
 
+void publish(void) { render_snapshot_publish(&the_arena); }
+
 void draw(void) { arena_draw(&the_arena); }
 
 void call(void (*func)(void *arg), void *arg) { func(arg); }
@@ -0,0 +1,240 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "design_bin.h"
+#include "graph.h"
+#include "xml.h"
+
+_Static_assert(sizeof(struct design_bin_header) == 88,
+               "design_bin_header layout is part of the format");
+_Static_assert(sizeof(struct design_bin_block) == 48,
+               "design_bin_block layout is part of the format");
+
+int design_bin_is_binary(const char *buf, size_t len) {
+  return len >= 4 && !memcmp(buf, DESIGN_BIN_MAGIC, 4);
+}
+
+static uint32_t count_blocks(struct xml_block *block) {
+  uint32_t n = 0;
+
+  for (; block; block = block->next)
+    n++;
+
+  return n;
+}
+
+static uint32_t count_joints(struct xml_joint *joint) {
+  uint32_t n = 0;
+
+  for (; joint; joint = joint->next)
+    n++;
+
+  return n;
+}
+
+static void put_zone(double *out, struct xml_zone *zone) {
+  out[0] = zone->position.x;
+  out[1] = zone->position.y;
+  out[2] = zone->width;
+  out[3] = zone->height;
+}
+
+static void get_zone(struct xml_zone *zone, const double *in) {
+  zone->position.x = in[0];
+  zone->position.y = in[1];
+  zone->width = in[2];
+  zone->height = in[3];
+}
+
+/* writes one list of blocks and their joints, returns -1 if it cannot */
+static int put_blocks(struct xml_block *block, char **blocks, char **joints) {
+  struct design_bin_block out;
+  struct xml_joint *joint;
+  uint32_t n;
+
+  for (; block; block = block->next) {
+    n = count_joints(block->joints);
+    if (block->type < 0 || block->type > XML_HOLLOW_ROD || n > 255)
+      return -1;
+
+    memset(&out, 0, sizeof(out));
+    out.rotation = block->rotation;
+    out.x = block->position.x;
+    out.y = block->position.y;
+    out.width = block->width;
+    out.height = block->height;
+    out.id = block->id;
+    out.type = block->type;
+    out.goal_block = block->goal_block != 0;
+    out.joint_count = n;
+    memcpy(*blocks, &out, sizeof(out));
+    *blocks += sizeof(out);
+
+    for (joint = block->joints; joint; joint = joint->next) {
+      int32_t id = joint->id;
+
+      memcpy(*joints, &id, sizeof(id));
+      *joints += sizeof(id);
+    }
+  }
+
+  return 0;
+}
+
+static uint32_t count_all_joints(struct xml_block *block) {
+  uint32_t n = 0;
+
+  for (; block; block = block->next)
+    n += count_joints(block->joints);
+
+  return n;
+}
+
+char *design_bin_encode(struct xml_level *level, size_t *len) {
+  struct design_bin_header header;
+  char *buf;
+  char *blocks;
+  char *joints;
+
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, DESIGN_BIN_MAGIC, 4);
+  header.version = DESIGN_BIN_VERSION;
+  header.level_id = level->level_id;
+  header.level_block_count = count_blocks(level->level_blocks);
+  header.player_block_count = count_blocks(level->player_blocks);
+  header.joint_count = count_all_joints(level->level_blocks) +
+                       count_all_joints(level->player_blocks);
+  put_zone(header.start, &level->start);
+  put_zone(header.end, &level->end);
+
+  *len = sizeof(header) +
+         (size_t)(header.level_block_count + header.player_block_count) *
+             sizeof(struct design_bin_block) +
+         (size_t)header.joint_count * sizeof(int32_t);
+  buf = malloc(*len);
+  memcpy(buf, &header, sizeof(header));
+
+  blocks = buf + sizeof(header);
+  joints = blocks + (size_t)(header.level_block_count +
+                             header.player_block_count) *
+                        sizeof(struct design_bin_block);
+  if (put_blocks(level->level_blocks, &blocks, &joints) ||
+      put_blocks(level->player_blocks, &blocks, &joints)) {
+    free(buf);
+    return NULL;
+  }
+
+  return buf;
+}
+
+int design_bin_decode(const char *buf, size_t len, struct xml_level *level) {
+  struct design_bin_header header;
+  struct design_bin_block in;
+  struct xml_block *blocks;
+  struct xml_joint *joints;
+  const char *block_data;
+  const char *joint_data;
+  size_t max_blocks;
+  size_t block_count;
+  size_t joint_used = 0;
+  size_t i;
+  size_t k;
+
+  memset(level, 0, sizeof(*level));
+
+  if (len < sizeof(header) || !design_bin_is_binary(buf, len))
+    return -1;
+  memcpy(&header, buf, sizeof(header));
+  if (header.version != DESIGN_BIN_VERSION)
+    return -1;
+
+  /* each count is checked against the room left before they are added, so
+     the sum cannot wrap where size_t is 32 bits and level_block_count never
+     exceeds block_count */
+  max_blocks = (len - sizeof(header)) / sizeof(in);
+  if (header.level_block_count > max_blocks ||
+      header.player_block_count > max_blocks - header.level_block_count)
+    return -1;
+  block_count = (size_t)header.level_block_count + header.player_block_count;
+  if (header.joint_count > (len - sizeof(header) - block_count * sizeof(in)) /
+                               sizeof(int32_t) ||
+      len != sizeof(header) + block_count * sizeof(in) +
+                 header.joint_count * sizeof(int32_t))
+    return -1;
+
+  level->level_id = header.level_id;
+  get_zone(&level->start, header.start);
+  get_zone(&level->end, header.end);
+  if (block_count == 0)
+    return 0;
+
+  /* blocks first, so the allocation starts at the first block */
+  blocks = malloc(block_count * sizeof(*blocks) +
+                  header.joint_count * sizeof(*joints));
+  joints = (struct xml_joint *)(blocks + block_count);
+  block_data = buf + sizeof(header);
+  joint_data = block_data + block_count * sizeof(in);
+
+  for (i = 0; i < block_count; i++) {
+    memcpy(&in, block_data + i * sizeof(in), sizeof(in));
+    if (in.type > XML_HOLLOW_ROD ||
+        (size_t)in.joint_count > header.joint_count - joint_used) {
+      free(blocks);
+      memset(level, 0, sizeof(*level));
+      return -1;
+    }
+
+    blocks[i].type = in.type;
+    blocks[i].id = in.id;
+    blocks[i].rotation = in.rotation;
+    blocks[i].position.x = in.x;
+    blocks[i].position.y = in.y;
+    blocks[i].width = in.width;
+    blocks[i].height = in.height;
+    blocks[i].goal_block = in.goal_block;
+    blocks[i].joints = in.joint_count ? &joints[joint_used] : NULL;
+    blocks[i].next = i + 1 < block_count ? &blocks[i + 1] : NULL;
+
+    for (k = 0; k < in.joint_count; k++, joint_used++) {
+      int32_t id;
+
+      memcpy(&id, joint_data + joint_used * sizeof(id), sizeof(id));
+      joints[joint_used].id = id;
+      joints[joint_used].next =
+          k + 1 < in.joint_count ? &joints[joint_used + 1] : NULL;
+    }
+  }
+
+  if (joint_used != header.joint_count) {
+    free(blocks);
+    memset(level, 0, sizeof(*level));
+    return -1;
+  }
+
+  /* split the one chain into the two lists */
+  if (header.level_block_count) {
+    level->level_blocks = blocks;
+    blocks[header.level_block_count - 1].next = NULL;
+  }
+  if (header.player_block_count)
+    level->player_blocks = &blocks[header.level_block_count];
+
+  return 0;
+}
+
+void design_bin_free_level(struct xml_level *level) {
+  free(level->level_blocks ? level->level_blocks : level->player_blocks);
+  level->level_blocks = NULL;
+  level->player_blocks = NULL;
+}
+
+int design_bin_load(const char *buf, size_t len, struct design *design) {
+  struct xml_level level;
+
+  if (design_bin_decode(buf, len, &level))
+    return -1;
+  convert_xml(&level, design);
+  design_bin_free_level(&level);
+
+  return 0;
+}
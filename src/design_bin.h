@@ -0,0 +1,74 @@
+#ifndef DESIGN_BIN_H
+#define DESIGN_BIN_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Compact binary form of a retrieveLevel XML: the same blocks, joints, areas
+ * and level id that xml_parse reads, with every number kept as the raw IEEE
+ * double the parser produced, so converting back and forth is bit-exact.
+ *
+ * Layout, little-endian, every field at its natural alignment:
+ *
+ *   struct design_bin_header
+ *   struct design_bin_block   [level_block_count]   levelBlocks, in order
+ *   struct design_bin_block   [player_block_count]  playerBlocks, in order
+ *   int32_t                   [joint_count]         jointedTo ids, by block
+ *
+ * Each block's joint_count says how many of the jointedTo ids are its own.
+ * A reader that meets a version it does not know must reject the buffer.
+ */
+
+#define DESIGN_BIN_MAGIC "FCDB"
+#define DESIGN_BIN_VERSION 1
+
+struct design_bin_header {
+  char magic[4];
+  uint16_t version;
+  uint16_t reserved;
+  int32_t level_id; /* -1 if absent */
+  uint32_t level_block_count;
+  uint32_t player_block_count;
+  uint32_t joint_count;
+  double start[4]; /* build area: x, y, width, height */
+  double end[4];   /* goal area */
+};
+
+struct design_bin_block {
+  double rotation;
+  double x, y;
+  double width, height;
+  int32_t id; /* -1 if the XML had no id */
+  uint8_t type; /* XML_* */
+  uint8_t goal_block;
+  uint8_t joint_count;
+  uint8_t reserved;
+};
+
+struct xml_level;
+struct design;
+
+/* true if buf starts like a binary design rather than XML */
+int design_bin_is_binary(const char *buf, size_t len);
+
+/*
+ * Encodes a parsed level. Returns a malloc'd buffer and its length in *len,
+ * or NULL if the level cannot be represented (unknown block type, more than
+ * 255 joints on a block).
+ */
+char *design_bin_encode(struct xml_level *level, size_t *len);
+
+/*
+ * Reads a binary design into level without copying any number through text.
+ * All blocks and joints share one allocation; release them with
+ * design_bin_free_level, not xml_free. Returns 0, or -1 if the buffer is
+ * truncated, of another version or otherwise malformed.
+ */
+int design_bin_decode(const char *buf, size_t len, struct xml_level *level);
+void design_bin_free_level(struct xml_level *level);
+
+/* decode and convert_xml in one step */
+int design_bin_load(const char *buf, size_t len, struct design *design);
+
+#endif
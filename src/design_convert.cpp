@@ -0,0 +1,234 @@
+extern "C" {
+#include "design_bin.h"
+#include "graph.h"
+#include "xml.h"
+#include <fpmath/fpmath.h>
+}
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <iostream>
+#include <string>
+
+// Converts designs between retrieveLevel XML and the binary format of
+// design_bin.h, reading stdin and writing stdout.
+//
+// Usage: design_convert bin           XML in, binary out
+//        design_convert xml           binary in, XML out
+//        design_convert time [rounds] XML in, load times for both formats
+
+// indexed by the XML_* block types
+static const char *block_names[] = {
+    "StaticRectangle",
+    "StaticCircle",
+    "DynamicRectangle",
+    "DynamicCircle",
+    "JointedDynamicRectangle",
+    "NoSpinWheel",
+    "ClockwiseWheel",
+    "CounterClockwiseWheel",
+    "SolidRod",
+    "HollowRod",
+};
+
+static bool reads_back_as(const char *text, double val) {
+  double back;
+
+  return fp_strtod(text, strlen(text), &back) == 0 &&
+         memcmp(&back, &val, sizeof(val)) == 0;
+}
+
+// Text that fp_strtod reads back as exactly val, which fp_dtoa finds for
+// everything but tiny numbers (and the NaNs 0 * infinity does not make).
+static bool append_double(std::string &out, double val) {
+  char buf[FP_DTOA_BUFSIZE];
+
+  fp_dtoa(buf, val);
+  if (!reads_back_as(buf, val))
+    return false;
+  out += buf;
+  return true;
+}
+
+static bool append_number(std::string &out, const char *name, double val) {
+  out += "<";
+  out += name;
+  out += ">";
+  if (!append_double(out, val))
+    return false;
+  out += "</";
+  out += name;
+  out += ">";
+  return true;
+}
+
+static bool append_position(std::string &out, xml_position *position) {
+  out += "<position>";
+  if (!append_number(out, "x", position->x) ||
+      !append_number(out, "y", position->y))
+    return false;
+  out += "</position>";
+  return true;
+}
+
+static bool append_blocks(std::string &out, const char *name,
+                          xml_block *block) {
+  out += "<";
+  out += name;
+  out += ">";
+  for (; block; block = block->next) {
+    const char *type = block_names[block->type];
+
+    out += "<";
+    out += type;
+    if (block->id != -1)
+      out += " id=\"" + std::to_string(block->id) + "\"";
+    out += ">";
+    if (!append_number(out, "rotation", block->rotation) ||
+        !append_position(out, &block->position) ||
+        !append_number(out, "width", block->width) ||
+        !append_number(out, "height", block->height))
+      return false;
+    out += block->goal_block ? "<goalBlock>true</goalBlock>"
+                             : "<goalBlock>false</goalBlock>";
+    out += "<joints>";
+    for (xml_joint *joint = block->joints; joint; joint = joint->next)
+      out += "<jointedTo>" + std::to_string(joint->id) + "</jointedTo>";
+    out += "</joints></";
+    out += type;
+    out += ">";
+  }
+  out += "</";
+  out += name;
+  out += ">";
+  return true;
+}
+
+static bool append_zone(std::string &out, const char *name, xml_zone *zone) {
+  out += "<";
+  out += name;
+  out += ">";
+  if (!append_position(out, &zone->position) ||
+      !append_number(out, "width", zone->width) ||
+      !append_number(out, "height", zone->height))
+    return false;
+  out += "</";
+  out += name;
+  out += ">";
+  return true;
+}
+
+static bool write_xml(std::string &out, xml_level *level) {
+  out = "<?xml version=\"1.0\"?><retrieveLevel><levelId>";
+  if (level->level_id >= 0)
+    out += std::to_string(level->level_id);
+  out += "</levelId><level>";
+  if (!append_blocks(out, "levelBlocks", level->level_blocks) ||
+      !append_blocks(out, "playerBlocks", level->player_blocks) ||
+      !append_zone(out, "start", &level->start) ||
+      !append_zone(out, "end", &level->end))
+    return false;
+  out += "</level></retrieveLevel>\n";
+  return true;
+}
+
+static double seconds() { return (double)clock() / CLOCKS_PER_SEC; }
+
+static int time_loads(std::string &xml, int rounds) {
+  xml_level level;
+  memset(&level, 0, sizeof(level));
+  if (xml_parse(&xml[0], xml.length(), &level))
+    return 1;
+  size_t bin_len;
+  char *bin = design_bin_encode(&level, &bin_len);
+  xml_free(&level);
+  if (!bin)
+    return 1;
+
+  double start = seconds();
+  for (int i = 0; i < rounds; i++) {
+    design *loaded = (design *)calloc(1, sizeof(design));
+    memset(&level, 0, sizeof(level));
+    xml_parse(&xml[0], xml.length(), &level);
+    convert_xml(&level, loaded);
+    xml_free(&level);
+    free_design(loaded);
+  }
+  double xml_us = (seconds() - start) * 1e6 / rounds;
+
+  start = seconds();
+  for (int i = 0; i < rounds; i++) {
+    design *loaded = (design *)calloc(1, sizeof(design));
+    design_bin_load(bin, bin_len, loaded);
+    free_design(loaded);
+  }
+  double bin_us = (seconds() - start) * 1e6 / rounds;
+
+  printf("xml    %8zu bytes %9.1f us/load\n", xml.length(), xml_us);
+  printf("binary %8zu bytes %9.1f us/load\n", bin_len, bin_us);
+  free(bin);
+  return 0;
+}
+
+int main(int argc, char *argv[]) {
+  const char *mode = argc > 1 ? argv[1] : "";
+  std::string in(std::istreambuf_iterator<char>(std::cin), {});
+  xml_level level;
+
+  if (!strcmp(mode, "bin")) {
+    memset(&level, 0, sizeof(level));
+    if (xml_parse(&in[0], in.length(), &level)) {
+      std::cerr << "design_convert: cannot parse XML" << std::endl;
+      return 1;
+    }
+    size_t len;
+    char *bin = design_bin_encode(&level, &len);
+    xml_free(&level);
+    if (!bin) {
+      std::cerr << "design_convert: design has no binary form" << std::endl;
+      return 1;
+    }
+    fwrite(bin, 1, len, stdout);
+    free(bin);
+    return 0;
+  }
+
+  if (!strcmp(mode, "xml")) {
+    if (design_bin_decode(in.data(), in.length(), &level)) {
+      std::cerr << "design_convert: not a binary design" << std::endl;
+      return 1;
+    }
+    std::string xml;
+    bool ok = write_xml(xml, &level);
+    design_bin_free_level(&level);
+    if (!ok) {
+      std::cerr << "design_convert: number has no exact text form"
+                << std::endl;
+      return 1;
+    }
+    fwrite(xml.data(), 1, xml.length(), stdout);
+    return 0;
+  }
+
+  if (!strcmp(mode, "time"))
+    return time_loads(in, argc > 2 ? atoi(argv[2]) : 1000);
+
+  std::cerr << "usage: design_convert bin|xml|time [rounds] < in > out"
+            << std::endl;
+  return 2;
+}
+
+// stubs - functions that are called somewhere and therefore require linking
+// but don't have any effect on this CLI use case
+
+extern "C" {
+
+int set_interval(void (*func)(void *arg), int delay, void *arg) { return 0; }
+
+void clear_interval(int id) {}
+
+double time_precise_ms() { return 0; }
+}
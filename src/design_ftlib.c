@@ -0,0 +1,158 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "design_ftlib.h"
+#include "graph.h"
+#include "xml.h"
+
+/* ftlib piece type to XML block type, as in run_single_design */
+static int map_piece_type(int ftlib_type) {
+  switch (ftlib_type) {
+  case 0: /* static rect */
+    return XML_STATIC_RECTANGLE;
+  case 1: /* static circle */
+    return XML_STATIC_CIRCLE;
+  case 2: /* dynamic rect */
+    return XML_DYNAMIC_RECTANGLE;
+  case 3: /* dynamic circle */
+    return XML_DYNAMIC_CIRCLE;
+  case 4: /* goal rect */
+    return XML_JOINTED_DYNAMIC_RECTANGLE;
+  case 5: /* goal circle */
+  case 6: /* unpowered wheel */
+    return XML_NO_SPIN_WHEEL;
+  case 7: /* clockwise wheel */
+    return XML_CLOCKWISE_WHEEL;
+  case 8: /* counter-clockwise wheel */
+    return XML_COUNTER_CLOCKWISE_WHEEL;
+  case 9: /* water */
+    return XML_HOLLOW_ROD;
+  case 10: /* wood */
+    return XML_SOLID_ROD;
+  default:
+    return XML_DYNAMIC_RECTANGLE;
+  }
+}
+
+static int read_int(char **pos, int *res) {
+  char *end;
+  long val = strtol(*pos, &end, 10);
+
+  if (end == *pos)
+    return -1;
+  *pos = end;
+  *res = val;
+
+  return 0;
+}
+
+static int read_double(char **pos, double *res) {
+  char *end;
+  double val = strtod(*pos, &end);
+
+  if (end == *pos)
+    return -1;
+  *pos = end;
+  *res = val;
+
+  return 0;
+}
+
+static int read_zone(char **pos, struct xml_zone *zone) {
+  return read_double(pos, &zone->position.x) ||
+         read_double(pos, &zone->position.y) ||
+         read_double(pos, &zone->width) || read_double(pos, &zone->height);
+}
+
+static void add_joint(struct xml_block *block, int id) {
+  struct xml_joint *joint = calloc(1, sizeof(*joint));
+
+  joint->id = id;
+  joint->next = block->joints;
+  block->joints = joint;
+}
+
+static int read_block(char **pos, struct xml_block ***level_tail,
+                      struct xml_block ***player_tail) {
+  struct xml_block *block;
+  int type_id, id;
+  double x, y, w, h, angle;
+  int joint1, joint2;
+
+  if (read_int(pos, &type_id) || read_int(pos, &id) || read_double(pos, &x) ||
+      read_double(pos, &y) || read_double(pos, &w) || read_double(pos, &h) ||
+      read_double(pos, &angle) || read_int(pos, &joint1) ||
+      read_int(pos, &joint2))
+    return -1;
+
+  block = calloc(1, sizeof(*block));
+  block->type = map_piece_type(type_id);
+  block->id = id;
+  block->position.x = x;
+  block->position.y = y;
+  /* circles are given by diameter */
+  if (type_id == 1 || type_id == 3) {
+    block->width = w / 2.0;
+    block->height = h / 2.0;
+  } else {
+    block->width = w;
+    block->height = h;
+  }
+  block->rotation = angle;
+  block->goal_block = type_id == 4 || type_id == 5;
+  if (joint1 != -1)
+    add_joint(block, joint1);
+  if (joint2 != -1)
+    add_joint(block, joint2);
+
+  if (type_id <= 3) {
+    **level_tail = block;
+    *level_tail = &block->next;
+  } else {
+    **player_tail = block;
+    *player_tail = &block->next;
+  }
+
+  return 0;
+}
+
+/* blocks read so far stay in level even if a later one fails */
+static int read_level(char **pos, struct xml_level *level, int *max_ticks) {
+  struct xml_block **level_tail = &level->level_blocks;
+  struct xml_block **player_tail = &level->player_blocks;
+  int count;
+  int i;
+
+  if (read_int(pos, max_ticks) || read_int(pos, &count))
+    return -1;
+  for (i = 0; i < count; i++) {
+    if (read_block(pos, &level_tail, &player_tail))
+      return -1;
+  }
+
+  return read_zone(pos, &level->start) || read_zone(pos, &level->end) ? -1 : 0;
+}
+
+int design_ftlib_load(const char *text, size_t len, struct design *design,
+                      int64_t *max_ticks) {
+  struct xml_level level;
+  char *copy = malloc(len + 1);
+  char *pos = copy;
+  int ticks;
+  int res;
+
+  /* strtod needs the terminator */
+  memcpy(copy, text, len);
+  copy[len] = 0;
+  memset(&level, 0, sizeof(level));
+
+  res = read_level(&pos, &level, &ticks);
+  if (res == 0) {
+    convert_xml(&level, design);
+    *max_ticks = ticks;
+  }
+
+  xml_free(&level);
+  free(copy);
+  return res;
+}
@@ -0,0 +1,31 @@
+#ifndef DESIGN_FTLIB_H
+#define DESIGN_FTLIB_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * The whitespace separated token format of ftlib, which run_single_design
+ * reads on stdin:
+ *
+ *   max_ticks block_count
+ *   type id x y w h angle joint1 joint2   [block_count times]
+ *   build area: x y w h
+ *   goal area: x y w h
+ *
+ * Types are ftlib's (0 static rect ... 10 wood rod), circles give their
+ * diameter, and a joint of -1 means none. Numbers are read with strtol and
+ * strtod.
+ */
+
+struct design;
+
+/*
+ * Loads the text into design, as run_single_design does with its stdin,
+ * and sets *max_ticks. Returns 0, or -1 if the text is cut short
+ * or not a number where one is expected.
+ */
+int design_ftlib_load(const char *text, size_t len, struct design *design,
+                      int64_t *max_ticks);
+
+#endif
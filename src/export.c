@@ -1,11 +1,22 @@
-#include <math.h>
+#include <fpmath/fpmath.h>
 #include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
+#include <string.h>
 
 #include "graph.h"
 #include "str.h"
 
+/* appends a string literal without measuring it */
+#define append_lit(str, lit) append_strn(str, lit, sizeof(lit) - 1)
+
+/*
+ * Room one block can take at most: the tags around five numbers of at most
+ * FP_DTOA_BUFSIZE - 1 characters, the longest block name twice, an id and
+ * two joints.
+ */
+#define BLOCK_XML_MAX (320 + 5 * FP_DTOA_BUFSIZE)
+
 void u64tostr(char *buf, uint64_t val) {
   char tmp[20];
   int l = 0;
@@ -22,59 +33,6 @@ void u64tostr(char *buf, uint64_t val) {
   buf[l] = 0;
 }
 
-char *dtostr_int(char *buf, double val) {
-  u64tostr(buf, val); // TODO: handle big numbers
-
-  while (*buf)
-    buf++;
-
-  return buf;
-}
-
-void dtostr_frac(char *buf, double val) {
-  uint8_t tmp[18];
-  uint64_t u;
-  int l = 0;
-  int i;
-
-  u = val * 1e18;
-  if (u == 0)
-    return;
-
-  for (i = 0; i < 18; i++) {
-    tmp[i] = u % 10;
-    u /= 10;
-  }
-
-  for (i = 0; i < 18;
-       i++) { // compiler says remove the condition if it is always true
-    if (tmp[i] != 0) {
-      l = i;
-      break;
-    }
-  }
-
-  *buf++ = '.';
-  for (i = 17; i >= l; i--)
-    *buf++ = '0' + tmp[i];
-  *buf = 0;
-}
-
-void dtostr(char *buf, double val) {
-  double integer;
-  double frac;
-
-  if (val < 0) {
-    *buf++ = '-';
-    val = -val;
-  }
-
-  frac = modf(val, &integer);
-
-  buf = dtostr_int(buf, integer);
-  dtostr_frac(buf, frac);
-}
-
 void itostr(char *buf, int val) {
   if (val < 0) {
     *buf = '-';
@@ -93,10 +51,9 @@ void append_int(struct str *str, int x) {
 }
 
 void append_double(struct str *str, double val) {
-  char buf[50];
+  char buf[FP_DTOA_BUFSIZE];
 
-  dtostr(buf, val);
-  append_str(str, buf);
+  append_strn(str, buf, fp_dtoa(buf, val));
 }
 
 void update_block_ids(struct design *design) {
@@ -157,9 +114,9 @@ void append_jointed_to(struct str *str, struct block *block,
   if (other->uid == -1) /* just in case */
     return;
 
-  append_str(str, "<jointedTo>");
+  append_lit(str, "<jointedTo>");
   append_int(str, other->uid);
-  append_str(str, "</jointedTo>");
+  append_lit(str, "</jointedTo>");
 }
 
 void append_joints(struct str *str, struct block *block) {
@@ -173,10 +130,10 @@ void append_joints(struct str *str, struct block *block) {
     joints[0] = block->shape.wheel.center;
   }
 
-  append_str(str, "<joints>");
+  append_lit(str, "<joints>");
   for (i = 0; i < 2; i++)
     append_jointed_to(str, block, joints[i]);
-  append_str(str, "</joints>");
+  append_lit(str, "</joints>");
 }
 
 void _append_block(struct str *str, struct block *block) {
@@ -189,130 +146,147 @@ void _append_block(struct str *str, struct block *block) {
 
   get_shell(&shell, &block->shape);
 
-  append_str(str, "<");
+  append_lit(str, "<");
   append_str(str, name);
   if (block->uid != -1) {
-    append_str(str, " id=\"");
+    append_lit(str, " id=\"");
     append_int(str, block->uid);
-    append_str(str, "\"");
+    append_lit(str, "\"");
   }
-  append_str(str, ">");
+  append_lit(str, ">");
 
-  append_str(str, "<rotation>");
+  append_lit(str, "<rotation>");
   append_double(str, shell.angle);
-  append_str(str, "</rotation>");
+  append_lit(str, "</rotation>");
 
-  append_str(str, "<position>");
-  append_str(str, "<x>");
+  append_lit(str, "<position>");
+  append_lit(str, "<x>");
   append_double(str, shell.x);
-  append_str(str, "</x>");
-  append_str(str, "<y>");
+  append_lit(str, "</x>");
+  append_lit(str, "<y>");
   append_double(str, shell.y);
-  append_str(str, "</y>");
-  append_str(str, "</position>");
+  append_lit(str, "</y>");
+  append_lit(str, "</position>");
 
-  append_str(str, "<width>");
+  append_lit(str, "<width>");
   if (shell.type == SHELL_RECT)
     append_double(str, shell.rect.w);
   else if (block->shape.type == SHAPE_WHEEL)
     append_double(str, shell.circ.radius * 2);
   else
     append_double(str, shell.circ.radius);
-  append_str(str, "</width>");
+  append_lit(str, "</width>");
 
-  append_str(str, "<height>");
+  append_lit(str, "<height>");
   if (shell.type == SHELL_RECT)
     append_double(str, shell.rect.h);
   else if (block->shape.type == SHAPE_WHEEL)
     append_double(str, shell.circ.radius * 2);
   else
     append_double(str, shell.circ.radius);
-  append_str(str, "</height>");
+  append_lit(str, "</height>");
 
-  append_str(str, "<goalBlock>");
+  append_lit(str, "<goalBlock>");
   if (block->goal)
-    append_str(str, "true");
+    append_lit(str, "true");
   else
-    append_str(str, "false");
-  append_str(str, "</goalBlock>");
+    append_lit(str, "false");
+  append_lit(str, "</goalBlock>");
 
   append_joints(str, block);
 
-  append_str(str, "</");
+  append_lit(str, "</");
   append_str(str, name);
-  append_str(str, ">");
+  append_lit(str, ">");
 }
 
 void append_block_list(struct str *str, struct block_list *list, char *name) {
   struct block *block;
 
-  append_str(str, "<");
+  append_lit(str, "<");
   append_str(str, name);
-  append_str(str, ">");
+  append_lit(str, ">");
 
   for (block = list->head; block; block = block->next)
     _append_block(str, block);
 
-  append_str(str, "</");
+  append_lit(str, "</");
   append_str(str, name);
-  append_str(str, ">");
+  append_lit(str, ">");
 }
 
 void append_area(struct str *str, struct area *area, char *name) {
-  append_str(str, "<");
+  append_lit(str, "<");
   append_str(str, name);
-  append_str(str, ">");
+  append_lit(str, ">");
 
-  append_str(str, "<position>");
-  append_str(str, "<x>");
+  append_lit(str, "<position>");
+  append_lit(str, "<x>");
   append_double(str, area->x);
-  append_str(str, "</x>");
-  append_str(str, "<y>");
+  append_lit(str, "</x>");
+  append_lit(str, "<y>");
   append_double(str, area->y);
-  append_str(str, "</y>");
-  append_str(str, "</position>");
+  append_lit(str, "</y>");
+  append_lit(str, "</position>");
 
-  append_str(str, "<width>");
+  append_lit(str, "<width>");
   append_double(str, area->w);
-  append_str(str, "</width>");
+  append_lit(str, "</width>");
 
-  append_str(str, "<height>");
+  append_lit(str, "<height>");
   append_double(str, area->h);
-  append_str(str, "</height>");
+  append_lit(str, "</height>");
 
-  append_str(str, "</");
+  append_lit(str, "</");
   append_str(str, name);
-  append_str(str, ">");
+  append_lit(str, ">");
+}
+
+static size_t count_blocks(struct block_list *list) {
+  struct block *block;
+  size_t n = 0;
+
+  for (block = list->head; block; block = block->next)
+    n++;
+
+  return n;
 }
 
 char *export_design(struct design *design, char *user, char *name, char *desc) {
   struct str str;
+  size_t cap;
 
   update_block_ids(design);
 
-  make_str(&str, 16);
-  append_str(&str, "<saveDesign>");
-  append_str(&str, "<name>");
+  /* sized so that the appends below never reallocate */
+  cap = 1024 + 8 * FP_DTOA_BUFSIZE + strlen(user) + strlen(name) +
+        strlen(desc) +
+        (count_blocks(&design->level_blocks) +
+         count_blocks(&design->design_blocks)) *
+            BLOCK_XML_MAX;
+  make_str(&str, cap);
+  append_lit(&str, "<saveDesign>");
+  append_lit(&str, "<name>");
   append_str(&str, name);
-  append_str(&str, "</name>");
-  append_str(&str, "<description>");
+  append_lit(&str, "</name>");
+  append_lit(&str, "<description>");
   append_str(&str, desc);
-  append_str(&str, "</description>");
-  append_str(&str, "<userId>");
+  append_lit(&str, "</description>");
+  append_lit(&str, "<userId>");
   append_str(&str, user);
-  append_str(&str, "</userId>");
-  append_str(&str, "<levelId>");
+  append_lit(&str, "</userId>");
+  append_lit(&str, "<levelId>");
   if (design->level_id >= 0)
     append_int(&str, design->level_id);
-  append_str(&str, "</levelId>");
-  append_str(&str, "<isSolution>0</isSolution>");
-  append_str(&str, "<level>");
+  append_lit(&str, "</levelId>");
+  append_lit(&str, "<isSolution>0</isSolution>");
+  append_lit(&str, "<level>");
   append_block_list(&str, &design->level_blocks, "levelBlocks");
   append_block_list(&str, &design->design_blocks, "playerBlocks");
   append_area(&str, &design->build_area, "start");
   append_area(&str, &design->goal_area, "end");
-  append_str(&str, "</level>");
-  append_str(&str, "</saveDesign>");
+  append_lit(&str, "</level>");
+  append_lit(&str, "</saveDesign>");
 
   return str.mem;
 }
@@ -0,0 +1,190 @@
+#include <box2d/b2Body.h>
+#include <fcsim_core/fcsim_core.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "design_bin.h"
+#include "design_ftlib.h"
+#include "graph.h"
+#include "xml.h"
+
+_Static_assert(sizeof(struct fcsim_body_state) ==
+                   FCSIM_BODY_STATE_FIELDS * sizeof(double),
+               "fcsim_body_state must be a plain array of doubles");
+
+/* kept packed, which pack_design only reads, so worlds can share it */
+struct fcsim_design {
+  struct packed_design *packed;
+  uint64_t fingerprint;
+};
+
+struct fcsim_world {
+  struct design *design;
+  b2World *world;
+  struct block **blocks; /* level blocks, then design blocks */
+  int block_count;
+  int64_t tick;
+  int64_t solve_tick;
+};
+
+/* takes the design, which is freed either way */
+static struct fcsim_design *pack_loaded(struct design *design, int err) {
+  struct fcsim_design *res;
+
+  if (err) {
+    free_design(design);
+    return NULL;
+  }
+
+  res = malloc(sizeof(*res));
+  res->fingerprint = design_fingerprint(design);
+  res->packed = pack_design(design);
+  free_design(design);
+
+  return res;
+}
+
+struct fcsim_design *fcsim_design_load(const char *buf, size_t len) {
+  struct xml_level level;
+  struct design *design;
+  char *copy;
+  int err;
+
+  design = calloc(1, sizeof(*design));
+  if (design_bin_is_binary(buf, len)) {
+    err = design_bin_load(buf, len, design);
+  } else {
+    /* the parser takes a writable buffer */
+    copy = malloc(len + 1);
+    memcpy(copy, buf, len);
+    copy[len] = 0;
+    memset(&level, 0, sizeof(level));
+    err = len > 0x7fffffff || xml_parse(copy, len, &level);
+    if (!err)
+      convert_xml(&level, design);
+    xml_free(&level);
+    free(copy);
+  }
+
+  return pack_loaded(design, err);
+}
+
+struct fcsim_design *fcsim_design_load_ftlib(const char *text, size_t len,
+                                             int64_t *max_ticks) {
+  struct design *design = calloc(1, sizeof(*design));
+
+  return pack_loaded(design, design_ftlib_load(text, len, design, max_ticks));
+}
+
+void fcsim_design_free(struct fcsim_design *design) {
+  if (!design)
+    return;
+  free_packed_design(design->packed);
+  free(design);
+}
+
+uint64_t fcsim_design_fingerprint(const struct fcsim_design *design) {
+  return design->fingerprint;
+}
+
+int fcsim_design_block_count(const struct fcsim_design *design) {
+  return design->packed->block_count;
+}
+
+int fcsim_design_block_info(const struct fcsim_design *design, int index,
+                            struct fcsim_block_info *info) {
+  struct packed_block *block;
+
+  if (index < 0 || index >= design->packed->block_count)
+    return -1;
+
+  block = &packed_design_blocks(design->packed)[index];
+  info->id = block->uid;
+  info->type = block->type_id;
+  info->goal = block->goal;
+  info->level = index < design->packed->level_block_count;
+
+  return 0;
+}
+
+struct fcsim_world *fcsim_world_create(const struct fcsim_design *design) {
+  struct fcsim_world *world = malloc(sizeof(*world));
+  struct block *block;
+  int i = 0;
+
+  world->design = unpack_design(design->packed);
+  world->world = gen_world(world->design);
+  world->block_count = design->packed->block_count;
+  world->blocks = malloc((world->block_count + 1) * sizeof(*world->blocks));
+  for (block = world->design->level_blocks.head; block; block = block->next)
+    world->blocks[i++] = block;
+  for (block = world->design->design_blocks.head; block; block = block->next)
+    world->blocks[i++] = block;
+  world->tick = 0;
+  world->solve_tick = -1;
+
+  return world;
+}
+
+void fcsim_world_free(struct fcsim_world *world) {
+  if (!world)
+    return;
+  free_world(world->world, world->design);
+  free_design(world->design);
+  free(world->blocks);
+  free(world);
+}
+
+static void step_once(struct fcsim_world *world) {
+  step(world->world);
+  world->tick++;
+  if (world->solve_tick < 0 && goal_blocks_inside_goal_area(world->design))
+    world->solve_tick = world->tick;
+}
+
+int64_t fcsim_world_step(struct fcsim_world *world, int64_t ticks) {
+  for (; ticks > 0; ticks--)
+    step_once(world);
+
+  return world->tick;
+}
+
+int64_t fcsim_world_run(struct fcsim_world *world, int64_t max_ticks) {
+  while ((max_ticks < 0 || world->tick < max_ticks) && world->solve_tick < 0)
+    step_once(world);
+
+  return world->solve_tick;
+}
+
+int64_t fcsim_world_tick(const struct fcsim_world *world) {
+  return world->tick;
+}
+
+int64_t fcsim_world_solve_tick(const struct fcsim_world *world) {
+  return world->solve_tick;
+}
+
+int fcsim_world_goal_reached(const struct fcsim_world *world) {
+  return goal_blocks_inside_goal_area(world->design);
+}
+
+int fcsim_world_snapshot(const struct fcsim_world *world,
+                         struct fcsim_body_state *out, int count) {
+  int i;
+
+  if (count > world->block_count)
+    count = world->block_count;
+
+  for (i = 0; i < count; i++) {
+    b2Body *body = world->blocks[i]->body;
+
+    out[i].x = body->m_position.x;
+    out[i].y = body->m_position.y;
+    out[i].angle = body->m_rotation;
+    out[i].vx = body->m_linearVelocity.x;
+    out[i].vy = body->m_linearVelocity.y;
+    out[i].angular_velocity = body->m_angularVelocity;
+  }
+
+  return count;
+}
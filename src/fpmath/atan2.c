@@ -47,7 +47,11 @@
 // see fpatan.s
 double fpatan(double y, double x);
 double fp_atan2(double y, double x) { return fpatan(y, x); }
-#else
+uint64_t fp_atan2_slow_path_count(void) { return 0; }
+#endif
+
+// The software implementation is always built: it is the reference the
+// fpatan variant is checked against in test/fpmath_test.cpp.
 
 /* dla.h */
 #define CN 134217729.0
@@ -2043,9 +2047,11 @@ static const mynumber cij[241][7] = {
 
 #define TWO52 0x1.0p52
 
-double fp_atan2(double y, double x) {
-  int i, de, ux, dx, uy, dy;
-  double ax, ay, u, du, v, vv, dv, t1, t2, t3, z, zz, cor;
+static inline double atan2_finite(double y, double x, double ax, double ay);
+
+double fp_atan2_reference(double y, double x) {
+  int de, ux, dx, uy, dy;
+  double ax, ay, z;
   mynumber num;
 
   static const int ep = 59768832, /*  57*16**5   */
@@ -2161,7 +2167,14 @@ double fp_atan2(double y, double x) {
     ay *= twom500.d;
   }
 
-  /* x,y which are neither special nor extreme */
+  return atan2_finite(y, x, ax, ay);
+}
+
+/* x,y which are neither special nor extreme */
+static inline double atan2_finite(double y, double x, double ax, double ay) {
+  int i;
+  double u, du, v, vv, dv, t1, t2, t3, z, zz, cor;
+
   if (ay < ax) {
     u = ay / ax;
     EMULV(ax, u, v, vv);
@@ -2283,4 +2296,38 @@ double fp_atan2(double y, double x) {
   return copysign(z, y);
 }
 
-#endif // #ifdef USE_FPATAN
+#ifndef USE_FPATAN
+static uint64_t slow_path_count;
+
+/*
+ * Almost every call made by the simulator has finite, nonzero arguments
+ * within 2**+-500 of each other and of one, so none of the special cases
+ * above apply.  Those are recognised from the exponents alone and go
+ * straight to atan2_finite, which is the exact code the reference would
+ * reach, so the result is bit-identical.  Everything else takes the full
+ * reference path.
+ */
+double fp_atan2(double y, double x) {
+  mynumber num;
+  int ex, ey;
+
+  num.d = x;
+  ex = (num.i[HIGH_HALF] >> 20) & 0x7ff;
+  num.d = y;
+  ey = (num.i[HIGH_HALF] >> 20) & 0x7ff;
+
+  /* 2**-500 <= |x|,|y| < 2**500 and |de| < 57*16**5 */
+  if ((unsigned)(ex - 523) < 1000 && (unsigned)(ey - 523) < 1000 &&
+      (unsigned)(ey - ex + 56) < 113) {
+    return atan2_finite(y, x, (x < 0) ? -x : x, (y < 0) ? -y : y);
+  }
+
+  // the preview worker thread calls this too
+  __atomic_fetch_add(&slow_path_count, 1, __ATOMIC_RELAXED);
+  return fp_atan2_reference(y, x);
+}
+
+uint64_t fp_atan2_slow_path_count(void) {
+  return __atomic_load_n(&slow_path_count, __ATOMIC_RELAXED);
+}
+#endif
@@ -0,0 +1,600 @@
+#include <fpmath/fpmath.h>
+#include <stdint.h>
+#include <string.h>
+
+/*
+ * A finite double is m * 2**e exactly, so its full decimal expansion is the
+ * integer m * 2**e (e >= 0) or m * 5**-e scaled by 10**e (e < 0). Its digits
+ * are rounded to nearest even at increasing lengths, and the first length
+ * fp_strtod reads back exactly is written out. For the magnitudes designs use
+ * fast_round gets the rounded digits straight from a 128 bit product and
+ * try_rounded predicts what fp_strtod makes of them; elsewhere the expansion
+ * is built in a bignum and the text is parsed. fp_strtod is not correctly
+ * rounded, so the check cannot be left out, and 17 digits are not always
+ * enough; then integer_form searches for other digits that do read back.
+ */
+
+struct bignum {
+  uint32_t words[80]; /* least significant first; 5**1074 * 2**53 fits */
+  int num_words;
+};
+
+static void bignum_mul(struct bignum *bignum, uint32_t mul) {
+  uint64_t carry = 0;
+  int i;
+
+  for (i = 0; i < bignum->num_words; i++) {
+    carry += (uint64_t)bignum->words[i] * mul;
+    bignum->words[i] = (uint32_t)carry;
+    carry >>= 32;
+  }
+  if (carry)
+    bignum->words[bignum->num_words++] = (uint32_t)carry;
+}
+
+/* divides in place, returns the remainder */
+static uint32_t bignum_divmod(struct bignum *bignum, uint32_t div) {
+  uint64_t rem = 0;
+  int i;
+
+  for (i = bignum->num_words - 1; i >= 0; i--) {
+    rem = (rem << 32) | bignum->words[i];
+    bignum->words[i] = (uint32_t)(rem / div);
+    rem %= div;
+  }
+  while (bignum->num_words > 0 && bignum->words[bignum->num_words - 1] == 0)
+    bignum->num_words--;
+
+  return (uint32_t)rem;
+}
+
+/*
+ * The decimal digits of |val| into digits, most significant first, without
+ * trailing zeros. Returns their count; *point is where the decimal point
+ * goes, counted in digits from the left (0.digits * 10**point).
+ */
+static int exact_digits(double val, char *digits, int *point) {
+  struct bignum bignum;
+  char tmp[780];
+  uint64_t bits;
+  uint64_t mant;
+  int exp;
+  int len = 0;
+  int skip;
+  int i;
+
+  memcpy(&bits, &val, sizeof(bits));
+  exp = (int)((bits >> 52) & 0x7ff);
+  mant = bits & 0xfffffffffffffull;
+  if (exp == 0)
+    exp = 1; /* subnormal */
+  else
+    mant |= 1ull << 52;
+  exp -= 1075;
+
+  bignum.words[0] = (uint32_t)mant;
+  bignum.words[1] = (uint32_t)(mant >> 32);
+  bignum.num_words = bignum.words[1] ? 2 : 1;
+
+  if (exp >= 0) {
+    for (; exp >= 31; exp -= 31)
+      bignum_mul(&bignum, 1u << 31);
+    bignum_mul(&bignum, 1u << exp);
+    exp = 0;
+  } else {
+    for (i = -exp; i >= 13; i -= 13)
+      bignum_mul(&bignum, 1220703125); /* 5**13 */
+    for (; i > 0; i--)
+      bignum_mul(&bignum, 5);
+  }
+
+  /* nine digits at a time, least significant first */
+  while (bignum.num_words > 0) {
+    uint32_t chunk = bignum_divmod(&bignum, 1000000000);
+
+    for (i = 0; i < 9; i++) {
+      tmp[len++] = '0' + chunk % 10;
+      chunk /= 10;
+    }
+  }
+  while (len > 1 && tmp[len - 1] == '0')
+    len--;
+  *point = len + exp;
+
+  /* reverse, dropping trailing zeros */
+  for (skip = 0; tmp[skip] == '0'; skip++)
+    ;
+  for (i = 0; i < len - skip; i++)
+    digits[i] = tmp[len - 1 - i];
+
+  return len - skip;
+}
+
+/* rounds digits[0..len) to at most n digits into out, nearest even; returns
+   the new length without trailing zeros and moves *point if it carries */
+static int round_digits(char *out, const char *digits, int len, int n,
+                        int *point) {
+  int up;
+  int i;
+
+  if (len <= n) {
+    memcpy(out, digits, len);
+    return len;
+  }
+
+  if (digits[n] != '5') {
+    up = digits[n] > '5';
+  } else {
+    up = (digits[n - 1] - '0') & 1;
+    for (i = n + 1; i < len; i++) {
+      if (digits[i] != '0') {
+        up = 1;
+        break;
+      }
+    }
+  }
+
+  memcpy(out, digits, n);
+  len = n;
+  if (up) {
+    for (i = n - 1; i >= 0 && out[i] == '9'; i--)
+      len--;
+    if (i < 0) {
+      out[0] = '1';
+      (*point)++;
+      return 1;
+    }
+    out[i]++;
+  }
+  while (len > 1 && out[len - 1] == '0')
+    len--;
+
+  return len;
+}
+
+/* e+X or e-X, returns the length */
+static int write_exp(char *buf, int exp) {
+  char *p = buf;
+
+  *p++ = 'e';
+  *p++ = exp < 0 ? '-' : '+';
+  if (exp < 0)
+    exp = -exp;
+  if (exp >= 100)
+    *p++ = '0' + exp / 100;
+  if (exp >= 10)
+    *p++ = '0' + exp / 10 % 10;
+  *p++ = '0' + exp % 10;
+
+  return (int)(p - buf);
+}
+
+/* whether layout writes a number with its point here as d.ddde+X */
+static int uses_exponent(int point) { return point > 21 || point <= -6; }
+
+/* JavaScript's layout: fixed notation for 1e-6 <= |val| < 1e21 */
+static int layout(char *buf, int neg, const char *digits, int len, int point) {
+  char *p = buf;
+  int i;
+
+  if (neg)
+    *p++ = '-';
+
+  if (uses_exponent(point)) {
+    int exp = point - 1;
+
+    *p++ = digits[0];
+    if (len > 1) {
+      *p++ = '.';
+      memcpy(p, digits + 1, len - 1);
+      p += len - 1;
+    }
+    p += write_exp(p, exp);
+  } else if (point <= 0) {
+    *p++ = '0';
+    *p++ = '.';
+    for (i = point; i < 0; i++)
+      *p++ = '0';
+    memcpy(p, digits, len);
+    p += len;
+  } else if (point >= len) {
+    memcpy(p, digits, len);
+    p += len;
+    for (i = len; i < point; i++)
+      *p++ = '0';
+  } else {
+    memcpy(p, digits, point);
+    p += point;
+    *p++ = '.';
+    memcpy(p, digits + point, len - point);
+    p += len - point;
+  }
+  *p = 0;
+
+  return (int)(p - buf);
+}
+
+/* 5**n for n <= 22, all below 2**52 */
+static const uint64_t pow5[23] = {
+    1ull,
+    5ull,
+    25ull,
+    125ull,
+    625ull,
+    3125ull,
+    15625ull,
+    78125ull,
+    390625ull,
+    1953125ull,
+    9765625ull,
+    48828125ull,
+    244140625ull,
+    1220703125ull,
+    6103515625ull,
+    30517578125ull,
+    152587890625ull,
+    762939453125ull,
+    3814697265625ull,
+    19073486328125ull,
+    95367431640625ull,
+    476837158203125ull,
+    2384185791015625ull,
+};
+
+/* 10**n for n <= 19 */
+static const uint64_t pow10_u64[20] = {
+    1ull,
+    10ull,
+    100ull,
+    1000ull,
+    10000ull,
+    100000ull,
+    1000000ull,
+    10000000ull,
+    100000000ull,
+    1000000000ull,
+    10000000000ull,
+    100000000000ull,
+    1000000000000ull,
+    10000000000000ull,
+    100000000000000ull,
+    1000000000000000ull,
+    10000000000000000ull,
+    100000000000000000ull,
+    1000000000000000000ull,
+    10000000000000000000ull,
+};
+
+static void mul_64x64(uint64_t a, uint64_t b, uint64_t *hi, uint64_t *lo) {
+  uint64_t a_lo = (uint32_t)a, a_hi = a >> 32;
+  uint64_t b_lo = (uint32_t)b, b_hi = b >> 32;
+  uint64_t ll = a_lo * b_lo;
+  uint64_t lh = a_lo * b_hi;
+  uint64_t hl = a_hi * b_lo;
+  uint64_t mid = (ll >> 32) + (uint32_t)lh + (uint32_t)hl;
+
+  *lo = (mid << 32) | (uint32_t)ll;
+  *hi = a_hi * b_hi + (lh >> 32) + (hl >> 32) + (mid >> 32);
+}
+
+/* the decimal digits of n > 0, returns their count */
+static int u64_digits(uint64_t n, char *digits) {
+  char tmp[20];
+  int len = 0;
+  int i;
+
+  for (; n > 0; n /= 10)
+    tmp[len++] = '0' + n % 10;
+  for (i = 0; i < len; i++)
+    digits[i] = tmp[len - 1 - i];
+
+  return len;
+}
+
+/*
+ * |val| * 10**s rounded to nearest even, as *res, with s chosen so that *res
+ * has n digits (or is 10**n, when rounding carries); these are the digits
+ * round_digits gives, without the bignum. |val| * 10**s = m * 5**s *
+ * 2**(e + s) fits 128 bits when s <= 22, and the shift right rounds exactly.
+ * Returns 0 for values out of its reach, i.e. below about 1e-5 or from 10**n
+ * up.
+ */
+static int fast_round(double val, int n, uint64_t *res, int *s) {
+  uint64_t bits;
+  uint64_t mant;
+  uint64_t hi, lo;
+  int exp;
+  int est;
+  int shift;
+  int up;
+
+  memcpy(&bits, &val, sizeof(bits));
+  exp = (int)((bits >> 52) & 0x7ff);
+  if (exp == 0)
+    return 0;
+  mant = (bits & 0xfffffffffffffull) | (1ull << 52);
+  exp -= 1075;
+
+  /* |val| is in [2**(exp + 52), 2**(exp + 53)), so its point is at est + 1
+     or est + 2; est is floor((exp + 52) * log10(2)), with 78913 / 2**18 just
+     above log10(2) */
+  est = exp + 52;
+  est = est >= 0 ? est * 78913 >> 18 : -((-est * 78913 + 262143) >> 18);
+
+  for (*s = n - est - 1; *s >= n - est - 2; (*s)--) {
+    if (*s < 0 || *s > 22)
+      return 0;
+
+    mul_64x64(mant, pow5[*s], &hi, &lo);
+    shift = exp + *s;
+    if (shift >= 0) {
+      if (shift > 10)
+        return 0;
+      *res = lo << shift;
+    } else if (shift > -64) {
+      uint64_t rem = lo & ((1ull << -shift) - 1);
+      uint64_t half = 1ull << (-shift - 1);
+
+      if (hi >> -shift)
+        return 0;
+      *res = (lo >> -shift) | (hi << (64 + shift));
+      up = rem > half || (rem == half && (*res & 1));
+      *res += up;
+    } else if (shift == -64) {
+      *res = hi;
+      up = lo > (1ull << 63) || (lo == (1ull << 63) && (*res & 1));
+      *res += up;
+    } else if (shift > -128) {
+      uint64_t rem_hi = hi & ((1ull << (-shift - 64)) - 1);
+      uint64_t half_hi = 1ull << (-shift - 65);
+
+      *res = hi >> (-shift - 64);
+      up = rem_hi > half_hi || (rem_hi == half_hi && (lo || (*res & 1)));
+      *res += up;
+    } else {
+      return 0;
+    }
+
+    /* one digit too many: the estimate was one low */
+    if (*res <= pow10_u64[n])
+      return 1;
+  }
+
+  return 0;
+}
+
+/* lays out res * 10**-s, returns the length */
+static int layout_rounded(char *buf, int neg, uint64_t res, int s) {
+  char digits[20];
+  int len = u64_digits(res, digits);
+  int point = len - s;
+
+  while (len > 1 && digits[len - 1] == '0')
+    len--;
+
+  return layout(buf, neg, digits, len, point);
+}
+
+static int reads_back(const char *buf, int len, double val) {
+  double back;
+
+  fp_strtod(buf, len, &back);
+
+  return !memcmp(&back, &val, sizeof(val));
+}
+
+/* powers of ten a double holds exactly */
+static const double exact_pow10[23] = {
+    1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22,
+};
+
+/*
+ * Whether the layout of res * 10**-s reads back as val; if so it is written
+ * to buf and its length returned, otherwise 0. Where the text falls in
+ * fp_strtod's fast path (at most 19 digits, counting the zeros layout adds,
+ * and a scale of at most 22) its result is worked out here the way
+ * strtod_fast does, so no text is written or read for a miss.
+ */
+static int try_rounded(char *buf, int neg, uint64_t res, int s, double val) {
+  uint64_t digits;
+  double back;
+  int num_digits;
+  int scale;
+  int point;
+  int len = 0;
+  int out;
+  int i;
+
+  while (res % 10 == 0) {
+    res /= 10;
+    s--;
+  }
+  while (len < 19 && res >= pow10_u64[len + 1])
+    len++;
+  len++;
+  point = len - s;
+
+  digits = res;
+  scale = len - point;
+  if (uses_exponent(point) || point < len) {
+    num_digits = point <= 0 && !uses_exponent(point) ? 1 - point + len : len;
+  } else {
+    num_digits = point;
+    scale = 0;
+    for (i = len; i < point && i < 20; i++)
+      digits *= 10;
+  }
+
+  if (num_digits <= 19 && scale >= -22 && scale <= 22) {
+    if (scale < 0)
+      back = (double)digits * exact_pow10[-scale];
+    else
+      back = (double)digits / exact_pow10[scale];
+    if (neg)
+      back = -back;
+    if (memcmp(&back, &val, sizeof(val)))
+      return 0;
+    return layout_rounded(buf, neg, res, s);
+  }
+
+  out = layout_rounded(buf, neg, res, s);
+  return reads_back(buf, out, val) ? out : 0;
+}
+
+/* 10**n the way fp_strtod computes it, which for large n is not the double
+   nearest to 10**n */
+static double pow10_like_strtod(int n) {
+  double res = 1.0;
+  double x = 10.0;
+
+  while (n) {
+    if (n & 1)
+      res *= x;
+    x *= x;
+    n >>= 1;
+  }
+
+  return res;
+}
+
+/*
+ * fp_strtod reads "Ne-k" as N / 10**k and "Ne+k" as N * 10**k, rounding N to
+ * a double first, so val can also be written as a double N near val * 10**k
+ * (val / 10**k) that is large enough to be an integer. Tries N of 17 to 30
+ * digits and the doubles next to each. Returns the length, or 0 if none
+ * reads back.
+ */
+static int integer_form(char *buf, int neg, double val, int point) {
+  char digits[780];
+  uint64_t bits;
+  double mag = neg ? -val : val;
+  double scale;
+  double cand;
+  double n;
+  int shift;
+  int step;
+  int len;
+  int n_point;
+  int exp;
+  char *p;
+  int i;
+
+  for (shift = 17; shift <= 30; shift++) {
+    exp = point - shift;
+    scale = pow10_like_strtod(exp < 0 ? -exp : exp);
+    n = exp < 0 ? mag * scale : mag / scale;
+    /* below 2**53 not every double is an integer */
+    if (!(n >= 0x1p53 && n < 0x1p110))
+      continue;
+
+    for (step = -2; step <= 2; step++) {
+      memcpy(&bits, &n, sizeof(bits));
+      bits += step;
+      memcpy(&cand, &bits, sizeof(cand));
+
+      if (cand < 0x1p64) {
+        len = try_rounded(buf, neg, (uint64_t)cand, -exp, val);
+        if (len)
+          return len;
+        continue;
+      }
+
+      len = exact_digits(cand, digits, &n_point);
+      p = buf;
+      if (neg)
+        *p++ = '-';
+      memcpy(p, digits, len);
+      p += len;
+      for (i = len; i < n_point; i++)
+        *p++ = '0';
+      p += write_exp(p, exp);
+      *p = 0;
+      if (reads_back(buf, (int)(p - buf), val))
+        return (int)(p - buf);
+    }
+  }
+
+  return 0;
+}
+
+static int copy_text(char *buf, const char *text) {
+  int len = (int)strlen(text);
+
+  memcpy(buf, text, len + 1);
+
+  return len;
+}
+
+int fp_dtoa(char *buf, double val) {
+  static const int nudges[] = {-1, 1, -2, 2, -3, 3, -4, 4};
+  char all[780];
+  char digits[32];
+  uint64_t bits;
+  uint64_t res;
+  int scale;
+  int neg;
+  int len = 0;
+  int point;
+  int out_point;
+  int out_len;
+  int out;
+  int n;
+
+  memcpy(&bits, &val, sizeof(bits));
+  neg = (int)(bits >> 63);
+
+  if (((bits >> 52) & 0x7ff) == 0x7ff) {
+    if (!(bits << 12))
+      return copy_text(buf, neg ? "-1e999" : "1e999");
+    if (reads_back("-0e999", 6, val))
+      return copy_text(buf, "-0e999");
+    return copy_text(buf, "0e999");
+  }
+  if ((bits << 1) == 0)
+    return copy_text(buf, neg ? "-0" : "0");
+
+  /* any decimal of up to 15 digits survives a trip through a double, so
+     values typed in by hand come back as typed */
+  for (n = 15; n <= 17; n++) {
+    if (!fast_round(val, n, &res, &scale))
+      break;
+    out = try_rounded(buf, neg, res, scale, val);
+    if (out)
+      return out;
+  }
+
+  if (n > 17) {
+    /* 17 digits only fail where fp_strtod rounds twice, which a
+       neighbouring last digit sometimes makes up for */
+    for (n = 0; n < 8; n++) {
+      out = try_rounded(buf, neg, res + nudges[n], scale, val);
+      if (out)
+        return out;
+    }
+    point = u64_digits(res, digits) - scale;
+  } else {
+    len = exact_digits(val, all, &point);
+    for (n = 15; n <= 17; n++) {
+      out_point = point;
+      out_len = round_digits(digits, all, len, n, &out_point);
+      out = layout(buf, neg, digits, out_len, out_point);
+      if (reads_back(buf, out, val))
+        return out;
+      if (len <= n)
+        break;
+    }
+  }
+
+  /* the digits are right but the parser's rounding is not */
+  out = integer_form(buf, neg, val, point);
+  if (out)
+    return out;
+
+  /* no text reads back as val; the nearest 17 digits are the best there is */
+  if (fast_round(val, 17, &res, &scale))
+    return layout_rounded(buf, neg, res, scale);
+  out_point = point;
+  out_len = round_digits(digits, all, len, 17, &out_point);
+  return layout(buf, neg, digits, out_len, out_point);
+}
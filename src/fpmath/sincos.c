@@ -24,17 +24,31 @@ static double c11 = 3.798187816439979e-12;
 static double c12 = 0.09817477042088285;
 static double c13 = 1.2639164054974691e-22;
 
-static double fp_sincos(double x, int off) {
-  double x0, x1, x2, x3, x4, x5, x6, x7;
-  double x0h, x1h, x2h, x5h, x6h;
+/*
+ * The argument reduction and the polynomial do not depend on the table
+ * entry, so they are computed once and shared between sin and cos.  The
+ * operation order is unchanged from the single-output routine, so results
+ * are bit-identical to calling fp_sin and fp_cos separately.
+ */
+struct sincos_red {
   int idx;
-  double *ptr;
+  double r;
+  double e;
+  double r2;
+  double r2h;
+  double p;
+  double ph;
+};
+
+static void fp_sincos_reduce(double x, struct sincos_red *red) {
+  double x0, x1, x2, x3, x4, x5, x6;
+  double x0h, x1h, x2h, x5h, x6h;
 
   x0 = x;
   x1 = c8;
   x1 *= x0;
   x2 = c9;
-  idx = rint(x1);
+  red->idx = rint(x1);
   x1 += x2;
   x3 = c12;
   x1 -= x2;
@@ -42,18 +56,14 @@ static double fp_sincos(double x, int off) {
   x2h = c11;
   x3 *= x1;
   x1h = x1;
-  idx += off;
   x4 = x0;
-  idx &= 0x3f;
   x5 = c6;
   x5h = c7;
-  ptr = &tab.d[idx << 2];
   x2 *= x1;
   x2h *= x1h;
   x0 -= x3;
   x1 *= c13;
   x4 -= x3;
-  x7 = ptr[1];
   x0h = x0;
   x3 = x4;
   x4 -= x2;
@@ -63,45 +73,64 @@ static double fp_sincos(double x, int off) {
   x0h -= x2h;
   x6 = c2;
   x6h = c3;
-  x7 *= x4;
   x3 -= x4;
   x5 *= x0;
   x5h *= x0h;
   x0 *= x0;
   x0h *= x0h;
   x3 -= x2;
-  x2 = ptr[0];
-  x2h = ptr[1];
   x1 -= x3;
-  x3 = ptr[3];
-  x2 += x3;
-  x7 -= x2;
-  x2 *= x4;
+  red->r = x4;
+  red->e = x1;
+  red->r2 = x0;
+  red->r2h = x0h;
   x6 *= x0;
   x6h *= x0h;
-  x3 *= x4;
-  x2 *= x0;
-  x2h *= x0h;
   x0 *= x0;
   x0h *= x0h;
   x5 += c4;
   x5h += c5;
-  x4 *= ptr[0];
   x6 += c0;
   x6h += c1;
   x5 *= x0;
   x5h *= x0h;
+  x6 += x5;
+  x6h += x5h;
+  red->p = x6;
+  red->ph = x6h;
+}
+
+static double fp_sincos_eval(const struct sincos_red *red, int off) {
+  double x0, x1, x2, x3, x4, x5, x6, x7;
+  double x2h, x6h;
+  double *ptr;
+
+  ptr = &tab.d[((red->idx + off) & 0x3f) << 2];
+  x4 = red->r;
+  x7 = ptr[1];
+  x7 *= x4;
+  x2 = ptr[0];
+  x2h = ptr[1];
+  x3 = ptr[3];
+  x2 += x3;
+  x7 -= x2;
+  x2 *= x4;
+  x3 *= x4;
+  x2 *= red->r2;
+  x2h *= red->r2h;
+  x4 *= ptr[0];
   x0 = x3;
   x3 += ptr[1];
+  x1 = red->e;
   x1 *= x7;
   x7 = x4;
   x4 += x3;
-  x6 += x5;
-  x6h += x5h;
   x5 = ptr[1];
   x5 -= x3;
   x3 -= x4;
   x1 += ptr[2];
+  x6 = red->p;
+  x6h = red->ph;
   x6 *= x2;
   x6h *= x2h;
   x5 += x0;
@@ -116,9 +145,27 @@ static double fp_sincos(double x, int off) {
   return x0;
 }
 
-double fp_sin(double x) { return fp_sincos(x, 0); }
+double fp_sin(double x) {
+  struct sincos_red red;
+
+  fp_sincos_reduce(x, &red);
+  return fp_sincos_eval(&red, 0);
+}
+
+double fp_cos(double x) {
+  struct sincos_red red;
+
+  fp_sincos_reduce(x, &red);
+  return fp_sincos_eval(&red, 0x10);
+}
 
-double fp_cos(double x) { return fp_sincos(x, 0x10); }
+void fp_sincos(double x, double *s, double *c) {
+  struct sincos_red red;
+
+  fp_sincos_reduce(x, &red);
+  *s = fp_sincos_eval(&red, 0);
+  *c = fp_sincos_eval(&red, 0x10);
+}
 
 static union tab_t tab = {
     .x = {
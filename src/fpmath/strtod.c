@@ -131,7 +131,7 @@ static int strtoi(const char *str, int len, int *res) {
   return 0;
 }
 
-int fp_strtod(const char *str, int len, double *res) {
+int fp_strtod_reference(const char *str, int len, double *res) {
   struct bignum bignum;
   int is_neg = 0;
   int num_len;
@@ -196,3 +196,75 @@ int fp_strtod(const char *str, int len, double *res) {
 
   return 0;
 }
+
+/* powers of ten a double holds exactly */
+static const double exact_pow10[23] = {
+    1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22,
+};
+
+/*
+ * The numbers in designs have at most 17 digits and small exponents. With at
+ * most 19 digits the digits fit a uint64_t, whose conversion to double
+ * rounds to nearest even just as bignum_to_double does, and with a power of
+ * ten up to 1e22 the scaling is exact, so the reference's single multiply or
+ * divide gets the same operands and gives the same result. Returns 0 for
+ * anything else, including the malformed text the reference tolerates.
+ */
+static int strtod_fast(const char *str, int len, double *res) {
+  uint64_t digits = 0;
+  int num_digits = 0;
+  int num_digits_after_decimal = 0;
+  int exp = 0;
+  int exp_digits = 0;
+  int exp_neg = 0;
+  int is_neg = 0;
+  int scale;
+  int i = 0;
+
+  if (str[i] == '-' || str[i] == '+')
+    is_neg = str[i++] == '-';
+
+  for (; i < len && is_digit(str[i]); i++, num_digits++)
+    digits = digits * 10 + (str[i] - '0');
+  if (i < len && str[i] == '.') {
+    for (i++; i < len && is_digit(str[i]); i++, num_digits++) {
+      digits = digits * 10 + (str[i] - '0');
+      num_digits_after_decimal++;
+    }
+  }
+  if (num_digits == 0 || num_digits > 19)
+    return 0;
+
+  if (i < len && (str[i] == 'e' || str[i] == 'E')) {
+    i++;
+    if (i < len && (str[i] == '-' || str[i] == '+'))
+      exp_neg = str[i++] == '-';
+    for (; i < len && is_digit(str[i]) && exp_digits < 4; i++, exp_digits++)
+      exp = exp * 10 + (str[i] - '0');
+    if (exp_digits == 0)
+      return 0;
+  }
+  if (i != len)
+    return 0;
+
+  scale = num_digits_after_decimal - (exp_neg ? -exp : exp);
+  if (scale < -22 || scale > 22)
+    return 0;
+
+  if (scale < 0)
+    *res = (double)digits * exact_pow10[-scale];
+  else
+    *res = (double)digits / exact_pow10[scale];
+
+  if (is_neg)
+    *res = -*res;
+
+  return 1;
+}
+
+int fp_strtod(const char *str, int len, double *res) {
+  if (len > 0 && strtod_fast(str, len, res))
+    return 0;
+  return fp_strtod_reference(str, len, res);
+}
@@ -6,6 +6,7 @@
 #include <stdbool.h>
 #include <stdint.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "graph.h"
 
@@ -86,17 +87,26 @@ static void get_wheel_shell(struct shell *shell, struct wheel *wheel) {
 }
 
 static void get_rod_shell(struct shell *shell, struct rod *rod) {
-  double x0 = rod->from->x;
-  double y0 = rod->from->y;
-  double x1 = rod->to->x;
-  double y1 = rod->to->y;
+  double key[4] = {rod->from->x, rod->from->y, rod->to->x, rod->to->y};
+  double x0 = key[0];
+  double y0 = key[1];
+  double x1 = key[2];
+  double y1 = key[3];
+
+  // compare bits rather than values so -0.0 and NaN inputs stay exact
+  if (!rod->shell_cached || memcmp(rod->shell_key, key, sizeof(key)) != 0) {
+    memcpy(rod->shell_key, key, sizeof(key));
+    rod->shell_length = distance(x0, y0, x1, y1);
+    rod->shell_angle = fp_atan2(y1 - y0, x1 - x0);
+    rod->shell_cached = true;
+  }
 
   shell->type = SHELL_RECT;
-  shell->rect.w = distance(x0, y0, x1, y1);
+  shell->rect.w = rod->shell_length;
   shell->rect.h = rod->width;
   shell->x = x0 + (x1 - x0) / 2.0;
   shell->y = y0 + (y1 - y0) / 2.0;
-  shell->angle = fp_atan2(y1 - y0, x1 - x0);
+  shell->angle = rod->shell_angle;
 }
 
 void get_shell(struct shell *shell, struct shape *shape) {
@@ -1,5 +1,4 @@
 #include "graph.h"
-#include "arena.h" /* for recalculate_design_checksum */
 #include "xml.h"
 #include <fpmath/fpmath.h>
 #include <math.h>
@@ -340,19 +339,52 @@ int get_block_joints(struct block *block, struct joint **res) {
   }
 }
 
-static struct block *find_block(struct block_list *blocks, int id) {
-  struct block *block;
+/*
+ * id -> block index used while converting, so resolving jointedTo references
+ * does not rescan the block list. Like the scan it replaces, a lookup returns
+ * the first block added with that id, and only blocks added so far.
+ */
+struct block_index {
+  struct block **slots;
+  unsigned int mask;
+};
+
+static void block_index_init(struct block_index *index, int count) {
+  unsigned int size = 16;
+
+  while (size < 2 * (unsigned int)count)
+    size *= 2;
+  index->slots = calloc(size, sizeof(*index->slots));
+  index->mask = size - 1;
+}
+
+static unsigned int block_index_slot(struct block_index *index, int id) {
+  return ((unsigned int)id * 2654435761u) & index->mask;
+}
+
+static void block_index_add(struct block_index *index, struct block *block) {
+  unsigned int i = block_index_slot(index, block->uid);
+
+  for (; index->slots[i]; i = (i + 1) & index->mask) {
+    if (index->slots[i]->uid == block->uid)
+      return;
+  }
+  index->slots[i] = block;
+}
+
+static struct block *find_block(struct block_index *index, int id) {
+  unsigned int i = block_index_slot(index, id);
 
-  for (block = blocks->head; block; block = block->next) {
-    if (block->uid == id)
-      return block;
+  for (; index->slots[i]; i = (i + 1) & index->mask) {
+    if (index->slots[i]->uid == id)
+      return index->slots[i];
   }
 
   return NULL;
 }
 
 static void make_joints_list(struct attach_list *list,
-                             struct block_list *blocks,
+                             struct block_index *blocks,
                              struct xml_joint *block_ids) {
   struct block *block;
   struct attach_node *node;
@@ -440,8 +472,27 @@ bool share_block(struct design *design, struct joint *j1, struct joint *j2) {
   return false;
 }
 
-static void add_rod(struct design *design, struct block *block,
-                    struct xml_block *xml_block) {
+/*
+ * Same answer as share_block while converting, without the full block scan:
+ * the blocks using j1 are exactly its generating block plus the blocks on its
+ * attach list.
+ */
+static bool share_block_by_joint(struct joint *j1, struct joint *j2) {
+  struct attach_node *att;
+
+  if (j1->gen && block_has_joint(j1->gen, j2))
+    return true;
+
+  for (att = j1->att.head; att; att = att->next) {
+    if (block_has_joint(att->block, j2))
+      return true;
+  }
+
+  return false;
+}
+
+static void add_rod(struct design *design, struct block_index *index,
+                    struct block *block, struct xml_block *xml_block) {
   struct shape *shape = &block->shape;
   struct attach_list att_list;
   struct joint *j0, *j1;
@@ -451,13 +502,13 @@ static void add_rod(struct design *design, struct block *block,
 
   get_rod_endpoints(xml_block, &x0, &y0, &x1, &y1);
 
-  make_joints_list(&att_list, &design->design_blocks, xml_block->joints);
+  make_joints_list(&att_list, index, xml_block->joints);
   j0 = find_closest_joint(&att_list, x0, y0);
   j1 = find_closest_joint(&att_list, x1, y1);
   destroy_joints_list(&att_list);
 
   if (j0 && j1) {
-    if (j0 == j1 || share_block(design, j0, j1))
+    if (j0 == j1 || share_block_by_joint(j0, j1))
       j1 = NULL;
   }
 
@@ -487,10 +538,11 @@ static void add_rod(struct design *design, struct block *block,
   shape->rod.to = j1;
   shape->rod.to_att = att1;
   shape->rod.width = (xml_block->type == XML_SOLID_ROD ? 8 : 4);
+  shape->rod.shell_cached = false;
 }
 
-static void add_wheel(struct design *design, struct block *block,
-                      struct xml_block *xml_block) {
+static void add_wheel(struct design *design, struct block_index *index,
+                      struct block *block, struct xml_block *xml_block) {
   struct shape *shape = &block->shape;
   struct attach_list att_list;
   struct joint *j0;
@@ -500,7 +552,7 @@ static void add_wheel(struct design *design, struct block *block,
   x0 = xml_block->position.x;
   y0 = xml_block->position.y;
 
-  make_joints_list(&att_list, &design->design_blocks, xml_block->joints);
+  make_joints_list(&att_list, index, xml_block->joints);
   j0 = find_closest_joint(&att_list, x0, y0);
   destroy_joints_list(&att_list);
 
@@ -583,7 +635,7 @@ static void add_level_block(struct design *design,
   append_block(&design->level_blocks, block);
 }
 
-static void add_player_block(struct design *design,
+static void add_player_block(struct design *design, struct block_index *index,
                              struct xml_block *xml_block) {
   struct block *block = malloc(sizeof(*block));
 
@@ -598,13 +650,13 @@ static void add_player_block(struct design *design,
     block->type_id = FCSIM_GOAL_RECT;
     break;
   case XML_SOLID_ROD:
-    add_rod(design, block, xml_block);
+    add_rod(design, index, block, xml_block);
     block->material = &solid_rod_material;
     block->goal = false;
     block->type_id = FCSIM_SOLID_ROD;
     break;
   case XML_HOLLOW_ROD:
-    add_rod(design, block, xml_block);
+    add_rod(design, index, block, xml_block);
     block->material = &water_rod_material;
     block->goal = false;
     block->type_id = FCSIM_ROD;
@@ -612,7 +664,7 @@ static void add_player_block(struct design *design,
   case XML_NO_SPIN_WHEEL:
   case XML_CLOCKWISE_WHEEL:
   case XML_COUNTER_CLOCKWISE_WHEEL:
-    add_wheel(design, block, xml_block);
+    add_wheel(design, index, block, xml_block);
     block->material = &solid_material;
     block->goal = xml_block->goal_block;
     // this covers 6 cases
@@ -628,6 +680,7 @@ static void add_player_block(struct design *design,
   block->in_drag_set = false;
 
   append_block(&design->design_blocks, block);
+  block_index_add(index, block);
 }
 
 void set_area(struct area *area, struct xml_zone *xml_zone, double expand) {
@@ -640,6 +693,8 @@ void set_area(struct area *area, struct xml_zone *xml_zone, double expand) {
 
 void convert_xml(struct xml_level *xml_level, struct design *design) {
   struct xml_block *block;
+  struct block_index index;
+  int count = 0;
 
   init_joint_list(&design->joints);
 
@@ -649,7 +704,11 @@ void convert_xml(struct xml_level *xml_level, struct design *design) {
 
   init_block_list(&design->design_blocks);
   for (block = xml_level->player_blocks; block; block = block->next)
-    add_player_block(design, block);
+    count++;
+  block_index_init(&index, count);
+  for (block = xml_level->player_blocks; block; block = block->next)
+    add_player_block(design, &index, block);
+  free(index.slots);
 
   set_area(&design->build_area, &xml_level->start, 4.0);
   set_area(&design->goal_area, &xml_level->end, 0.0);
@@ -2,6 +2,7 @@
 #define GRAPH_H
 
 #include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
 
 typedef struct b2Body b2Body;
@@ -93,6 +94,14 @@ struct rod {
   struct attach_node *to_att;
   double width; /* cross-section thickness (not length): 4.0 for water rods, 8.0
                    for solid rods */
+  /* get_shell cache. length and angle (sqrt and fp_atan2) are reused while the
+     endpoints are bit-identical to shell_key = {from x, from y, to x, to y}, so
+     no edit path needs to invalidate it. shell_cached must be cleared when
+     the rod is created. */
+  bool shell_cached;
+  double shell_key[4];
+  double shell_length;
+  double shell_angle;
 };
 
 struct wheel {
@@ -243,6 +252,12 @@ struct design {
                           recalculate_design_checksum(); 0 until first
                           recalculation. Shown as base-36 in the debug overlay
                           alongside [OK] (matches expect) or [!] (mismatch). */
+  uint64_t fingerprint; /* full 64-bit hash behind actual_checksum, from
+                           design_fingerprint(); valid along with it */
+  bool checksum_valid;    /* actual_checksum and fingerprint are current as of
+                             checksum_modcount; false (zeroed) for a freshly
+                             converted design */
+  int checksum_modcount;  /* modcount when actual_checksum was last computed */
 };
 
 enum shell_type {
@@ -290,4 +305,79 @@ bool share_block(struct design *design, struct joint *j1, struct joint *j2);
 // deep copy, except all b2body are set to nullptr
 struct design *clean_copy_design(struct design *);
 
+// recalculate checksum; store the value and return it
+// 31-bit checksum, always a positive value
+int recalculate_design_checksum(struct design *design);
+// the full 64-bit hash the checksum is cut from; the same design always gives
+// the same value, so it can key results kept across runs
+uint64_t design_fingerprint(struct design *design);
+
+// bounding box test as the original game does it, with the block at its
+// body's position if it has one
+int block_inside_area(struct block *block, struct area *area);
+bool goal_blocks_inside_goal_area(struct design *design);
+
+/*
+ * Compact snapshot of a design: blocks, joints and attach nodes in one
+ * allocation, linked by index (-1 for none) instead of by pointer. Blocks are
+ * stored level blocks first, each list in order; joints in list order; attach
+ * nodes grouped by joint, each joint's list in order. Nothing inside points
+ * into the allocation, so it can be copied with memcpy and freed at once.
+ */
+struct packed_block {
+  struct shape shape;  /* joint and attach node pointers cleared */
+  int32_t joints[5];   /* in get_block_joints order */
+  int32_t atts[2];     /* rod from_att, to_att; wheel center_att */
+  struct material *material;
+  int uid;
+  uint8_t type_id;
+  bool goal;
+  bool overlap;
+  bool in_drag_set;
+};
+
+struct packed_joint {
+  double x, y;
+  int32_t gen;
+  int32_t att_start;
+  int32_t att_count;
+  bool in_drag_set;
+};
+
+struct packed_attach_node {
+  int32_t block;
+};
+
+struct packed_design {
+  size_t size;          /* bytes, including the arrays that follow */
+  struct design header; /* everything but the lists, which are empty */
+  int level_block_count;
+  int block_count;
+  int joint_count;
+  int attach_count;
+};
+
+static inline struct packed_block *
+packed_design_blocks(struct packed_design *packed) {
+  return (struct packed_block *)(packed + 1);
+}
+
+static inline struct packed_joint *
+packed_design_joints(struct packed_design *packed) {
+  return (struct packed_joint *)(packed_design_blocks(packed) +
+                                 packed->block_count);
+}
+
+static inline struct packed_attach_node *
+packed_design_attach_nodes(struct packed_design *packed) {
+  return (struct packed_attach_node *)(packed_design_joints(packed) +
+                                       packed->joint_count);
+}
+
+struct packed_design *pack_design(struct design *design);
+struct packed_design *clone_packed_design(struct packed_design *packed);
+void free_packed_design(struct packed_design *packed);
+// builds a design with the usual linked nodes; bodies are NULL
+struct design *unpack_design(struct packed_design *packed);
+
 #endif
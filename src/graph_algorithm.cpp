@@ -1,91 +1,296 @@
-#ifdef __wasm__
-#include "stl_mock.h"
-#else
-#include <unordered_map>
-#endif
-#include "stl_compat.h"
 extern "C" {
 #include "graph.h"
+#include <box2d/b2Body.h>
+#include <fpmath/fpmath.h>
+#include <math.h>
 }
 
-#define CLEAN_COPY(dest, src, attribute_name)                                  \
-  (dest).attribute_name = _clean_copy(pointer_map, (src).attribute_name);
-#define CHECK_RETURN(ptr_type, old_obj, new_obj)                               \
-  if (old_obj == nullptr)                                                      \
-    return nullptr;                                                            \
-  if (pointer_map.count(old_obj)) {                                            \
-    return (ptr_type *)pointer_map.at(old_obj);                                \
-  }                                                                            \
-  ptr_type *new_obj = _new<ptr_type>();                                        \
-  pointer_map.insert(std::make_pair<void *, void *>(old_obj, new_obj));
-
-attach_node *_clean_copy(std::unordered_map<void *, void *> &pointer_map,
-                         attach_node *old_obj);
-block *_clean_copy(std::unordered_map<void *, void *> &pointer_map,
-                   block *old_obj);
-joint *_clean_copy(std::unordered_map<void *, void *> &pointer_map,
-                   joint *old_obj);
-design *_clean_copy(std::unordered_map<void *, void *> &pointer_map,
-                    design *old_obj);
-
-attach_node *_clean_copy(std::unordered_map<void *, void *> &pointer_map,
-                         attach_node *old_obj) {
-  CHECK_RETURN(attach_node, old_obj, new_obj);
-  CLEAN_COPY(*new_obj, *old_obj, prev);
-  CLEAN_COPY(*new_obj, *old_obj, next);
-  CLEAN_COPY(*new_obj, *old_obj, block);
-  return new_obj;
-}
-
-block *_clean_copy(std::unordered_map<void *, void *> &pointer_map,
-                   block *old_obj) {
-  CHECK_RETURN(block, old_obj, new_obj);
-  CLEAN_COPY(*new_obj, *old_obj, prev);
-  CLEAN_COPY(*new_obj, *old_obj, next);
-  new_obj->shape = old_obj->shape;
-  new_obj->material = old_obj->material; // intentionally not deep copying
-  new_obj->goal = old_obj->goal;
-  new_obj->overlap = old_obj->overlap;
-  new_obj->in_drag_set = old_obj->in_drag_set;
-  new_obj->uid = old_obj->uid;
-  new_obj->type_id = old_obj->type_id;
-  new_obj->body = nullptr; // intentionally clearing
-  return new_obj;
-}
-
-joint *_clean_copy(std::unordered_map<void *, void *> &pointer_map,
-                   joint *old_obj) {
-  CHECK_RETURN(joint, old_obj, new_obj);
-  CLEAN_COPY(*new_obj, *old_obj, prev);
-  CLEAN_COPY(*new_obj, *old_obj, next);
-  CLEAN_COPY(*new_obj, *old_obj, gen);
-  new_obj->x = old_obj->x;
-  new_obj->y = old_obj->y;
-  CLEAN_COPY(*new_obj, *old_obj, att.head);
-  CLEAN_COPY(*new_obj, *old_obj, att.tail);
-  new_obj->in_drag_set = old_obj->in_drag_set;
-  return new_obj;
-}
-
-design *_clean_copy(std::unordered_map<void *, void *> &pointer_map,
-                    design *old_obj) {
-  CHECK_RETURN(design, old_obj, new_obj);
-  CLEAN_COPY(*new_obj, *old_obj, joints.head);
-  CLEAN_COPY(*new_obj, *old_obj, joints.tail);
-  CLEAN_COPY(*new_obj, *old_obj, level_blocks.head);
-  CLEAN_COPY(*new_obj, *old_obj, level_blocks.tail);
-  CLEAN_COPY(*new_obj, *old_obj, design_blocks.head);
-  CLEAN_COPY(*new_obj, *old_obj, design_blocks.tail);
-  new_obj->build_area = old_obj->build_area;
-  new_obj->goal_area = old_obj->goal_area;
-  new_obj->level_id = old_obj->level_id;
-  new_obj->modcount = old_obj->modcount;
-  new_obj->expect_checksum = old_obj->expect_checksum;
-  new_obj->actual_checksum = old_obj->actual_checksum;
-  return new_obj;
+// The packed form links everything by index, so the copy's shapes point at
+// the copy's joints rather than the original's.
+extern "C" design *clean_copy_design(design *old_design) {
+  packed_design *packed = pack_design(old_design);
+  design *new_design = unpack_design(packed);
+  free_packed_design(packed);
+  return new_design;
 }
 
-extern "C" design *clean_copy_design(design *old_design) {
-  std::unordered_map<void *, void *> pointer_map;
-  return _clean_copy(pointer_map, old_design);
+struct checksum_state_t {
+  uint64_t value = 0;
+  uint64_t joint_uid = 0;
+};
+
+uint64_t _checksum_value_combine(uint64_t x, uint64_t y) {
+  x = x * 0x6a999a34a7c5df1bull + y + 0xd10dbc37a7c9b29bull;
+  x ^= x >> 33;
+  return x;
+}
+
+void _add_value_to_checksum(checksum_state_t &state, uint64_t x) {
+  state.value = _checksum_value_combine(state.value, x);
+}
+
+void _add_value_to_checksum(checksum_state_t &state, double x) {
+  union {
+    double as_double;
+    uint64_t as_uint64;
+  } union_value;
+  union_value.as_double = x;
+  _add_value_to_checksum(state, union_value.as_uint64);
+}
+
+void _add_area_to_checksum(checksum_state_t &state, struct area *area) {
+  _add_value_to_checksum(state, area->x);
+  _add_value_to_checksum(state, area->y);
+  _add_value_to_checksum(state, area->w);
+  _add_value_to_checksum(state, area->h);
+  //_add_value_to_checksum(state, area->expand);
+}
+
+void _add_joint_to_checksum(checksum_state_t &state, struct joint *joint) {
+  if (joint == nullptr) {
+    _add_value_to_checksum(state, (uint64_t)(0));
+    return;
+  }
+  _add_value_to_checksum(state, (uint64_t)(joint->_checksum_uid));
+}
+
+void _assign_joint_uid(checksum_state_t &state, struct joint *joint,
+                       int phase) {
+  if (joint == nullptr) {
+    return;
+  }
+  switch (phase) {
+  case 0: {
+    // set initial id
+    joint->_checksum_uid = ++state.joint_uid;
+    break;
+  }
+  case 1: {
+    // count neighbours
+    if (joint->prev != nullptr) {
+      joint->_checksum_uid = _checksum_value_combine(joint->_checksum_uid, 1);
+      joint->_checksum_uid = _checksum_value_combine(
+          joint->_checksum_uid, joint->prev->_checksum_uid);
+    }
+    if (joint->next != nullptr) {
+      joint->_checksum_uid = _checksum_value_combine(joint->_checksum_uid, 2);
+      joint->_checksum_uid = _checksum_value_combine(
+          joint->_checksum_uid, joint->next->_checksum_uid);
+    }
+    break;
+  }
+  }
+}
+
+void _add_block_to_checksum(checksum_state_t &state, struct block *block,
+                            int phase) {
+  switch (phase) {
+  case 0:
+  case 1: {
+    // joint-only passes
+    switch (block->shape.type) {
+    case shape_type::SHAPE_BOX: {
+      _assign_joint_uid(state, block->shape.box.center, phase);
+      for (int i = 0; i < 4; ++i) {
+        _assign_joint_uid(state, block->shape.box.corners[i], phase);
+      }
+      break;
+    }
+    case shape_type::SHAPE_ROD: {
+      _assign_joint_uid(state, block->shape.rod.from, phase);
+      _assign_joint_uid(state, block->shape.rod.to, phase);
+      break;
+    }
+    case shape_type::SHAPE_WHEEL: {
+      _assign_joint_uid(state, block->shape.wheel.center, phase);
+      for (int i = 0; i < 4; ++i) {
+        _assign_joint_uid(state, block->shape.wheel.spokes[i], phase);
+      }
+      break;
+    }
+    }
+    break;
+  }
+  case 2: {
+    // gather main hash
+    _add_value_to_checksum(state, (uint64_t)(block->type_id));
+    _add_value_to_checksum(state, (uint64_t)(block->shape.type));
+    switch (block->shape.type) {
+    case shape_type::SHAPE_RECT: {
+      _add_value_to_checksum(state, block->shape.rect.x);
+      _add_value_to_checksum(state, block->shape.rect.y);
+      _add_value_to_checksum(state, block->shape.rect.w);
+      _add_value_to_checksum(state, block->shape.rect.h);
+      _add_value_to_checksum(state, block->shape.rect.angle);
+      break;
+    }
+    case shape_type::SHAPE_CIRC: {
+      _add_value_to_checksum(state, block->shape.circ.x);
+      _add_value_to_checksum(state, block->shape.circ.y);
+      _add_value_to_checksum(state, block->shape.circ.radius);
+      break;
+    }
+    case shape_type::SHAPE_BOX: {
+      _add_value_to_checksum(state, block->shape.box.x);
+      _add_value_to_checksum(state, block->shape.box.y);
+      _add_value_to_checksum(state, block->shape.box.w);
+      _add_value_to_checksum(state, block->shape.box.h);
+      _add_value_to_checksum(state, block->shape.box.angle);
+      _add_joint_to_checksum(state, block->shape.box.center);
+      for (int i = 0; i < 4; ++i) {
+        _add_joint_to_checksum(state, block->shape.box.corners[i]);
+      }
+      break;
+    }
+    case shape_type::SHAPE_ROD: {
+      _add_joint_to_checksum(state, block->shape.rod.from);
+      _add_joint_to_checksum(state, block->shape.rod.to);
+      _add_value_to_checksum(state, block->shape.rod.width);
+      break;
+    }
+    case shape_type::SHAPE_WHEEL: {
+      _add_joint_to_checksum(state, block->shape.wheel.center);
+      _add_value_to_checksum(state, block->shape.wheel.radius);
+      _add_value_to_checksum(state, block->shape.wheel.angle);
+      //_add_value_to_checksum(state, (uint64_t)(block->shape.wheel.spin));
+      for (int i = 0; i < 4; ++i) {
+        _add_joint_to_checksum(state, block->shape.wheel.spokes[i]);
+      }
+      break;
+    }
+    }
+    // shell is theoretically redundant, but we add it anyway
+    shell shell_normalized;
+    get_shell(&shell_normalized, &block->shape);
+    _add_value_to_checksum(state, shell_normalized.x);
+    _add_value_to_checksum(state, shell_normalized.y);
+    _add_value_to_checksum(state, shell_normalized.angle);
+    _add_value_to_checksum(state, (uint64_t)(shell_normalized.type));
+    switch (shell_normalized.type) {
+    case SHELL_CIRC: {
+      _add_value_to_checksum(state, shell_normalized.circ.radius);
+      break;
+    }
+    case SHELL_RECT: {
+      _add_value_to_checksum(state, shell_normalized.rect.w);
+      _add_value_to_checksum(state, shell_normalized.rect.h);
+      break;
+    }
+    }
+    break;
+  }
+  }
+}
+
+extern "C" uint64_t design_fingerprint(struct design *design) {
+  // Every block's contribution is chained through the same running hash and
+  // depends on joint uids assigned in global order, so one changed block
+  // changes everything after it. Recompute only when the design changed.
+  if (design->checksum_valid && design->checksum_modcount == design->modcount)
+    return design->fingerprint;
+
+  checksum_state_t state;
+  struct block *block;
+  for (int phase = 0; phase < 3; ++phase) {
+    for (block = design->level_blocks.head; block; block = block->next)
+      _add_block_to_checksum(state, block, phase);
+
+    for (block = design->design_blocks.head; block; block = block->next)
+      _add_block_to_checksum(state, block, phase);
+  }
+  _add_area_to_checksum(state, &design->build_area);
+  _add_area_to_checksum(state, &design->goal_area);
+  int checksum = (int)(state.value & 0x7fffffff);
+  // require not 0
+  if (checksum == 0) {
+    checksum = 1;
+  }
+  design->fingerprint = state.value;
+  design->actual_checksum = checksum;
+  design->checksum_valid = true;
+  design->checksum_modcount = design->modcount;
+  return state.value;
+}
+
+extern "C" int recalculate_design_checksum(struct design *design) {
+  design_fingerprint(design);
+  return design->actual_checksum;
+}
+
+static void get_rect_bb(struct shell *shell, struct area *area) {
+  // replicate truncation weirdness
+  float angle_degrees = shell->angle * 57.295779513082320876763;
+  if (fabs(angle_degrees) >= 32768) {
+    angle_degrees = -32768;
+  } else {
+    // likewise with ftlib, we're not sure enough truncation is a good change
+    // angle_degrees = (int)angle_degrees;
+  }
+  float angle_radians = angle_degrees * 0.017453292519943295769245;
+
+  float sina = fp_sin(angle_radians);
+  float cosa = fp_cos(angle_radians);
+  float wc = shell->rect.w * cosa;
+  float ws = shell->rect.w * sina;
+  float hc = shell->rect.h * cosa;
+  float hs = shell->rect.h * sina;
+
+  area->x = shell->x;
+  area->y = shell->y;
+  area->w = fabs(wc) + fabs(hs);
+  area->h = fabs(ws) + fabs(hc);
+  area->expand = 0;
+}
+
+static void get_circ_bb(struct shell *shell, struct area *area) {
+  area->x = shell->x;
+  area->y = shell->y;
+  area->w = shell->circ.radius * 2;
+  area->h = shell->circ.radius * 2;
+  area->expand = 0;
+}
+
+static void get_block_bb(struct block *block, struct area *area) {
+  struct shell shell;
+
+  get_shell(&shell, &block->shape);
+  if (block->body) {
+    shell.x = block->body->m_position.x;
+    shell.y = block->body->m_position.y;
+    shell.angle = block->body->m_rotation;
+  }
+
+  if (shell.type == SHELL_CIRC)
+    get_circ_bb(&shell, area);
+  else
+    get_rect_bb(&shell, area);
+}
+
+extern "C" int block_inside_area(struct block *block, struct area *area) {
+  struct area bb;
+
+  get_block_bb(block, &bb);
+
+  const double modified_w = area->w + area->expand;
+  const double modified_h = area->h + area->expand;
+
+  return bb.x - bb.w / 2 >= area->x - modified_w / 2 &&
+         bb.x + bb.w / 2 <= area->x + modified_w / 2 &&
+         bb.y - bb.h / 2 >= area->y - modified_h / 2 &&
+         bb.y + bb.h / 2 <= area->y + modified_h / 2;
+}
+
+extern "C" bool goal_blocks_inside_goal_area(struct design *design) {
+  struct block *block;
+  bool any = false;
+
+  for (block = design->design_blocks.head; block; block = block->next) {
+    if (block->goal) {
+      any = true;
+      if (!block_inside_area(block, &design->goal_area))
+        return false;
+    }
+  }
+
+  return any;
 }
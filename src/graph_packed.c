@@ -0,0 +1,341 @@
+#include "graph.h"
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*
+ * pointer -> index map used while packing, open addressing over a power of
+ * two table. Keys are node pointers, so NULL marks an empty slot.
+ */
+struct ptr_index {
+  const void **keys;
+  int32_t *values;
+  unsigned int mask;
+};
+
+static void ptr_index_init(struct ptr_index *index, int count) {
+  unsigned int size = 16;
+
+  while (size < 2 * (unsigned int)count)
+    size *= 2;
+  index->keys = calloc(size, sizeof(*index->keys));
+  index->values = malloc(size * sizeof(*index->values));
+  index->mask = size - 1;
+}
+
+static void ptr_index_free(struct ptr_index *index) {
+  free(index->keys);
+  free(index->values);
+}
+
+static unsigned int ptr_index_slot(struct ptr_index *index, const void *key) {
+  uintptr_t k = (uintptr_t)key;
+
+  return (unsigned int)((k >> 4) ^ (k >> 20)) * 2654435761u & index->mask;
+}
+
+static void ptr_index_add(struct ptr_index *index, const void *key,
+                          int32_t value) {
+  unsigned int i = ptr_index_slot(index, key);
+
+  for (; index->keys[i]; i = (i + 1) & index->mask) {
+    if (index->keys[i] == key)
+      return;
+  }
+  index->keys[i] = key;
+  index->values[i] = value;
+}
+
+static int32_t ptr_index_find(struct ptr_index *index, const void *key) {
+  unsigned int i;
+
+  if (!key)
+    return -1;
+
+  i = ptr_index_slot(index, key);
+  for (; index->keys[i]; i = (i + 1) & index->mask) {
+    if (index->keys[i] == key)
+      return index->values[i];
+  }
+
+  return -1;
+}
+
+static int count_blocks(struct block_list *list) {
+  struct block *block;
+  int n = 0;
+
+  for (block = list->head; block; block = block->next)
+    n++;
+
+  return n;
+}
+
+static size_t packed_size(int block_count, int joint_count, int attach_count) {
+  return sizeof(struct packed_design) +
+         block_count * sizeof(struct packed_block) +
+         joint_count * sizeof(struct packed_joint) +
+         attach_count * sizeof(struct packed_attach_node);
+}
+
+/* the attach node fields a shape holds, in a fixed order */
+static int get_block_atts(struct block *block, struct attach_node **res) {
+  struct shape *shape = &block->shape;
+
+  switch (shape->type) {
+  case SHAPE_ROD:
+    res[0] = shape->rod.from_att;
+    res[1] = shape->rod.to_att;
+    return 2;
+  case SHAPE_WHEEL:
+    res[0] = shape->wheel.center_att;
+    return 1;
+  default:
+    return 0;
+  }
+}
+
+static void clear_shape_links(struct shape *shape) {
+  int i;
+
+  switch (shape->type) {
+  case SHAPE_BOX:
+    shape->box.center = NULL;
+    for (i = 0; i < 4; i++)
+      shape->box.corners[i] = NULL;
+    break;
+  case SHAPE_ROD:
+    shape->rod.from = NULL;
+    shape->rod.from_att = NULL;
+    shape->rod.to = NULL;
+    shape->rod.to_att = NULL;
+    break;
+  case SHAPE_WHEEL:
+    shape->wheel.center = NULL;
+    shape->wheel.center_att = NULL;
+    for (i = 0; i < 4; i++)
+      shape->wheel.spokes[i] = NULL;
+    break;
+  default:
+    break;
+  }
+}
+
+static void set_shape_links(struct shape *shape, struct joint **joints,
+                            struct attach_node **atts) {
+  int i;
+
+  switch (shape->type) {
+  case SHAPE_BOX:
+    shape->box.center = joints[0];
+    for (i = 0; i < 4; i++)
+      shape->box.corners[i] = joints[i + 1];
+    break;
+  case SHAPE_ROD:
+    shape->rod.from = joints[0];
+    shape->rod.to = joints[1];
+    shape->rod.from_att = atts[0];
+    shape->rod.to_att = atts[1];
+    break;
+  case SHAPE_WHEEL:
+    shape->wheel.center = joints[0];
+    for (i = 0; i < 4; i++)
+      shape->wheel.spokes[i] = joints[i + 1];
+    shape->wheel.center_att = atts[0];
+    break;
+  default:
+    break;
+  }
+}
+
+static void pack_block(struct packed_block *out, struct block *block,
+                       struct ptr_index *joints, struct ptr_index *atts) {
+  struct joint *block_joints[5];
+  struct attach_node *block_atts[2];
+  int n;
+  int i;
+
+  out->shape = block->shape;
+  clear_shape_links(&out->shape);
+
+  n = get_block_joints(block, block_joints);
+  for (i = 0; i < 5; i++)
+    out->joints[i] = i < n ? ptr_index_find(joints, block_joints[i]) : -1;
+
+  n = get_block_atts(block, block_atts);
+  for (i = 0; i < 2; i++)
+    out->atts[i] = i < n ? ptr_index_find(atts, block_atts[i]) : -1;
+
+  out->material = block->material;
+  out->uid = block->uid;
+  out->type_id = block->type_id;
+  out->goal = block->goal;
+  out->overlap = block->overlap;
+  out->in_drag_set = block->in_drag_set;
+}
+
+struct packed_design *pack_design(struct design *design) {
+  struct packed_design *packed;
+  struct packed_block *blocks;
+  struct packed_joint *joints;
+  struct packed_attach_node *atts;
+  struct ptr_index block_index;
+  struct ptr_index joint_index;
+  struct ptr_index att_index;
+  struct block *block;
+  struct joint *joint;
+  struct attach_node *node;
+  int level_count = count_blocks(&design->level_blocks);
+  int block_count = level_count + count_blocks(&design->design_blocks);
+  int joint_count = 0;
+  int att_count = 0;
+  int i;
+
+  for (joint = design->joints.head; joint; joint = joint->next) {
+    joint_count++;
+    for (node = joint->att.head; node; node = node->next)
+      att_count++;
+  }
+
+  packed = malloc(packed_size(block_count, joint_count, att_count));
+  packed->size = packed_size(block_count, joint_count, att_count);
+  packed->header = *design;
+  memset(&packed->header.joints, 0, sizeof(packed->header.joints));
+  memset(&packed->header.level_blocks, 0, sizeof(packed->header.level_blocks));
+  memset(&packed->header.design_blocks, 0,
+         sizeof(packed->header.design_blocks));
+  packed->level_block_count = level_count;
+  packed->block_count = block_count;
+  packed->joint_count = joint_count;
+  packed->attach_count = att_count;
+
+  blocks = packed_design_blocks(packed);
+  joints = packed_design_joints(packed);
+  atts = packed_design_attach_nodes(packed);
+
+  ptr_index_init(&block_index, block_count);
+  ptr_index_init(&joint_index, joint_count);
+  ptr_index_init(&att_index, att_count);
+
+  i = 0;
+  for (block = design->level_blocks.head; block; block = block->next)
+    ptr_index_add(&block_index, block, i++);
+  for (block = design->design_blocks.head; block; block = block->next)
+    ptr_index_add(&block_index, block, i++);
+
+  i = 0;
+  att_count = 0;
+  for (joint = design->joints.head; joint; joint = joint->next, i++) {
+    ptr_index_add(&joint_index, joint, i);
+    joints[i].x = joint->x;
+    joints[i].y = joint->y;
+    joints[i].gen = ptr_index_find(&block_index, joint->gen);
+    joints[i].att_start = att_count;
+    joints[i].in_drag_set = joint->in_drag_set;
+    for (node = joint->att.head; node; node = node->next) {
+      ptr_index_add(&att_index, node, att_count);
+      atts[att_count++].block = ptr_index_find(&block_index, node->block);
+    }
+    joints[i].att_count = att_count - joints[i].att_start;
+  }
+
+  i = 0;
+  for (block = design->level_blocks.head; block; block = block->next)
+    pack_block(&blocks[i++], block, &joint_index, &att_index);
+  for (block = design->design_blocks.head; block; block = block->next)
+    pack_block(&blocks[i++], block, &joint_index, &att_index);
+
+  ptr_index_free(&block_index);
+  ptr_index_free(&joint_index);
+  ptr_index_free(&att_index);
+
+  return packed;
+}
+
+struct packed_design *clone_packed_design(struct packed_design *packed) {
+  struct packed_design *clone = malloc(packed->size);
+
+  memcpy(clone, packed, packed->size);
+
+  return clone;
+}
+
+void free_packed_design(struct packed_design *packed) { free(packed); }
+
+struct design *unpack_design(struct packed_design *packed) {
+  struct design *design = malloc(sizeof(*design));
+  struct packed_block *blocks = packed_design_blocks(packed);
+  struct packed_joint *joints = packed_design_joints(packed);
+  struct packed_attach_node *atts = packed_design_attach_nodes(packed);
+  struct block **block_ptrs;
+  struct joint **joint_ptrs;
+  struct attach_node **att_ptrs;
+  struct joint *block_joints[5];
+  struct attach_node *block_atts[2];
+  int i;
+  int k;
+
+  *design = packed->header;
+
+  /* every node is created before any links are resolved */
+  block_ptrs = malloc((packed->block_count + 1) * sizeof(*block_ptrs));
+  joint_ptrs = malloc((packed->joint_count + 1) * sizeof(*joint_ptrs));
+  att_ptrs = malloc((packed->attach_count + 1) * sizeof(*att_ptrs));
+
+  for (i = 0; i < packed->block_count; i++) {
+    struct block *block = malloc(sizeof(*block));
+
+    block->prev = NULL;
+    block->next = NULL;
+    block->shape = blocks[i].shape;
+    block->material = blocks[i].material;
+    block->goal = blocks[i].goal;
+    block->overlap = blocks[i].overlap;
+    block->in_drag_set = blocks[i].in_drag_set;
+    block->uid = blocks[i].uid;
+    block->type_id = blocks[i].type_id;
+    block->body = NULL;
+    if (i < packed->level_block_count)
+      append_block(&design->level_blocks, block);
+    else
+      append_block(&design->design_blocks, block);
+    block_ptrs[i] = block;
+  }
+
+  for (i = 0; i < packed->attach_count; i++) {
+    int32_t b = atts[i].block;
+
+    att_ptrs[i] = new_attach_node(b < 0 ? NULL : block_ptrs[b]);
+  }
+
+  for (i = 0; i < packed->joint_count; i++) {
+    int32_t gen = joints[i].gen;
+    struct joint *joint =
+        new_joint(gen < 0 ? NULL : block_ptrs[gen], joints[i].x, joints[i].y);
+
+    joint->in_drag_set = joints[i].in_drag_set;
+    for (k = 0; k < joints[i].att_count; k++)
+      append_attach_node(&joint->att, att_ptrs[joints[i].att_start + k]);
+    append_joint(&design->joints, joint);
+    joint_ptrs[i] = joint;
+  }
+
+  for (i = 0; i < packed->block_count; i++) {
+    for (k = 0; k < 5; k++) {
+      int32_t j = blocks[i].joints[k];
+      block_joints[k] = j < 0 ? NULL : joint_ptrs[j];
+    }
+    for (k = 0; k < 2; k++) {
+      int32_t a = blocks[i].atts[k];
+      block_atts[k] = a < 0 ? NULL : att_ptrs[a];
+    }
+    set_shape_links(&block_ptrs[i]->shape, block_joints, block_atts);
+  }
+
+  free(block_ptrs);
+  free(joint_ptrs);
+  free(att_ptrs);
+
+  return design;
+}
@@ -11,6 +11,15 @@ void clear_interval(int id);
 
 double time_precise_ms();
 
+// Calls func(arg) over and over on a background thread. Whenever it returns 0
+// the thread sleeps until the next wake_workers call. Returns 0 on success, or
+// -1 if the platform has no background threads.
+int start_worker(int (*func)(void *arg), void *arg);
+
+// Wakes every idle worker, which then calls its func again. Call it after
+// handing a worker new work.
+void wake_workers(void);
+
 #ifdef __cplusplus
 }
 #endif
@@ -6,6 +6,7 @@ extern "C" {
 #include <X11/Xlib.h>
 #include <pthread.h>
 #include <stdlib.h>
+#include <time.h>
 
 void key_down(int key);
 void key_up(int key);
@@ -15,6 +16,7 @@ void button_up(int button);
 void scroll(int delta);
 void resize(int w, int h);
 void init(char *xml, int len, int expect_checksum);
+void publish(void);
 void draw(void);
 
 void process_events(Display *dpy, Window win) {
@@ -130,6 +132,56 @@ int set_interval(void (*func)(void *arg), int delay, void *arg) {
 
 void clear_interval(int i) { slots[i].func = NULL; }
 
+struct worker {
+  int (*func)(void *arg);
+  void *arg;
+};
+
+pthread_mutex_t worker_mutex = PTHREAD_MUTEX_INITIALIZER;
+pthread_cond_t worker_cond = PTHREAD_COND_INITIALIZER;
+unsigned worker_wakeups;
+
+void *worker_func(void *arg) {
+  struct worker *worker = (struct worker *)arg;
+  unsigned seen;
+
+  while (1) {
+    pthread_mutex_lock(&worker_mutex);
+    seen = worker_wakeups;
+    pthread_mutex_unlock(&worker_mutex);
+    if (worker->func(worker->arg))
+      continue;
+    // idle: sleep until the next wake_workers, unless one came during func
+    pthread_mutex_lock(&worker_mutex);
+    while (worker_wakeups == seen)
+      pthread_cond_wait(&worker_cond, &worker_mutex);
+    pthread_mutex_unlock(&worker_mutex);
+  }
+}
+
+void wake_workers(void) {
+  pthread_mutex_lock(&worker_mutex);
+  worker_wakeups++;
+  pthread_cond_broadcast(&worker_cond);
+  pthread_mutex_unlock(&worker_mutex);
+}
+
+int start_worker(int (*func)(void *arg), void *arg) {
+  struct worker *worker;
+  pthread_t thread;
+
+  worker = (struct worker *)malloc(sizeof(*worker));
+  worker->func = func;
+  worker->arg = arg;
+  if (pthread_create(&thread, NULL, worker_func, worker)) {
+    free(worker);
+    return -1;
+  }
+  pthread_detach(thread);
+
+  return 0;
+}
+
 } // extern "C"
 
 int main(void) {
@@ -173,15 +225,17 @@ int main(void) {
   init(poocs_xml, sizeof(poocs_xml), 0);
 
   while (1) {
-    pthread_mutex_lock(&mutex);
+    /* the simulation publishes what draw() needs after every batch of ticks,
+     * so drawing does not hold the mutex */
     draw();
-    pthread_mutex_unlock(&mutex);
 
     glFinish();
     glXSwapBuffers(dpy, win);
 
+    /* editing is still serialised with the simulation */
     pthread_mutex_lock(&mutex);
     process_events(dpy, win);
+    publish();
     pthread_mutex_unlock(&mutex);
   }
 }
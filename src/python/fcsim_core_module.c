@@ -0,0 +1,608 @@
+/*
+ * Python bindings for libfcsim_core, so designs can be simulated in process.
+ *
+ *   Design(data)              XML or binary design; ValueError if it does not
+ *                             parse
+ *   load_ftlib(text)          (Design, max_ticks) from run_single_design's
+ *                             input format
+ *   World(design)             a world at tick 0
+ *     .step(ticks=1)          steps, returns the tick
+ *     .run(max_ticks)         steps to the solve or max_ticks, returns the
+ *                             solve tick (-1 if unsolved)
+ *     .snapshot()             BodyStates of shape (blocks, 6)
+ *     .record(ticks)          steps, returning BodyStates of shape
+ *                             (ticks, blocks, 6): the state after each tick
+ *   evaluate_many(designs, max_ticks, threads=0)
+ *                             [(solve_tick, end_tick)] for each design, run
+ *                             on a pool of threads without the GIL
+ *
+ * BodyStates exports its memory through the buffer protocol as C-contiguous
+ * doubles (x, y, angle, vx, vy, angular velocity per block), so
+ * numpy.asarray or memoryview use it without a copy.
+ */
+
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+
+#include <fcsim_core/fcsim_core.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+/* BodyStates */
+
+typedef struct {
+  PyObject_HEAD double *data;
+  int ndim;
+  Py_ssize_t shape[3];
+  Py_ssize_t strides[3];
+} BodyStatesObject;
+
+static PyTypeObject BodyStatesType;
+
+/* a zeroed array of count * blocks body states, of shape (count, blocks, 6),
+ * or (blocks, 6) with count -1 */
+static BodyStatesObject *body_states_new(Py_ssize_t count, Py_ssize_t blocks) {
+  BodyStatesObject *self;
+  Py_ssize_t rows = count < 0 ? 1 : count;
+  int i;
+
+  if (blocks > 0 && rows > PY_SSIZE_T_MAX / (Py_ssize_t)sizeof(double) /
+                              FCSIM_BODY_STATE_FIELDS / blocks)
+    return (BodyStatesObject *)PyErr_NoMemory();
+
+  self = PyObject_New(BodyStatesObject, &BodyStatesType);
+  if (!self)
+    return NULL;
+  self->data = calloc(rows * blocks * FCSIM_BODY_STATE_FIELDS + 1,
+                      sizeof(double));
+  if (!self->data) {
+    Py_DECREF(self);
+    return (BodyStatesObject *)PyErr_NoMemory();
+  }
+
+  self->ndim = 0;
+  if (count >= 0)
+    self->shape[self->ndim++] = count;
+  self->shape[self->ndim++] = blocks;
+  self->shape[self->ndim++] = FCSIM_BODY_STATE_FIELDS;
+  self->strides[self->ndim - 1] = sizeof(double);
+  for (i = self->ndim - 2; i >= 0; i--)
+    self->strides[i] = self->strides[i + 1] * self->shape[i + 1];
+
+  return self;
+}
+
+static void body_states_dealloc(BodyStatesObject *self) {
+  free(self->data);
+  PyObject_Free(self);
+}
+
+static int body_states_getbuffer(BodyStatesObject *self, Py_buffer *view,
+                                 int flags) {
+  int i;
+
+  view->buf = self->data;
+  view->obj = (PyObject *)self;
+  Py_INCREF(self);
+  view->itemsize = sizeof(double);
+  view->len = sizeof(double);
+  for (i = 0; i < self->ndim; i++)
+    view->len *= self->shape[i];
+  view->readonly = 0;
+  view->format = flags & PyBUF_FORMAT ? "d" : NULL;
+  /* C-contiguous, so it satisfies any request */
+  view->ndim = self->ndim;
+  view->shape = flags & PyBUF_ND ? self->shape : NULL;
+  view->strides =
+      (flags & PyBUF_STRIDES) == PyBUF_STRIDES ? self->strides : NULL;
+  view->suboffsets = NULL;
+  view->internal = NULL;
+
+  return 0;
+}
+
+static PyObject *body_states_shape(BodyStatesObject *self, void *closure) {
+  PyObject *shape = PyTuple_New(self->ndim);
+  int i;
+
+  for (i = 0; shape && i < self->ndim; i++)
+    PyTuple_SET_ITEM(shape, i, PyLong_FromSsize_t(self->shape[i]));
+
+  return shape;
+}
+
+static Py_ssize_t body_states_len(BodyStatesObject *self) {
+  return self->shape[0];
+}
+
+static PyBufferProcs body_states_as_buffer = {
+    .bf_getbuffer = (getbufferproc)body_states_getbuffer,
+};
+
+static PySequenceMethods body_states_as_sequence = {
+    .sq_length = (lenfunc)body_states_len,
+};
+
+static PyGetSetDef body_states_getset[] = {
+    {"shape", (getter)body_states_shape, NULL, "dimensions of the array"},
+    {NULL},
+};
+
+static PyTypeObject BodyStatesType = {
+    PyVarObject_HEAD_INIT(NULL, 0).tp_name = "fcsim_core.BodyStates",
+    .tp_basicsize = sizeof(BodyStatesObject),
+    .tp_dealloc = (destructor)body_states_dealloc,
+    .tp_as_sequence = &body_states_as_sequence,
+    .tp_as_buffer = &body_states_as_buffer,
+    .tp_flags = Py_TPFLAGS_DEFAULT,
+    .tp_doc = "Body states as C-contiguous doubles, exported without a copy "
+              "through the buffer protocol.",
+    .tp_getset = body_states_getset,
+};
+
+/* Design */
+
+typedef struct {
+  PyObject_HEAD struct fcsim_design *design;
+} DesignObject;
+
+static PyTypeObject DesignType;
+
+static PyObject *design_wrap(PyTypeObject *type, struct fcsim_design *design) {
+  DesignObject *self;
+
+  if (!design) {
+    PyErr_SetString(PyExc_ValueError, "not a valid design");
+    return NULL;
+  }
+  self = (DesignObject *)type->tp_alloc(type, 0);
+  if (!self) {
+    fcsim_design_free(design);
+    return NULL;
+  }
+  self->design = design;
+
+  return (PyObject *)self;
+}
+
+static PyObject *design_new(PyTypeObject *type, PyObject *args,
+                            PyObject *kwds) {
+  static char *kwlist[] = {"data", NULL};
+  struct fcsim_design *design;
+  Py_buffer data;
+
+  if (!PyArg_ParseTupleAndKeywords(args, kwds, "s*", kwlist, &data))
+    return NULL;
+  Py_BEGIN_ALLOW_THREADS;
+  design = fcsim_design_load(data.buf, data.len);
+  Py_END_ALLOW_THREADS;
+  PyBuffer_Release(&data);
+
+  return design_wrap(type, design);
+}
+
+static void design_dealloc(DesignObject *self) {
+  fcsim_design_free(self->design);
+  Py_TYPE(self)->tp_free((PyObject *)self);
+}
+
+static PyObject *design_fingerprint(DesignObject *self, void *closure) {
+  return PyLong_FromUnsignedLongLong(fcsim_design_fingerprint(self->design));
+}
+
+static PyObject *design_blocks(DesignObject *self, void *closure) {
+  int count = fcsim_design_block_count(self->design);
+  PyObject *blocks = PyList_New(count);
+  struct fcsim_block_info info;
+  int i;
+
+  for (i = 0; blocks && i < count; i++) {
+    PyObject *item;
+
+    fcsim_design_block_info(self->design, i, &info);
+    item = Py_BuildValue("(iiOO)", info.id, info.type,
+                         info.goal ? Py_True : Py_False,
+                         info.level ? Py_True : Py_False);
+    if (!item) {
+      Py_DECREF(blocks);
+      return NULL;
+    }
+    PyList_SET_ITEM(blocks, i, item);
+  }
+
+  return blocks;
+}
+
+static PyGetSetDef design_getset[] = {
+    {"fingerprint", (getter)design_fingerprint, NULL,
+     "64-bit hash, equal for designs that simulate the same"},
+    {"blocks", (getter)design_blocks, NULL,
+     "(id, type, goal, level) of each block, in body state order"},
+    {NULL},
+};
+
+static PyTypeObject DesignType = {
+    PyVarObject_HEAD_INIT(NULL, 0).tp_name = "fcsim_core.Design",
+    .tp_basicsize = sizeof(DesignObject),
+    .tp_dealloc = (destructor)design_dealloc,
+    .tp_flags = Py_TPFLAGS_DEFAULT,
+    .tp_doc = "Design(data)\n\nA loaded XML or binary design. Immutable, so "
+              "it may be shared by worlds on any thread.",
+    .tp_getset = design_getset,
+    .tp_new = design_new,
+};
+
+/* World */
+
+typedef struct {
+  PyObject_HEAD struct fcsim_world *world;
+  PyObject *design; /* keeps the design alive */
+  int block_count;
+  int busy; /* stepping with the GIL released */
+} WorldObject;
+
+static PyObject *world_new(PyTypeObject *type, PyObject *args,
+                           PyObject *kwds) {
+  static char *kwlist[] = {"design", NULL};
+  DesignObject *design;
+  WorldObject *self;
+
+  if (!PyArg_ParseTupleAndKeywords(args, kwds, "O!", kwlist, &DesignType,
+                                   &design))
+    return NULL;
+
+  self = (WorldObject *)type->tp_alloc(type, 0);
+  if (!self)
+    return NULL;
+  Py_INCREF(design);
+  self->design = (PyObject *)design;
+  self->world = fcsim_world_create(design->design);
+  self->block_count = fcsim_design_block_count(design->design);
+  self->busy = 0;
+
+  return (PyObject *)self;
+}
+
+static void world_dealloc(WorldObject *self) {
+  fcsim_world_free(self->world);
+  Py_XDECREF(self->design);
+  Py_TYPE(self)->tp_free((PyObject *)self);
+}
+
+/* Readers hold the GIL throughout, so they only need the world not to be
+ * stepping without it. */
+static int world_check_idle(WorldObject *self) {
+  if (self->busy) {
+    PyErr_SetString(PyExc_RuntimeError, "world is in use by another thread");
+    return -1;
+  }
+  return 0;
+}
+
+/* a world is stepped by one thread at a time */
+static int world_acquire(WorldObject *self) {
+  if (world_check_idle(self))
+    return -1;
+  self->busy = 1;
+  return 0;
+}
+
+static PyObject *world_step(WorldObject *self, PyObject *args,
+                            PyObject *kwds) {
+  static char *kwlist[] = {"ticks", NULL};
+  long long ticks = 1;
+  int64_t tick;
+
+  if (!PyArg_ParseTupleAndKeywords(args, kwds, "|L", kwlist, &ticks) ||
+      world_acquire(self))
+    return NULL;
+  Py_BEGIN_ALLOW_THREADS;
+  tick = fcsim_world_step(self->world, ticks);
+  Py_END_ALLOW_THREADS;
+  self->busy = 0;
+
+  return PyLong_FromLongLong(tick);
+}
+
+static PyObject *world_run(WorldObject *self, PyObject *args,
+                           PyObject *kwds) {
+  static char *kwlist[] = {"max_ticks", NULL};
+  long long max_ticks;
+  int64_t solve_tick;
+
+  if (!PyArg_ParseTupleAndKeywords(args, kwds, "L", kwlist, &max_ticks) ||
+      world_acquire(self))
+    return NULL;
+  Py_BEGIN_ALLOW_THREADS;
+  solve_tick = fcsim_world_run(self->world, max_ticks);
+  Py_END_ALLOW_THREADS;
+  self->busy = 0;
+
+  return PyLong_FromLongLong(solve_tick);
+}
+
+static PyObject *world_snapshot(WorldObject *self, PyObject *unused) {
+  BodyStatesObject *states;
+
+  if (world_check_idle(self))
+    return NULL;
+  states = body_states_new(-1, self->block_count);
+  if (!states)
+    return NULL;
+  fcsim_world_snapshot(self->world, (struct fcsim_body_state *)states->data,
+                       self->block_count);
+
+  return (PyObject *)states;
+}
+
+static PyObject *world_record(WorldObject *self, PyObject *args,
+                              PyObject *kwds) {
+  static char *kwlist[] = {"ticks", NULL};
+  struct fcsim_body_state *out;
+  BodyStatesObject *states;
+  Py_ssize_t ticks;
+  Py_ssize_t t;
+
+  if (!PyArg_ParseTupleAndKeywords(args, kwds, "n", kwlist, &ticks))
+    return NULL;
+  if (ticks < 0) {
+    PyErr_SetString(PyExc_ValueError, "ticks must not be negative");
+    return NULL;
+  }
+  states = body_states_new(ticks, self->block_count);
+  if (!states)
+    return NULL;
+  if (world_acquire(self)) {
+    Py_DECREF(states);
+    return NULL;
+  }
+
+  out = (struct fcsim_body_state *)states->data;
+  Py_BEGIN_ALLOW_THREADS;
+  for (t = 0; t < ticks; t++) {
+    fcsim_world_step(self->world, 1);
+    fcsim_world_snapshot(self->world, out + t * self->block_count,
+                         self->block_count);
+  }
+  Py_END_ALLOW_THREADS;
+  self->busy = 0;
+
+  return (PyObject *)states;
+}
+
+static PyObject *world_tick(WorldObject *self, void *closure) {
+  if (world_check_idle(self))
+    return NULL;
+  return PyLong_FromLongLong(fcsim_world_tick(self->world));
+}
+
+static PyObject *world_solve_tick(WorldObject *self, void *closure) {
+  if (world_check_idle(self))
+    return NULL;
+  return PyLong_FromLongLong(fcsim_world_solve_tick(self->world));
+}
+
+static PyObject *world_goal_reached(WorldObject *self, void *closure) {
+  if (world_check_idle(self))
+    return NULL;
+  return PyBool_FromLong(fcsim_world_goal_reached(self->world));
+}
+
+static PyMethodDef world_methods[] = {
+    {"step", (PyCFunction)(void (*)(void))world_step,
+     METH_VARARGS | METH_KEYWORDS,
+     "step(ticks=1)\n\nSteps the world, returns the tick it is at."},
+    {"run", (PyCFunction)(void (*)(void))world_run,
+     METH_VARARGS | METH_KEYWORDS,
+     "run(max_ticks)\n\nSteps until solved or at max_ticks, returns the solve "
+     "tick (-1 if unsolved)."},
+    {"snapshot", (PyCFunction)world_snapshot, METH_NOARGS,
+     "snapshot()\n\nBodyStates of shape (blocks, 6) for now."},
+    {"record", (PyCFunction)(void (*)(void))world_record,
+     METH_VARARGS | METH_KEYWORDS,
+     "record(ticks)\n\nSteps ticks ticks, returning BodyStates of shape "
+     "(ticks, blocks, 6) holding the state after each."},
+    {NULL},
+};
+
+static PyGetSetDef world_getset[] = {
+    {"tick", (getter)world_tick, NULL, "ticks stepped so far"},
+    {"solve_tick", (getter)world_solve_tick, NULL,
+     "first tick the goal was reached on, -1 if it has not been"},
+    {"goal_reached", (getter)world_goal_reached, NULL,
+     "whether every goal piece is inside the goal area now"},
+    {NULL},
+};
+
+static PyTypeObject WorldType = {
+    PyVarObject_HEAD_INIT(NULL, 0).tp_name = "fcsim_core.World",
+    .tp_basicsize = sizeof(WorldObject),
+    .tp_dealloc = (destructor)world_dealloc,
+    .tp_flags = Py_TPFLAGS_DEFAULT,
+    .tp_doc = "World(design)\n\nA simulation of the design, at tick 0.",
+    .tp_methods = world_methods,
+    .tp_getset = world_getset,
+    .tp_new = world_new,
+};
+
+/* module functions */
+
+static PyObject *load_ftlib(PyObject *module, PyObject *args,
+                            PyObject *kwds) {
+  static char *kwlist[] = {"text", NULL};
+  struct fcsim_design *loaded;
+  int64_t max_ticks = 0;
+  PyObject *design;
+  PyObject *res;
+  Py_buffer text;
+
+  if (!PyArg_ParseTupleAndKeywords(args, kwds, "s*", kwlist, &text))
+    return NULL;
+  loaded = fcsim_design_load_ftlib(text.buf, text.len, &max_ticks);
+  PyBuffer_Release(&text);
+
+  design = design_wrap(&DesignType, loaded);
+  if (!design)
+    return NULL;
+  res = Py_BuildValue("(OL)", design, (long long)max_ticks);
+  Py_DECREF(design);
+
+  return res;
+}
+
+struct batch {
+  struct fcsim_design **designs;
+  int64_t *solve_ticks;
+  int64_t *end_ticks;
+  Py_ssize_t count;
+  Py_ssize_t next; /* next design to take, shared by the workers */
+  int64_t max_ticks;
+};
+
+static void *batch_worker(void *arg) {
+  struct batch *batch = arg;
+  Py_ssize_t i;
+
+  while ((i = __atomic_fetch_add(&batch->next, 1, __ATOMIC_RELAXED)) <
+         batch->count) {
+    struct fcsim_world *world = fcsim_world_create(batch->designs[i]);
+
+    batch->solve_ticks[i] = fcsim_world_run(world, batch->max_ticks);
+    batch->end_ticks[i] = fcsim_world_tick(world);
+    fcsim_world_free(world);
+  }
+
+  return NULL;
+}
+
+static void batch_run(struct batch *batch, int threads) {
+  pthread_t *workers = malloc(threads * sizeof(*workers));
+  int started = 0;
+  int i;
+
+  /* the calling thread is one of the workers */
+  while (workers && started < threads - 1 &&
+         pthread_create(&workers[started], NULL, batch_worker, batch) == 0)
+    started++;
+  batch_worker(batch);
+  for (i = 0; i < started; i++)
+    pthread_join(workers[i], NULL);
+  free(workers);
+}
+
+static PyObject *evaluate_many(PyObject *module, PyObject *args,
+                               PyObject *kwds) {
+  static char *kwlist[] = {"designs", "max_ticks", "threads", NULL};
+  struct batch batch;
+  PyObject *designs;
+  PyObject *seq;
+  PyObject *res = NULL;
+  long long max_ticks;
+  int threads = 0;
+  Py_ssize_t i;
+
+  if (!PyArg_ParseTupleAndKeywords(args, kwds, "OL|i", kwlist, &designs,
+                                   &max_ticks, &threads))
+    return NULL;
+  /* a tuple of our own, not the caller's list: it holds a reference to each
+     design until the workers are done, whatever other threads do to designs
+     while the GIL is released */
+  seq = PySequence_Tuple(designs);
+  if (!seq)
+    return NULL;
+
+  batch.count = PyTuple_GET_SIZE(seq);
+  batch.next = 0;
+  batch.max_ticks = max_ticks;
+  batch.designs = malloc((batch.count + 1) * sizeof(*batch.designs));
+  batch.solve_ticks = malloc((batch.count + 1) * sizeof(int64_t));
+  batch.end_ticks = malloc((batch.count + 1) * sizeof(int64_t));
+  if (!batch.designs || !batch.solve_ticks || !batch.end_ticks) {
+    PyErr_NoMemory();
+    goto done;
+  }
+  for (i = 0; i < batch.count; i++) {
+    PyObject *item = PyTuple_GET_ITEM(seq, i);
+
+    if (!PyObject_TypeCheck(item, &DesignType)) {
+      PyErr_SetString(PyExc_TypeError, "designs must be Design objects");
+      goto done;
+    }
+    batch.designs[i] = ((DesignObject *)item)->design;
+  }
+
+  if (threads <= 0)
+    threads = sysconf(_SC_NPROCESSORS_ONLN);
+  if (threads > batch.count)
+    threads = batch.count;
+  if (threads < 1)
+    threads = 1;
+
+  Py_BEGIN_ALLOW_THREADS;
+  batch_run(&batch, threads);
+  Py_END_ALLOW_THREADS;
+
+  res = PyList_New(batch.count);
+  for (i = 0; res && i < batch.count; i++) {
+    PyObject *item = Py_BuildValue("(LL)", (long long)batch.solve_ticks[i],
+                                   (long long)batch.end_ticks[i]);
+    if (!item) {
+      Py_CLEAR(res);
+      break;
+    }
+    PyList_SET_ITEM(res, i, item);
+  }
+
+done:
+  free(batch.designs);
+  free(batch.solve_ticks);
+  free(batch.end_ticks);
+  Py_DECREF(seq);
+  return res;
+}
+
+static PyMethodDef module_methods[] = {
+    {"load_ftlib", (PyCFunction)(void (*)(void))load_ftlib,
+     METH_VARARGS | METH_KEYWORDS,
+     "load_ftlib(text)\n\n(Design, max_ticks) from run_single_design's input "
+     "format."},
+    {"evaluate_many", (PyCFunction)(void (*)(void))evaluate_many,
+     METH_VARARGS | METH_KEYWORDS,
+     "evaluate_many(designs, max_ticks, threads=0)\n\nRuns each design to "
+     "its solve or max_ticks on a pool of threads (0: one per core) with the "
+     "GIL released. Returns [(solve_tick, end_tick)] in order."},
+    {NULL},
+};
+
+static struct PyModuleDef module_def = {
+    PyModuleDef_HEAD_INIT,
+    .m_name = "fcsim_core",
+    .m_doc = "In-process simulation on libfcsim_core.",
+    .m_size = -1,
+    .m_methods = module_methods,
+};
+
+PyMODINIT_FUNC PyInit_fcsim_core(void) {
+  PyObject *module;
+
+  if (PyType_Ready(&BodyStatesType) || PyType_Ready(&DesignType) ||
+      PyType_Ready(&WorldType))
+    return NULL;
+
+  module = PyModule_Create(&module_def);
+  if (!module)
+    return NULL;
+  Py_INCREF(&BodyStatesType);
+  Py_INCREF(&DesignType);
+  Py_INCREF(&WorldType);
+  if (PyModule_AddObject(module, "BodyStates", (PyObject *)&BodyStatesType) ||
+      PyModule_AddObject(module, "Design", (PyObject *)&DesignType) ||
+      PyModule_AddObject(module, "World", (PyObject *)&WorldType) ||
+      PyModule_AddIntConstant(module, "API_VERSION", FCSIM_CORE_API_VERSION)) {
+    Py_DECREF(module);
+    return NULL;
+  }
+
+  return module;
+}
@@ -0,0 +1,263 @@
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/file.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "result_cache.h"
+
+_Static_assert(sizeof(struct result_cache_header) == 8,
+               "result_cache_header layout is part of the format");
+_Static_assert(sizeof(struct result_cache_record) == 48,
+               "result_cache_record layout is part of the format");
+
+/* open addressing; a slot with check == 0 is empty, real checks never are */
+struct result_cache {
+  int fd; /* -1 if the file could only be opened for reading */
+  uint64_t build_id;
+  struct result_cache_record *slots;
+  size_t cap; /* power of two */
+  size_t count;
+};
+
+static uint64_t mix(uint64_t h, uint64_t x) {
+  h ^= x;
+  h *= 0xbf58476d1ce4e5b9ull;
+  h ^= h >> 31;
+  h *= 0x94d049bb133111ebull;
+  h ^= h >> 29;
+  return h;
+}
+
+uint64_t result_cache_build_id(void) {
+  uint64_t id;
+
+#ifdef FCSIM_BUILD_ID
+  id = FCSIM_BUILD_ID;
+#else
+  const char *stamp = __DATE__ " " __TIME__;
+
+  id = 0xcbf29ce484222325ull;
+  for (; *stamp; stamp++)
+    id = (id ^ (unsigned char)*stamp) * 0x100000001b3ull;
+#endif
+#ifdef USE_FPATAN
+  id = mix(id, 1);
+#endif
+
+  return id;
+}
+
+static uint64_t record_check(const struct result_cache_record *rec) {
+  uint64_t h = 0x6a09e667f3bcc909ull;
+
+  h = mix(h, rec->fingerprint);
+  h = mix(h, (uint64_t)rec->max_ticks);
+  h = mix(h, rec->build_id);
+  h = mix(h, (uint64_t)rec->solve_tick);
+  h = mix(h, (uint64_t)rec->end_tick);
+
+  return h ? h : 1;
+}
+
+static size_t slot_index(struct result_cache *cache, uint64_t fingerprint,
+                         int64_t max_ticks) {
+  return mix(fingerprint, (uint64_t)max_ticks) & (cache->cap - 1);
+}
+
+static struct result_cache_record *find_slot(struct result_cache *cache,
+                                             uint64_t fingerprint,
+                                             int64_t max_ticks) {
+  size_t i = slot_index(cache, fingerprint, max_ticks);
+
+  while (cache->slots[i].check &&
+         (cache->slots[i].fingerprint != fingerprint ||
+          cache->slots[i].max_ticks != max_ticks))
+    i = (i + 1) & (cache->cap - 1);
+
+  return &cache->slots[i];
+}
+
+static void insert(struct result_cache *cache,
+                   const struct result_cache_record *rec) {
+  struct result_cache_record *slot;
+
+  if ((cache->count + 1) * 2 > cache->cap) {
+    struct result_cache_record *old = cache->slots;
+    size_t old_cap = cache->cap;
+    size_t i;
+
+    cache->cap = old_cap * 2;
+    cache->slots = calloc(cache->cap, sizeof(*cache->slots));
+    for (i = 0; i < old_cap; i++) {
+      if (old[i].check)
+        *find_slot(cache, old[i].fingerprint, old[i].max_ticks) = old[i];
+    }
+    free(old);
+  }
+
+  slot = find_slot(cache, rec->fingerprint, rec->max_ticks);
+  if (!slot->check)
+    cache->count++;
+  *slot = *rec;
+}
+
+static int read_all(int fd, char *buf, size_t len) {
+  size_t done = 0;
+
+  while (done < len) {
+    ssize_t n = pread(fd, buf + done, len - done, done);
+
+    if (n <= 0)
+      return -1;
+    done += n;
+  }
+
+  return 0;
+}
+
+/* validates the header and loads every intact record of this build */
+static int load(struct result_cache *cache, const char *buf, size_t len) {
+  struct result_cache_header header;
+  struct result_cache_record rec;
+  size_t off;
+
+  if (len < sizeof(header))
+    return -1;
+  memcpy(&header, buf, sizeof(header));
+  if (memcmp(header.magic, RESULT_CACHE_MAGIC, 4) ||
+      header.version != RESULT_CACHE_VERSION ||
+      header.record_size != sizeof(rec))
+    return -1;
+
+  for (off = sizeof(header); off + sizeof(rec) <= len; off += sizeof(rec)) {
+    memcpy(&rec, buf + off, sizeof(rec));
+    if (rec.build_id == cache->build_id && rec.check == record_check(&rec))
+      insert(cache, &rec);
+  }
+
+  return 0;
+}
+
+/* called with the file locked */
+static int prepare_file(struct result_cache *cache, int fd, int writable) {
+  struct result_cache_header header;
+  struct stat st;
+  size_t tail;
+  char *buf;
+  int res;
+
+  if (fstat(fd, &st))
+    return -1;
+
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, RESULT_CACHE_MAGIC, 4);
+  header.version = RESULT_CACHE_VERSION;
+  header.record_size = sizeof(struct result_cache_record);
+
+  /* a new file, or one whose header write was cut short */
+  if ((size_t)st.st_size < sizeof(header)) {
+    char head[sizeof(header)];
+
+    if (!writable || read_all(fd, head, st.st_size) ||
+        memcmp(head, &header, st.st_size) || ftruncate(fd, 0) ||
+        write(fd, &header, sizeof(header)) != (ssize_t)sizeof(header))
+      return -1;
+    return 0;
+  }
+
+  buf = malloc(st.st_size);
+  res = read_all(fd, buf, st.st_size) || load(cache, buf, st.st_size) ? -1 : 0;
+  free(buf);
+
+  /* cut off a torn last record so the next append starts on a boundary */
+  tail = (st.st_size - sizeof(header)) % sizeof(struct result_cache_record);
+  if (res == 0 && writable && tail)
+    res = ftruncate(fd, st.st_size - tail);
+
+  return res;
+}
+
+struct result_cache *result_cache_open(const char *path) {
+  struct result_cache *cache;
+  int writable = 1;
+  int fd;
+
+  if (!path)
+    return NULL;
+
+  fd = open(path, O_RDWR | O_CREAT | O_APPEND, 0644);
+  if (fd < 0) {
+    writable = 0;
+    fd = open(path, O_RDONLY);
+    if (fd < 0)
+      return NULL;
+  }
+
+  cache = calloc(1, sizeof(*cache));
+  cache->fd = -1;
+  cache->build_id = result_cache_build_id();
+  cache->cap = 64;
+  cache->slots = calloc(cache->cap, sizeof(*cache->slots));
+
+  if (flock(fd, writable ? LOCK_EX : LOCK_SH) ||
+      prepare_file(cache, fd, writable)) {
+    close(fd);
+    result_cache_close(cache);
+    return NULL;
+  }
+  flock(fd, LOCK_UN);
+
+  if (writable)
+    cache->fd = fd;
+  else
+    close(fd);
+
+  return cache;
+}
+
+int result_cache_lookup(struct result_cache *cache, uint64_t fingerprint,
+                        int64_t max_ticks, int64_t *solve_tick,
+                        int64_t *end_tick) {
+  struct result_cache_record *slot =
+      find_slot(cache, fingerprint, max_ticks);
+
+  if (!slot->check)
+    return -1;
+  *solve_tick = slot->solve_tick;
+  *end_tick = slot->end_tick;
+
+  return 0;
+}
+
+int result_cache_store(struct result_cache *cache, uint64_t fingerprint,
+                       int64_t max_ticks, int64_t solve_tick,
+                       int64_t end_tick) {
+  struct result_cache_record rec;
+  ssize_t n;
+
+  rec.fingerprint = fingerprint;
+  rec.max_ticks = max_ticks;
+  rec.build_id = cache->build_id;
+  rec.solve_tick = solve_tick;
+  rec.end_tick = end_tick;
+  rec.check = record_check(&rec);
+  insert(cache, &rec);
+
+  if (cache->fd < 0 || flock(cache->fd, LOCK_EX))
+    return -1;
+  n = write(cache->fd, &rec, sizeof(rec));
+  flock(cache->fd, LOCK_UN);
+
+  return n == (ssize_t)sizeof(rec) ? 0 : -1;
+}
+
+void result_cache_close(struct result_cache *cache) {
+  if (!cache)
+    return;
+  if (cache->fd >= 0)
+    close(cache->fd);
+  free(cache->slots);
+  free(cache);
+}
@@ -0,0 +1,71 @@
+#ifndef RESULT_CACHE_H
+#define RESULT_CACHE_H
+
+#include <stdint.h>
+
+/*
+ * Persistent cache of simulation results for the command line runners, keyed
+ * by design fingerprint (design_fingerprint), max_ticks and build id, so a
+ * design that was already run to the same tick limit by the same simulation
+ * code is answered without simulating it again.
+ *
+ * The file is append-only, little-endian:
+ *
+ *   struct result_cache_header
+ *   struct result_cache_record  [any number]
+ *
+ * Every record carries a hash of its own fields. Records that fail it, records
+ * of other builds and a torn record at the end (from a run that was killed
+ * mid-write) are ignored, so a damaged file costs cache hits, never wrong
+ * results. Several runners may share one file: appends are single writes
+ * under an exclusive flock.
+ */
+
+#define RESULT_CACHE_MAGIC "FCRC"
+#define RESULT_CACHE_VERSION 1
+
+struct result_cache_header {
+  char magic[4];
+  uint16_t version;
+  uint16_t record_size;
+};
+
+struct result_cache_record {
+  uint64_t fingerprint;
+  int64_t max_ticks;
+  uint64_t build_id;
+  int64_t solve_tick; /* -1 if unsolved */
+  int64_t end_tick;
+  uint64_t check; /* hash of the fields above */
+};
+
+struct result_cache;
+
+/*
+ * Identifies the simulation code. SConstruct passes FCSIM_BUILD_ID, a hash of
+ * the sources; a build without it falls back to the compile time, which only
+ * ever costs hits.
+ */
+uint64_t result_cache_build_id(void);
+
+/*
+ * Opens or creates the cache file and loads this build's records. Returns
+ * NULL if path is NULL, or if the file cannot be used (unreadable, or not a
+ * cache file of this version, which is left untouched).
+ */
+struct result_cache *result_cache_open(const char *path);
+
+/* returns 0 and fills in the ticks on a hit, -1 on a miss */
+int result_cache_lookup(struct result_cache *cache, uint64_t fingerprint,
+                        int64_t max_ticks, int64_t *solve_tick,
+                        int64_t *end_tick);
+
+/* records a result in memory and appends it to the file; -1 if the write
+ * failed, in which case it is only remembered for this process */
+int result_cache_store(struct result_cache *cache, uint64_t fingerprint,
+                       int64_t max_ticks, int64_t solve_tick,
+                       int64_t end_tick);
+
+void result_cache_close(struct result_cache *cache);
+
+#endif
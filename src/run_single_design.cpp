@@ -1,52 +1,30 @@
 extern "C" {
 #include "arena.h"
-#include "xml.h"
+#include "design_ftlib.h"
+#include "result_cache.h"
 #include <stdlib.h>
 }
 
 #include "box2d/b2Body.h"
 
 #include <iostream>
-
-// Map ftlib piece types to fcsim types
-static int map_piece_type(int ftlib_type) {
-  // ftlib type mapping from fcsim.h in ftlib
-  // FCSIM_STATIC_RECT = 0, FCSIM_STATIC_CIRC = 1, FCSIM_DYNAMIC_RECT = 2,
-  // FCSIM_DYNAMIC_CIRC = 3, FCSIM_GP_RECT = 4, FCSIM_GP_CIRC = 5, FCSIM_UPW =
-  // 6, FCSIM_CW = 7, FCSIM_CCW = 8, FCSIM_WATER = 9, FCSIM_WOOD = 10
-
-  // From xml.h in fcsim:
-  // XML_STATIC_RECTANGLE = 0, XML_STATIC_CIRCLE = 1, XML_DYNAMIC_RECTANGLE = 2,
-  // XML_DYNAMIC_CIRCLE = 3, XML_JOINTED_DYNAMIC_RECTANGLE = 4,
-  // XML_NO_SPIN_WHEEL = 5, XML_CLOCKWISE_WHEEL = 6, XML_COUNTER_CLOCKWISE_WHEEL
-  // = 7, XML_SOLID_ROD = 8, XML_HOLLOW_ROD = 9
-
-  switch (ftlib_type) {
-  case 0:
-    return 0; // STATIC_RECT -> XML_STATIC_RECTANGLE
-  case 1:
-    return 1; // STATIC_CIRC -> XML_STATIC_CIRCLE
-  case 2:
-    return 2; // DYNAMIC_RECT -> XML_DYNAMIC_RECTANGLE
-  case 3:
-    return 3; // DYNAMIC_CIRC -> XML_DYNAMIC_CIRCLE
-  case 4:
-    return 4; // GP_RECT -> XML_JOINTED_DYNAMIC_RECTANGLE
-  case 5:
-    return 5; // GP_CIRC -> XML_NO_SPIN_WHEEL
-  case 6:
-    return 5; // UPW -> XML_NO_SPIN_WHEEL
-  case 7:
-    return 6; // CW -> XML_CLOCKWISE_WHEEL
-  case 8:
-    return 7; // CCW -> XML_COUNTER_CLOCKWISE_WHEEL
-  case 9:
-    return 9; // WATER -> XML_HOLLOW_ROD
-  case 10:
-    return 8; // WOOD -> XML_SOLID_ROD
-  default:
-    return 2; // Default to dynamic rect
-  }
+#include <iterator>
+#include <string>
+
+// If FCSIM_RESULT_CACHE names a file, a design already run to the same
+// max_ticks is answered from there without simulating. Otherwise the result
+// is stored once main returns, so the run and report stay as they are.
+static result_cache *cache;
+static arena *cached_arena;
+static uint64_t cached_fingerprint;
+static int64_t cached_max_ticks;
+
+static void store_result() {
+  result_cache_store(cache, cached_fingerprint, cached_max_ticks,
+                     cached_arena->has_won ? (int64_t)cached_arena->tick_solve
+                                           : -1,
+                     cached_arena->tick);
+  result_cache_close(cache);
 }
 
 int main(int argc, char *argv[]) {
@@ -57,103 +35,10 @@ int main(int argc, char *argv[]) {
     max_ticks = atoi(argv[1]);
   }
 
-  // Read max_ticks from stdin (first parameter) for ftlib compatibility
-  int stdin_max_ticks;
-  if (!(std::cin >> stdin_max_ticks)) {
-    std::cerr << "Failed to read max_ticks from stdin" << std::endl;
-    return 1;
-  }
-  max_ticks = stdin_max_ticks; // Use stdin value if provided
-
-  // CHIMERA: Parse ftlib format to XIR (ftlib → XIR)
-  struct xml_level level = {0};
-
-  // Read blocks and create linked list
-  int num_blocks;
-  if (!(std::cin >> num_blocks)) {
-    return 1;
-  }
-
-  struct xml_block *prev_level_block = NULL;
-  struct xml_block *prev_player_block = NULL;
-
-  for (int i = 0; i < num_blocks; i++) {
-    int type_id, id;
-    double x, y, w, h, angle;
-    int joint1, joint2;
-
-    if (!(std::cin >> type_id >> id >> x >> y >> w >> h >> angle >> joint1 >>
-          joint2)) {
-      return 1;
-    }
-
-    struct xml_block *block =
-        (struct xml_block *)calloc(1, sizeof(struct xml_block));
-    if (!block) {
-      return 1;
-    }
-
-    block->type = map_piece_type(type_id);
-    block->id = id;
-    block->position.x = x;
-    block->position.y = y;
-
-    if (type_id == 1 || type_id == 3) {
-      block->width = w / 2.0;
-      block->height = h / 2.0;
-    } else {
-      block->width = w;
-      block->height = h;
-    }
-
-    block->rotation = angle;
-    block->goal_block = (type_id == 4 || type_id == 5);
-    block->joints = NULL;
-    block->next = NULL;
-
-    if (joint1 != -1 || joint2 != -1) {
-      if (joint1 != -1) {
-        struct xml_joint *joint =
-            (struct xml_joint *)calloc(1, sizeof(struct xml_joint));
-        joint->id = joint1;
-        block->joints = joint;
-      }
-      if (joint2 != -1) {
-        struct xml_joint *joint =
-            (struct xml_joint *)calloc(1, sizeof(struct xml_joint));
-        joint->id = joint2;
-        joint->next = block->joints;
-        block->joints = joint;
-      }
-    }
-
-    if (type_id <= 3) {
-      if (!level.level_blocks) {
-        level.level_blocks = block;
-      } else {
-        prev_level_block->next = block;
-      }
-      prev_level_block = block;
-    } else {
-      if (!level.player_blocks) {
-        level.player_blocks = block;
-      } else {
-        prev_player_block->next = block;
-      }
-      prev_player_block = block;
-    }
-  }
-
-  // Read build area and goal area
-  if (!(std::cin >> level.start.position.x >> level.start.position.y >>
-        level.start.width >> level.start.height)) {
-    return 1;
-  }
-
-  if (!(std::cin >> level.end.position.x >> level.end.position.y >>
-        level.end.width >> level.end.height)) {
-    return 1;
-  }
+  // Read max_ticks (first parameter, for ftlib compatibility) and the design
+  // from stdin, in the format design_ftlib.h describes
+  std::string text((std::istreambuf_iterator<char>(std::cin)),
+                   std::istreambuf_iterator<char>());
 
   // CHIMERA: Set up arena by inlining arena_init and replacing XML parsing
   arena *arena_ptr = new arena();
@@ -171,24 +56,40 @@ int main(int argc, char *argv[]) {
   arena_ptr->hover_block = NULL;
   arena_move_init(arena_ptr);
   arena_ptr->move_orig_block = NULL;
-  arena_ptr->tick_multiply =
-      1; // required: tick_func inner loop runs i < tick_multiply times
   arena_ptr->single_ticks_remaining = -1; // Default for normal playback
   arena_ptr->autostop_on_solve = false;
   arena_ptr->preview_trail = NULL;
   arena_ptr->ui_buttons = NULL;
 
-  convert_xml(&level, &arena_ptr->design);
-  xml_free(&level);
+  if (design_ftlib_load(text.data(), text.size(), &arena_ptr->design,
+                        &max_ticks)) {
+    std::cerr << "Failed to read the design from stdin" << std::endl;
+    return 1;
+  }
 
   // Continue arena initialization (from arena_init)
   arena_ptr->world = gen_world(&arena_ptr->design);
   arena_ptr->tick = 0;
   arena_ptr->preview_goal_piece_trajectory = false;
-  arena_ptr->preview_design = NULL;
-  arena_ptr->preview_world = NULL;
+  arena_ptr->preview_worker = NULL;
   arena_ptr->preview_has_won = false;
 
+  cache = result_cache_open(getenv("FCSIM_RESULT_CACHE"));
+  if (cache) {
+    int64_t solve_tick;
+    int64_t end_tick;
+
+    cached_fingerprint = design_fingerprint(&arena_ptr->design);
+    if (!result_cache_lookup(cache, cached_fingerprint, max_ticks, &solve_tick,
+                             &end_tick)) {
+      std::cout << solve_tick << std::endl << end_tick << std::endl;
+      return 0;
+    }
+    cached_arena = arena_ptr;
+    cached_max_ticks = max_ticks;
+    atexit(store_result);
+  }
+
   // TO CLAUDE - DO NOT MODIFY ANYTHING BELOW THIS LINE
 
   // Run to solve or end
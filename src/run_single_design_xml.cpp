@@ -1,14 +1,173 @@
 extern "C" {
 #include "arena.h"
 #include "graph.h"
+#include "result_cache.h"
 #include "xml.h"
 }
 
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
 #include <cstdlib>
 #include <cstring>
 #include <iostream>
-#include <string>
-#include <vector>
+
+// Usage: run_single_design_xml [max_ticks] [--stream [file]]
+//
+// Without --stream, runs the one design (XML or binary) on stdin and prints
+// the solve tick (-1 if unsolved) and the end tick on two lines.
+//
+// With --stream, runs every XML document in the file (default stdin) one
+// after another, printing "solve_tick end_tick" per design on one line each.
+// The documents are parsed in place out of the mapped file, or out of the
+// read buffer for a pipe, and their nodes come from one arena reset between
+// designs, so arbitrarily long corpora run in constant memory. A document
+// that does not parse stops the stream with an error, once the bytes from it
+// to the end of input (or MAX_DOCUMENT_BYTES of them) still do not parse.
+//
+// If FCSIM_RESULT_CACHE names a file, results are looked up there by design
+// fingerprint before simulating and stored after, in either mode.
+
+// A mapped file when the input is a regular file, otherwise a buffer read
+// from the pipe that grows to hold at least one whole document.
+struct input {
+  int fd;
+  char *data;
+  size_t len;   // bytes in data
+  size_t start; // first byte not consumed yet
+  size_t cap;
+  bool mapped;
+  bool eof;
+};
+
+static bool open_input(input *in, const char *path) {
+  struct stat st;
+
+  memset(in, 0, sizeof(*in));
+  in->fd = path ? open(path, O_RDONLY) : 0;
+  if (in->fd < 0)
+    return false;
+  if (fstat(in->fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {
+    // private and writable so the parser may take a char *, never written
+    void *mem = mmap(NULL, st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE,
+                     in->fd, 0);
+    if (mem != MAP_FAILED) {
+      in->data = (char *)mem;
+      in->len = st.st_size;
+      in->cap = st.st_size;
+      in->mapped = true;
+      in->eof = true;
+      return true;
+    }
+  }
+  in->cap = 1 << 20;
+  in->data = (char *)malloc(in->cap);
+  return true;
+}
+
+// Moves the unconsumed bytes to the front and reads more after them.
+// Returns false at end of input.
+static bool read_more(input *in) {
+  if (in->eof)
+    return false;
+  if (in->start > 0) {
+    memmove(in->data, in->data + in->start, in->len - in->start);
+    in->len -= in->start;
+    in->start = 0;
+  }
+  if (in->len == in->cap) {
+    in->cap *= 2;
+    in->data = (char *)realloc(in->data, in->cap);
+  }
+  ssize_t n = read(in->fd, in->data + in->len, in->cap - in->len);
+  if (n <= 0) {
+    in->eof = true;
+    return false;
+  }
+  in->len += n;
+  return true;
+}
+
+static bool only_whitespace(const char *p, size_t len) {
+  for (size_t i = 0; i < len; i++) {
+    if (p[i] != ' ' && p[i] != '\t' && p[i] != '\n' && p[i] != '\r')
+      return false;
+  }
+  return true;
+}
+
+// Same ticks as tick_func in the arena, without the arena.
+static void run_level(xml_level *level, int64_t max_ticks,
+                      result_cache *cache) {
+  design *loaded = (design *)calloc(1, sizeof(design));
+  convert_xml(level, loaded);
+
+  uint64_t fingerprint = design_fingerprint(loaded);
+  int64_t tick = 0;
+  int64_t tick_solve = -1;
+  if (!cache ||
+      result_cache_lookup(cache, fingerprint, max_ticks, &tick_solve, &tick)) {
+    b2World *world = gen_world(loaded);
+    while (tick != max_ticks && tick_solve < 0) {
+      step(world);
+      tick++;
+      if (goal_blocks_inside_goal_area(loaded))
+        tick_solve = tick;
+    }
+    free_world(world, loaded);
+    if (cache)
+      result_cache_store(cache, fingerprint, max_ticks, tick_solve, tick);
+  }
+  std::cout << tick_solve << ' ' << tick << '\n';
+
+  free_design(loaded);
+}
+
+// A document that has not parsed by this size is given up on, so one
+// malformed document cannot buffer the rest of a pipe.
+static const size_t MAX_DOCUMENT_BYTES = 256 << 20;
+
+static int run_stream(input *in, int64_t max_ticks, result_cache *cache) {
+  xml_arena nodes;
+  xml_level level;
+  long used;
+
+  xml_arena_init(&nodes);
+  while (true) {
+    char *doc = in->data + in->start;
+    size_t avail = in->len - in->start;
+
+    if (avail > 0 &&
+        xml_parse_next(doc, avail, &used, &level, &nodes) == 0) {
+      in->start += used;
+      run_level(&level, max_ticks, cache);
+      xml_arena_reset(&nodes);
+      continue;
+    }
+    // nothing of a failed attempt is kept
+    xml_arena_reset(&nodes);
+    if (avail >= MAX_DOCUMENT_BYTES)
+      break;
+    // a document cut off by the end of the buffer parses once it is whole;
+    // waiting for twice the bytes before trying again keeps the re-parsing
+    // linear in its length
+    size_t want = avail < 4096 ? 4096 : avail * 2;
+    while (in->len - in->start < want && read_more(in))
+      ;
+    if (in->len - in->start == avail)
+      break;
+  }
+  xml_arena_destroy(&nodes);
+
+  if (!only_whitespace(in->data + in->start, in->len - in->start)) {
+    std::cerr << "run_single_design_xml: bad document at byte " << in->start
+              << std::endl;
+    return 1;
+  }
+  return 0;
+}
 
 int main(int argc, char *argv[]) {
   // Read max_ticks from command line argument
@@ -17,26 +176,56 @@ int main(int argc, char *argv[]) {
     max_ticks = atoi(argv[1]);
   }
 
-  // Read entire stdin into string
-  std::string content(std::istreambuf_iterator<char>(std::cin), {});
-  char *xml = new char[content.length() + 1];
-  strcpy(xml, content.c_str());
+  bool stream = argc > 2 && !strcmp(argv[2], "--stream");
+  input in;
+  if (!open_input(&in, stream && argc > 3 ? argv[3] : NULL)) {
+    std::cerr << "run_single_design_xml: cannot open " << argv[3]
+              << std::endl;
+    return 1;
+  }
+
+  // a cache file that cannot be used only costs the hits
+  const char *cache_path = getenv("FCSIM_RESULT_CACHE");
+  result_cache *cache = result_cache_open(cache_path);
+  if (cache_path && !cache)
+    std::cerr << "run_single_design_xml: not using result cache " << cache_path
+              << std::endl;
+
+  if (stream) {
+    int res = run_stream(&in, max_ticks, cache);
+    result_cache_close(cache);
+    return res;
+  }
+
+  // the whole of stdin is one design; it may also be a binary design, which
+  // can hold zero bytes
+  while (read_more(&in))
+    ;
 
   // Set up arena
   arena *arena_ptr = new arena();
-  arena_init(arena_ptr, 800, 800, xml, content.length());
+  arena_init(arena_ptr, 800, 800, in.data, in.len);
 
-  // Run to solve or end
-  arena_ptr->state = STATE_RUNNING;
-  while ((int64_t)arena_ptr->tick != max_ticks && !arena_ptr->has_won) {
-    arena_ptr->single_ticks_remaining = 1;
-    tick_func(arena_ptr);
+  uint64_t fingerprint = design_fingerprint(&arena_ptr->design);
+  int64_t solve_tick;
+  int64_t end_tick;
+  if (!cache || result_cache_lookup(cache, fingerprint, max_ticks, &solve_tick,
+                                    &end_tick)) {
+    // Run to solve or end
+    arena_ptr->state = STATE_RUNNING;
+    while ((int64_t)arena_ptr->tick != max_ticks && !arena_ptr->has_won) {
+      arena_ptr->single_ticks_remaining = 1;
+      tick_func(arena_ptr);
+    }
+    solve_tick = arena_ptr->has_won ? (int64_t)arena_ptr->tick_solve : -1;
+    end_tick = arena_ptr->tick;
+    if (cache)
+      result_cache_store(cache, fingerprint, max_ticks, solve_tick, end_tick);
   }
+  result_cache_close(cache);
 
   // Report
-  std::cout << (arena_ptr->has_won ? (int64_t)arena_ptr->tick_solve : -1)
-            << std::endl
-            << arena_ptr->tick << std::endl;
+  std::cout << solve_tick << std::endl << end_tick << std::endl;
 
   return 0;
 }
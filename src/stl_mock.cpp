@@ -7,9 +7,9 @@ std::string::string(const std::string &other) {
   _length = other._length;
 }
 
-std::string::string(std::string &&other) {
-  _data = other._data;
+std::string::string(std::string &&other) : _data(std::move(other._data)) {
   _length = other._length;
+  other._length = 0;
 }
 
 std::string::string(const char *other) {
@@ -33,6 +33,13 @@ std::string &std::string::operator=(const std::string &other) {
   return *this;
 }
 
+std::string &std::string::operator=(std::string &&other) {
+  _data = std::move(other._data);
+  _length = other._length;
+  other._length = 0;
+  return *this;
+}
+
 std::string &std::string::operator=(const char *other) {
   _data.clear();
   for (_length = 0; other[_length]; ++_length) {
@@ -12,25 +12,22 @@ void make_str(struct str *str, size_t cap) {
 
 void free_str(struct str *str) { free(str->mem); }
 
-void append_str(struct str *str, char *s) {
-  size_t s_len;
+void append_str(struct str *str, char *s) { append_strn(str, s, strlen(s)); }
+
+void append_strn(struct str *str, const char *s, size_t len) {
   size_t new_len;
   size_t new_cap = str->cap;
-  char *new_mem;
 
-  s_len = strlen(s);
-  new_len = str->len + s_len;
+  new_len = str->len + len;
 
   if (new_cap <= new_len) {
     while (new_cap <= new_len)
       new_cap *= 2;
-    new_mem = static_cast<char *>(malloc(new_cap));
-    memcpy(new_mem, str->mem, str->len);
-    free(str->mem);
-    str->mem = new_mem;
+    str->mem = static_cast<char *>(realloc(str->mem, new_cap));
     str->cap = new_cap;
   }
 
-  memcpy(str->mem + str->len, s, s_len + 1);
+  memcpy(str->mem + str->len, s, len);
+  str->mem[new_len] = 0;
   str->len = new_len;
 }
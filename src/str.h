@@ -17,6 +17,8 @@ void free_str(struct str *str);
 
 void append_str(struct str *str, char *s);
 
+void append_strn(struct str *str, const char *s, size_t len);
+
 #ifdef __cplusplus
 }
 #endif
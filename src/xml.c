@@ -10,6 +10,84 @@ struct slice {
   long len;
 };
 
+/* chunks are kept across resets, so a stream of similar levels stops
+   allocating once the first few are parsed */
+struct xml_arena_chunk {
+  struct xml_arena_chunk *next;
+  size_t size;
+  size_t used;
+};
+
+#define XML_ARENA_CHUNK_SIZE 65536
+
+void xml_arena_init(struct xml_arena *arena) {
+  arena->head = NULL;
+  arena->current = NULL;
+}
+
+void xml_arena_reset(struct xml_arena *arena) {
+  arena->current = arena->head;
+  if (arena->current)
+    arena->current->used = 0;
+}
+
+void xml_arena_destroy(struct xml_arena *arena) {
+  struct xml_arena_chunk *chunk = arena->head;
+  struct xml_arena_chunk *next;
+
+  while (chunk) {
+    next = chunk->next;
+    free(chunk);
+    chunk = next;
+  }
+  xml_arena_init(arena);
+}
+
+static void *xml_arena_alloc(struct xml_arena *arena, size_t size) {
+  struct xml_arena_chunk *chunk = arena->current;
+  struct xml_arena_chunk *fresh;
+  void *mem;
+
+  size = (size + 7) & ~(size_t)7;
+
+  /* move on through the chunks kept from before the last reset */
+  while (chunk && chunk->size - chunk->used < size && chunk->next) {
+    chunk = chunk->next;
+    chunk->used = 0;
+  }
+
+  if (!chunk || chunk->size - chunk->used < size) {
+    size_t data_size =
+        size > XML_ARENA_CHUNK_SIZE ? size : XML_ARENA_CHUNK_SIZE;
+
+    fresh = malloc(sizeof(*fresh) + data_size);
+    fresh->size = data_size;
+    fresh->used = 0;
+    fresh->next = NULL;
+    if (chunk) {
+      fresh->next = chunk->next;
+      chunk->next = fresh;
+    } else {
+      arena->head = fresh;
+    }
+    chunk = fresh;
+  }
+
+  arena->current = chunk;
+  mem = (char *)(chunk + 1) + chunk->used;
+  chunk->used += size;
+  memset(mem, 0, size);
+
+  return mem;
+}
+
+/* nodes come from arena, or from calloc for levels freed by xml_free */
+static void *node_alloc(struct xml_arena *arena, size_t size) {
+  if (!arena)
+    return calloc(1, size);
+  return xml_arena_alloc(arena, size);
+}
+
 static int strtoi(const char *str, int len, int *res) {
   int val = 0;
   int neg = 0;
@@ -391,7 +469,8 @@ int read_position(struct slice *buf, struct xml_position *position) {
   return 0;
 }
 
-int read_joints(struct slice *buf, struct xml_joint **val) {
+int read_joints(struct slice *buf, struct xml_joint **val,
+                struct xml_arena *arena) {
   struct slice this_name;
   int empty;
   struct slice name;
@@ -417,7 +496,7 @@ int read_joints(struct slice *buf, struct xml_joint **val) {
       skip_ws(buf);
     }
 
-    joint = calloc(1, sizeof(*joint));
+    joint = node_alloc(arena, sizeof(*joint));
     res = read_int(buf, &joint->id);
     if (res)
       return res;
@@ -488,7 +567,8 @@ int read_block_attrs(struct slice *buf, struct xml_block *block) {
   return 0;
 }
 
-int read_block(struct slice *buf, struct xml_block *block) {
+int read_block(struct slice *buf, struct xml_block *block,
+               struct xml_arena *arena) {
   struct slice this_name;
   int empty;
   struct slice name;
@@ -526,7 +606,7 @@ int read_block(struct slice *buf, struct xml_block *block) {
     else if (slice_str_equal(&name, "goalBlock"))
       res = read_bool(buf, &block->goal_block);
     else if (slice_str_equal(&name, "joints"))
-      res = read_joints(buf, &block->joints);
+      res = read_joints(buf, &block->joints, arena);
     else
       res = skip_data_elem(buf);
 
@@ -543,7 +623,8 @@ int read_block(struct slice *buf, struct xml_block *block) {
   return 0;
 }
 
-int read_block_list(struct slice *buf, struct xml_block **val) {
+int read_block_list(struct slice *buf, struct xml_block **val,
+                    struct xml_arena *arena) {
   struct slice this_name;
   int empty;
   struct slice name;
@@ -562,11 +643,11 @@ int read_block_list(struct slice *buf, struct xml_block **val) {
   skip_ws(buf);
 
   while (peek_elem_name(buf, &name)) {
-    block = calloc(1, sizeof(*block));
+    block = node_alloc(arena, sizeof(*block));
     if (!block)
       return -1;
 
-    res = read_block(buf, block);
+    res = read_block(buf, block, arena);
     if (res)
       return res;
 
@@ -626,7 +707,8 @@ int read_zone(struct slice *buf, struct xml_zone *zone) {
   return 0;
 }
 
-int read_level(struct slice *buf, struct xml_level *level) {
+int read_level(struct slice *buf, struct xml_level *level,
+               struct xml_arena *arena) {
   struct slice this_name;
   int empty;
   struct slice name;
@@ -643,9 +725,9 @@ int read_level(struct slice *buf, struct xml_level *level) {
 
   while (peek_elem_name(buf, &name)) {
     if (slice_str_equal(&name, "levelBlocks"))
-      res = read_block_list(buf, &level->level_blocks);
+      res = read_block_list(buf, &level->level_blocks, arena);
     else if (slice_str_equal(&name, "playerBlocks"))
-      res = read_block_list(buf, &level->player_blocks);
+      res = read_block_list(buf, &level->player_blocks, arena);
     else if (slice_str_equal(&name, "start"))
       res = read_zone(buf, &level->start);
     else if (slice_str_equal(&name, "end"))
@@ -687,7 +769,8 @@ int read_level_id(struct slice *buf, int *val) {
   return 0;
 }
 
-int read_retrieve_level(struct slice *buf, struct xml_level *level) {
+int read_retrieve_level(struct slice *buf, struct xml_level *level,
+                        struct xml_arena *arena) {
   struct slice this_name;
   int empty;
   struct slice name;
@@ -704,7 +787,7 @@ int read_retrieve_level(struct slice *buf, struct xml_level *level) {
 
   while (peek_elem_name(buf, &name)) {
     if (slice_str_equal(&name, "level"))
-      res = read_level(buf, level);
+      res = read_level(buf, level, arena);
     else if (slice_str_equal(&name, "levelId"))
       res = read_level_id(buf, &level->level_id);
     else
@@ -719,6 +802,27 @@ int read_retrieve_level(struct slice *buf, struct xml_level *level) {
   return read_elem_end(buf, &this_name);
 }
 
+static int read_document(struct slice *buf, struct xml_level *level,
+                         struct xml_arena *arena) {
+  int res;
+
+  skip_ws(buf);
+
+  res = read_xml_decl(buf);
+  if (res)
+    return res;
+
+  skip_ws(buf);
+
+  res = read_retrieve_level(buf, level, arena);
+  if (res)
+    return res;
+
+  skip_ws(buf);
+
+  return 0;
+}
+
 int xml_parse(char *xml, int len, struct xml_level *level) {
   struct slice buf;
   int res;
@@ -726,22 +830,32 @@ int xml_parse(char *xml, int len, struct xml_level *level) {
   buf.ptr = xml;
   buf.len = len;
 
-  skip_ws(&buf);
-
-  res = read_xml_decl(&buf);
+  res = read_document(&buf, level, NULL);
   if (res)
     return res;
 
-  skip_ws(&buf);
+  if (buf.len > 0)
+    return -1;
+
+  return 0;
+}
+
+int xml_parse_next(char *xml, long len, long *used, struct xml_level *level,
+                   struct xml_arena *arena) {
+  struct slice buf;
+  int res;
+
+  memset(level, 0, sizeof(*level));
+  level->level_id = -1;
+
+  buf.ptr = xml;
+  buf.len = len;
 
-  res = read_retrieve_level(&buf, level);
+  res = read_document(&buf, level, arena);
   if (res)
     return res;
 
-  skip_ws(&buf);
-
-  if (buf.len > 0)
-    return -1;
+  *used = len - buf.len;
 
   return 0;
 }
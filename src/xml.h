@@ -54,4 +54,30 @@ struct xml_level {
 int xml_parse(char *xml, int len, struct xml_level *level);
 void xml_free(struct xml_level *level);
 
+/*
+ * Bump allocator for the nodes of parsed levels. Resetting it releases every
+ * level parsed into it at once and reuses the memory for the next ones.
+ */
+struct xml_arena_chunk;
+
+struct xml_arena {
+  struct xml_arena_chunk *head;
+  struct xml_arena_chunk *current;
+};
+
+void xml_arena_init(struct xml_arena *arena);
+void xml_arena_reset(struct xml_arena *arena);
+void xml_arena_destroy(struct xml_arena *arena);
+
+/*
+ * Parses the document at the start of xml, in place, and sets *used to the
+ * bytes it and the whitespace after it take, so concatenated documents can be
+ * parsed one after another from a mapped file. level is cleared first, with
+ * level_id -1. Nodes come from arena and must not be passed to xml_free; with
+ * a NULL arena they are calloc'd as by xml_parse. Returns 0, or -1 if xml
+ * does not start with a complete document.
+ */
+int xml_parse_next(char *xml, long len, long *used, struct xml_level *level,
+                   struct xml_arena *arena);
+
 #endif
@@ -0,0 +1,108 @@
+// Harness for libfcsim_core.
+//
+// Runs the design on stdin through the library the way run_single_design_xml
+// runs it: the solve tick (-1 if unsolved) and end tick on two lines of
+// stdout, and the same trace of the player blocks before every tick on
+// stderr, so the two can be compared directly. Then runs the design on
+// several worlds at once, all made from the one loaded design, and checks
+// that they agree with the first run, and that a malformed design is
+// rejected.
+//
+// Usage: fcsim_core_test [max_ticks] [threads] < design
+
+#include <fcsim_core/fcsim_core.h>
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct result {
+  int64_t solve_tick;
+  int64_t end_tick;
+  fcsim_body_state last[1]; // first block's final state
+};
+
+static void trace(fcsim_world *world, const fcsim_design *design,
+                  std::vector<fcsim_body_state> &states) {
+  fcsim_world_snapshot(world, states.data(), (int)states.size());
+  std::cerr << "Tick " << fcsim_world_tick(world) << std::endl;
+  for (size_t i = 0; i < states.size(); i++) {
+    fcsim_block_info info;
+    fcsim_design_block_info(design, (int)i, &info);
+    if (info.level)
+      continue;
+    std::cerr << "- ID = " << info.id << ", Type = " << info.type
+              << ", Pos = (" << states[i].x << ", " << states[i].y
+              << "), Vel = (" << states[i].vx << ", " << states[i].vy
+              << "), Ang = " << states[i].angle
+              << ", AngVel = " << states[i].angular_velocity << std::endl;
+  }
+}
+
+static void run(const fcsim_design *design, int64_t max_ticks, result *res) {
+  fcsim_world *world = fcsim_world_create(design);
+  res->solve_tick = fcsim_world_run(world, max_ticks);
+  res->end_tick = fcsim_world_tick(world);
+  fcsim_world_snapshot(world, res->last, 1);
+  fcsim_world_free(world);
+}
+
+static bool same(const result &a, const result &b) {
+  return a.solve_tick == b.solve_tick && a.end_tick == b.end_tick &&
+         !memcmp(&a.last, &b.last, sizeof(a.last));
+}
+
+int main(int argc, char **argv) {
+  int64_t max_ticks = argc > 1 ? atoll(argv[1]) : 1000;
+  int threads = argc > 2 ? atoi(argv[2]) : 4;
+
+  std::string text((std::istreambuf_iterator<char>(std::cin)),
+                   std::istreambuf_iterator<char>());
+  fcsim_design *design = fcsim_design_load(text.data(), text.size());
+  if (!design) {
+    std::cerr << "fcsim_core_test: cannot load design" << std::endl;
+    return 1;
+  }
+
+  // stepped one tick at a time, tracing each
+  std::vector<fcsim_body_state> states(fcsim_design_block_count(design));
+  fcsim_world *world = fcsim_world_create(design);
+  std::cerr << std::setprecision(17);
+  while (fcsim_world_tick(world) != max_ticks &&
+         fcsim_world_solve_tick(world) < 0) {
+    trace(world, design, states);
+    fcsim_world_step(world, 1);
+  }
+  result first = {};
+  first.solve_tick = fcsim_world_solve_tick(world);
+  first.end_tick = fcsim_world_tick(world);
+  fcsim_world_snapshot(world, first.last, 1);
+  fcsim_world_free(world);
+  std::cout << first.solve_tick << std::endl << first.end_tick << std::endl;
+
+  std::vector<result> results(threads);
+  std::vector<std::thread> workers;
+  for (int t = 0; t < threads; t++)
+    workers.emplace_back(run, design, max_ticks, &results[t]);
+  for (std::thread &w : workers)
+    w.join();
+  int agree = 0;
+  for (const result &r : results)
+    agree += same(r, first);
+  std::cout << "threads agree: " << agree << " of " << threads << std::endl;
+
+  std::string bad = text.substr(0, text.size() / 2);
+  fcsim_design *rejected = fcsim_design_load(bad.data(), bad.size());
+  std::cout << "truncated design rejected: " << (rejected ? "no" : "yes")
+            << std::endl;
+  fcsim_design_free(rejected);
+
+  fcsim_design_free(design);
+  return agree == threads && !rejected ? 0 : 1;
+}
@@ -0,0 +1,363 @@
+// Equivalence harness for fp_atan2, fp_strtod and fp_dtoa.
+//
+// Compares fp_atan2 against fp_atan2_reference, the unspecialised software
+// implementation, over a fixed table of edge cases and a configurable number
+// of random inputs spread across all cores. In the normal build every result
+// must match bit for bit. In the USE_FPATAN build fp_atan2 is the x87
+// instruction, which is only checked to be within one ulp.
+//
+// The same random doubles, written out in assorted ways, check that fp_strtod
+// agrees with fp_strtod_reference bit for bit, and that fp_strtod reads the
+// text of fp_dtoa back as exactly the double it was made from.
+//
+// Usage: fpmath_test [count] [threads]
+//   count    number of random inputs (default 10000000)
+//   threads  worker threads (default: hardware concurrency)
+
+#include <fpmath/fpmath.h>
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <thread>
+#include <vector>
+
+#ifdef USE_FPATAN
+static const uint64_t max_ulp_allowed = 1;
+#else
+static const uint64_t max_ulp_allowed = 0;
+#endif
+
+static uint64_t to_bits(double d) {
+  uint64_t u;
+  memcpy(&u, &d, sizeof(u));
+  return u;
+}
+
+static double from_bits(uint64_t u) {
+  double d;
+  memcpy(&d, &u, sizeof(d));
+  return d;
+}
+
+// Distance in ulps, with NaNs of any payload considered equal.
+static uint64_t ulp_distance(double a, double b) {
+  if (std::isnan(a) || std::isnan(b))
+    return std::isnan(a) && std::isnan(b) ? 0 : UINT64_MAX;
+  uint64_t ua = to_bits(a), ub = to_bits(b);
+  if ((ua ^ ub) >> 63) {
+    // opposite signs: only equal if both are zero
+    return (ua << 1) == 0 && (ub << 1) == 0 ? 0 : UINT64_MAX;
+  }
+  return ua > ub ? ua - ub : ub - ua;
+}
+
+static uint64_t splitmix64(uint64_t &state) {
+  uint64_t z = (state += 0x9e3779b97f4a7c15ull);
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+  return z ^ (z >> 31);
+}
+
+static double uniform(uint64_t &state, double lo, double hi) {
+  return lo + (hi - lo) * ((splitmix64(state) >> 11) * 0x1.0p-53);
+}
+
+static const double edge_values[] = {
+    0.0,
+    -0.0,
+    1.0,
+    -1.0,
+    0.5,
+    2.0,
+    0.0625,
+    16.0,
+    std::numeric_limits<double>::infinity(),
+    -std::numeric_limits<double>::infinity(),
+    std::numeric_limits<double>::quiet_NaN(),
+    -std::numeric_limits<double>::quiet_NaN(),
+    std::numeric_limits<double>::min(),
+    -std::numeric_limits<double>::min(),
+    std::numeric_limits<double>::denorm_min(),
+    -std::numeric_limits<double>::denorm_min(),
+    std::numeric_limits<double>::max(),
+    -std::numeric_limits<double>::max(),
+    0x1.0p-500,
+    0x1.fffffffffffffp-501,
+    0x1.0000000000001p-500,
+    0x1.0p500,
+    0x1.fffffffffffffp499,
+    0x1.0000000000001p500,
+    0x1.0p56,
+    0x1.0p57,
+    0x1.0p-56,
+    0x1.0p-57,
+    0x1.921fb54442d18p1,
+    0x1.921fb54442d18p0,
+};
+
+// One random argument. Mixes raw bit patterns, the coordinate ranges the
+// simulator actually produces, and exponents near the fast path bounds.
+static double random_arg(uint64_t &state) {
+  uint64_t r = splitmix64(state);
+  switch (r & 7) {
+  case 0:
+  case 1:
+    return from_bits(splitmix64(state));
+  case 2:
+  case 3:
+  case 4:
+    return uniform(state, -4000.0, 4000.0);
+  case 5: {
+    // exponent near the 2**+-500 scaling bounds
+    int e = (int)((r >> 3) % 16) - 8 + (((r >> 7) & 1) ? 500 : -500);
+    double m = uniform(state, 1.0, 2.0);
+    return std::ldexp(((r >> 8) & 1) ? -m : m, e);
+  }
+  case 6:
+    return edge_values[(r >> 3) % (sizeof(edge_values) / sizeof(double))];
+  default:
+    return uniform(state, -1e-3, 1e-3);
+  }
+}
+
+struct result {
+  uint64_t count = 0;
+  uint64_t mismatches = 0;
+  uint64_t max_ulp = 0;
+  uint64_t strtod_count = 0;
+  uint64_t strtod_mismatches = 0;
+  uint64_t dtoa_mismatches = 0;
+};
+
+static bool check_one(double y, double x, result &res) {
+  double a = fp_atan2(y, x);
+  double b = fp_atan2_reference(y, x);
+  uint64_t ulp = ulp_distance(a, b);
+  res.count++;
+  if (ulp > res.max_ulp)
+    res.max_ulp = ulp;
+  if (ulp > max_ulp_allowed) {
+    if (res.mismatches++ < 10) {
+      fprintf(stderr, "mismatch: fp_atan2(%a, %a) = %a, reference %a\n", y, x,
+              a, b);
+    }
+    return false;
+  }
+  return true;
+}
+
+static void check_strtod(const char *text, result &res) {
+  int len = (int)strlen(text);
+  double a = 0;
+  double b = 0;
+  int ret_a = fp_strtod(text, len, &a);
+  int ret_b = fp_strtod_reference(text, len, &b);
+  res.strtod_count++;
+  if (ret_a != ret_b || to_bits(a) != to_bits(b)) {
+    if (res.strtod_mismatches++ < 10) {
+      fprintf(stderr, "mismatch: fp_strtod(\"%s\") = %a, reference %a\n",
+              text, a, b);
+    }
+  }
+}
+
+static void check_dtoa(double val, result &res) {
+  char buf[FP_DTOA_BUFSIZE];
+  double back;
+  int len = fp_dtoa(buf, val);
+  fp_strtod(buf, len, &back);
+  // NaNs come back as the NaN that 0 * infinity makes, and tiny numbers only
+  // as something close
+  bool ok;
+  if (std::isnan(val))
+    ok = std::isnan(back);
+  else if (val != 0 && std::fabs(val) < FP_DTOA_MIN_EXACT)
+    ok = std::fabs(back) < FP_DTOA_MIN_EXACT;
+  else
+    ok = to_bits(back) == to_bits(val);
+  if (!ok || len != (int)strlen(buf) || len >= FP_DTOA_BUFSIZE) {
+    if (res.dtoa_mismatches++ < 10)
+      fprintf(stderr, "mismatch: fp_dtoa(%a) = \"%s\"\n", val, buf);
+  }
+}
+
+// Text for one random double: printf forms of every precision, and raw digit
+// strings with the sign, point and exponent the fast path looks at.
+static void random_text(uint64_t &state, double val, char *buf, size_t size) {
+  uint64_t r = splitmix64(state);
+  if (r & 1) {
+    snprintf(buf, size, (r & 2) ? "%.*g" : "%.*f", (int)((r >> 2) % 26), val);
+    return;
+  }
+  char *p = buf;
+  int digits = 1 + (int)((r >> 2) % 24);
+  int point = (int)((r >> 7) % (digits + 2)) - 1;
+  if ((r >> 12) & 1)
+    *p++ = (r >> 13) & 1 ? '-' : '+';
+  for (int i = 0; i < digits; i++) {
+    if (i == point)
+      *p++ = '.';
+    *p++ = '0' + (char)(splitmix64(state) % 10);
+  }
+  if ((r >> 14) & 1) {
+    int exp = (int)((r >> 15) % 700) - 350;
+    if ((r >> 25) & 1)
+      exp %= 30;
+    p += snprintf(p, size - (p - buf), (r >> 26) & 1 ? "e%d" : "E%+d", exp);
+  }
+  *p = 0;
+}
+
+static void check_random(uint64_t seed, uint64_t count, result *out) {
+  result res;
+  uint64_t state = seed;
+  char text[128];
+  for (uint64_t i = 0; i < count; i++) {
+    double y = random_arg(state);
+    double x = random_arg(state);
+    // the exponent difference bound matters as much as the magnitudes
+    if ((i & 15) == 0)
+      y = std::ldexp(x, (int)(splitmix64(state) % 121) - 60);
+    check_one(y, x, res);
+    random_text(state, x, text, sizeof(text));
+    check_strtod(text, res);
+    check_dtoa(y, res);
+  }
+  *out = res;
+}
+
+// ns per call of f on the text of the coordinates rod shells use.
+template <typename F> static double time_parse(F f) {
+  const int n = 1000000;
+  std::vector<char> texts(n * FP_DTOA_BUFSIZE);
+  std::vector<int> lens(n);
+  uint64_t state = 12345;
+  for (int i = 0; i < n; i++)
+    lens[i] = fp_dtoa(&texts[i * FP_DTOA_BUFSIZE],
+                      uniform(state, -4000.0, 4000.0));
+  double sink = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < n; i++) {
+    double d;
+    f(&texts[i * FP_DTOA_BUFSIZE], lens[i], &d);
+    sink += d;
+  }
+  auto end = std::chrono::steady_clock::now();
+  if (sink == 42.0)
+    puts("");
+  return std::chrono::duration<double, std::nano>(end - start).count() / n;
+}
+
+static double time_dtoa() {
+  const int n = 1000000;
+  std::vector<double> args(n);
+  uint64_t state = 12345;
+  for (double &d : args)
+    d = uniform(state, -4000.0, 4000.0);
+  char buf[FP_DTOA_BUFSIZE];
+  int sink = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < n; i++)
+    sink += fp_dtoa(buf, args[i]);
+  auto end = std::chrono::steady_clock::now();
+  if (sink == 42)
+    puts("");
+  return std::chrono::duration<double, std::nano>(end - start).count() / n;
+}
+
+// ns per call over the coordinate range rod shells use.
+template <typename F> static double time_calls(F f) {
+  const int n = 2000000;
+  std::vector<double> args(2 * n);
+  uint64_t state = 12345;
+  for (double &d : args)
+    d = uniform(state, -4000.0, 4000.0);
+  double sink = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < n; i++)
+    sink += f(args[2 * i], args[2 * i + 1]);
+  auto end = std::chrono::steady_clock::now();
+  if (sink == 42.0)
+    puts("");
+  return std::chrono::duration<double, std::nano>(end - start).count() / n;
+}
+
+int main(int argc, char **argv) {
+  uint64_t count = argc > 1 ? strtoull(argv[1], NULL, 10) : 10000000;
+  unsigned threads = argc > 2 ? (unsigned)atoi(argv[2])
+                              : std::thread::hardware_concurrency();
+  if (threads == 0)
+    threads = 1;
+
+  result edge;
+  for (double y : edge_values) {
+    for (double x : edge_values) {
+      check_one(y, x, edge);
+      check_one(-y, x, edge);
+    }
+    check_dtoa(y, edge);
+    check_dtoa(-y, edge);
+  }
+  static const char *edge_texts[] = {
+      "",       "-",    "+",     ".",      "-.5",   "5.",   "1e",
+      "1e+",    "e5",   "1.2.3", "0x10",   "1e999", "-0",   "00012",
+      "1e0022", "1e22", "1e23",  "1e-22",  "1e-23", "9007199254740993",
+      "12345678901234567890",    "1234567890123456789", "0.1e-5",
+  };
+  for (const char *text : edge_texts)
+    check_strtod(text, edge);
+
+  // slow path rate on simulator-like inputs, measured single threaded
+  uint64_t slow_before = fp_atan2_slow_path_count();
+  uint64_t state = 1;
+  const int sample = 1000000;
+  for (int i = 0; i < sample; i++)
+    fp_atan2(uniform(state, -4000.0, 4000.0), uniform(state, -4000.0, 4000.0));
+  uint64_t slow = fp_atan2_slow_path_count() - slow_before;
+
+  std::vector<result> results(threads);
+  std::vector<std::thread> workers;
+  for (unsigned t = 0; t < threads; t++) {
+    uint64_t n = count / threads + (t < count % threads ? 1 : 0);
+    workers.emplace_back(check_random, 0x5eed0000ull + t, n, &results[t]);
+  }
+  for (std::thread &w : workers)
+    w.join();
+
+  result total = edge;
+  for (const result &r : results) {
+    total.count += r.count;
+    total.mismatches += r.mismatches;
+    total.strtod_count += r.strtod_count;
+    total.strtod_mismatches += r.strtod_mismatches;
+    total.dtoa_mismatches += r.dtoa_mismatches;
+    if (r.max_ulp > total.max_ulp)
+      total.max_ulp = r.max_ulp;
+  }
+
+  printf("inputs: %llu (%u threads)\n", (unsigned long long)total.count,
+         threads);
+  printf("mismatches: %llu\n", (unsigned long long)total.mismatches);
+  printf("max ulp: %llu\n", (unsigned long long)total.max_ulp);
+  printf("slow path: %llu of %d typical inputs\n", (unsigned long long)slow,
+         sample);
+  printf("fp_atan2: %.2f ns/call, reference: %.2f ns/call\n",
+         time_calls(fp_atan2), time_calls(fp_atan2_reference));
+  printf("strtod inputs: %llu\n", (unsigned long long)total.strtod_count);
+  printf("strtod mismatches: %llu\n",
+         (unsigned long long)total.strtod_mismatches);
+  printf("dtoa mismatches: %llu\n", (unsigned long long)total.dtoa_mismatches);
+  printf("fp_strtod: %.2f ns/call, reference: %.2f ns/call\n",
+         time_parse(fp_strtod), time_parse(fp_strtod_reference));
+  printf("fp_dtoa: %.2f ns/call\n", time_dtoa());
+  return total.mismatches == 0 && total.strtod_mismatches == 0 &&
+                 total.dtoa_mismatches == 0
+             ? 0
+             : 1;
+}
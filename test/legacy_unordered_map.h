@@ -0,0 +1,164 @@
+#pragma once
+// The linear probing unordered_map stl_mock had before the Robin Hood
+// rework, kept as the baseline for stl_bench. Needs stl_mock.h.
+#include "stl_mock.h"
+
+enum class LegacyEntryState { EMPTY, OCCUPIED, DELETED };
+
+template <typename K, typename V, typename Hasher = std::BasicHasher<K>>
+struct legacy_unordered_map {
+private:
+  struct Entry {
+    K key;
+    V value;
+    LegacyEntryState state;
+
+    Entry() : state(LegacyEntryState::EMPTY) {}
+    Entry(const K &k, const V &v)
+        : key(k), value(v), state(LegacyEntryState::OCCUPIED) {}
+  };
+
+  std::vector<Entry> buckets;
+  size_t num_elements;
+  size_t num_buckets;
+  const float max_load_factor = 0.75f;
+
+  size_t _find_slot(const K &key) const {
+    if (num_elements == 0) {
+      return num_buckets;
+    }
+
+    Hasher hasher;
+    size_t index = hasher(key) % num_buckets;
+    size_t start_index = index;
+
+    while (buckets[index].state != LegacyEntryState::EMPTY) {
+      if (buckets[index].state == LegacyEntryState::OCCUPIED &&
+          buckets[index].key == key) {
+        return index;
+      }
+      index = (index + 1) % num_buckets;
+      if (index == start_index) {
+        break;
+      }
+    }
+    return num_buckets;
+  }
+
+  size_t _find_insert_slot(const K &key) const {
+    Hasher hasher;
+    size_t index = hasher(key) % num_buckets;
+    size_t start_index = index;
+    size_t first_deleted_slot = num_buckets;
+
+    while (buckets[index].state != LegacyEntryState::EMPTY) {
+      if (buckets[index].state == LegacyEntryState::OCCUPIED) {
+        if (buckets[index].key == key) {
+          return index;
+        }
+      } else { // LegacyEntryState::DELETED
+        if (first_deleted_slot == num_buckets) {
+          first_deleted_slot = index;
+        }
+      }
+      index = (index + 1) % num_buckets;
+      if (index == start_index) {
+        return num_buckets;
+      }
+    }
+    return (first_deleted_slot != num_buckets) ? first_deleted_slot : index;
+  }
+
+  void _rehash(size_t new_bucket_count) {
+    std::vector<Entry> old_buckets = buckets;
+
+    buckets.clear();
+    buckets.resize(new_bucket_count);
+    for (size_t i = 0; i < new_bucket_count; ++i) {
+      buckets[i].state = LegacyEntryState::EMPTY;
+    }
+
+    num_buckets = new_bucket_count;
+    num_elements = 0;
+
+    for (size_t i = 0; i < old_buckets.size(); ++i) {
+      if (old_buckets[i].state == LegacyEntryState::OCCUPIED) {
+        std::pair<K, V> data_to_insert;
+        data_to_insert.first = old_buckets[i].key;
+        data_to_insert.second = old_buckets[i].value;
+        insert(data_to_insert);
+      }
+    }
+  }
+
+  void _check_and_rehash() {
+    if (num_buckets == 0 ||
+        static_cast<float>(num_elements + 1) / num_buckets > max_load_factor) {
+      size_t new_size = (num_buckets == 0) ? 16 : num_buckets * 2;
+      _rehash(new_size);
+    }
+  }
+
+public:
+  // buckets are allocated on the first insert
+  legacy_unordered_map() : num_elements(0), num_buckets(0) {}
+  legacy_unordered_map(const legacy_unordered_map &other)
+      : buckets(other.buckets), num_elements(other.num_elements),
+        num_buckets(other.num_buckets) {}
+  legacy_unordered_map(legacy_unordered_map &&other)
+      : buckets(std::move(other.buckets)), num_elements(other.num_elements),
+        num_buckets(other.num_buckets) {
+    other.num_elements = 0;
+    other.num_buckets = 0;
+  }
+  legacy_unordered_map &operator=(const legacy_unordered_map &other) {
+    buckets = other.buckets;
+    num_elements = other.num_elements;
+    num_buckets = other.num_buckets;
+    return *this;
+  }
+  legacy_unordered_map &operator=(legacy_unordered_map &&other) {
+    buckets = std::move(other.buckets);
+    num_elements = other.num_elements;
+    num_buckets = other.num_buckets;
+    other.num_elements = 0;
+    other.num_buckets = 0;
+    return *this;
+  }
+
+  size_t bucket_count() const { return num_buckets; }
+
+  // Compliant with std::unordered_map::count.
+  size_t count(const K &key) const {
+    return (_find_slot(key) != num_buckets) ? 1 : 0;
+  }
+
+  // Compliant with std::unordered_map::insert return type.
+  std::pair<bool, V &> insert(const std::pair<K, V> &data) {
+    _check_and_rehash();
+
+    size_t slot_index = _find_insert_slot(data.first);
+
+    if (buckets[slot_index].state == LegacyEntryState::OCCUPIED &&
+        buckets[slot_index].key == data.first) {
+      return {false, buckets[slot_index].value};
+    } else {
+      buckets[slot_index].key = data.first;
+      buckets[slot_index].value = data.second;
+      buckets[slot_index].state = LegacyEntryState::OCCUPIED;
+      num_elements++;
+      return {true, buckets[slot_index].value};
+    }
+  }
+
+  // Deviation from std::unordered_map::at: Does not throw std::out_of_range.
+  // Returns a reference to a static dummy value if key is not found.
+  V &at(const K &key) {
+    size_t index = _find_slot(key);
+    if (index != num_buckets) {
+      return buckets[index].value;
+    }
+    static V dummy_value_for_not_found;
+    return dummy_value_for_not_found;
+  }
+};
@@ -1,5 +1,8 @@
 #include "buddy_allocator.hpp"
+#include "first_fit_buddy_allocator.hpp"
+#include "slab_allocator.hpp"
 #include "test_framework.h"
+#include <time.h>
 
 // Alignment required so ensure_root_size's page-counting arithmetic works:
 //   memory_size() = ((size_t)heap_base_ptr + committed_bytes) >> 16
@@ -263,6 +266,343 @@ TEST(MallocTests, OverheadBoundMixed) {
   a.free(p3);
 }
 
+// ── R1: realloc ─────────────────────────────────────────────────────────────
+
+TEST(MallocTests, ReallocGrowsInPlace) {
+  TestBuf tb;
+  BuddyAllocator a(tb.base, BUF_SZ);
+  char *p = (char *)a.malloc(8);
+  void *keep = a.malloc(4000);
+  for (int i = 0; i < 8; i++)
+    p[i] = (char)i;
+  // p starts the heap and the blocks up to keep are free, so it merges
+  // instead of moving
+  char *q = (char *)a.realloc(p, 1000);
+  CHECK(q == p);
+  for (int i = 0; i < 8; i++)
+    CHECK_EQUAL(i, (int)q[i]);
+  CHECK_EQUAL(2u, a.live_alloc_count_get());
+  CHECK_EQUAL(5000u, a.live_useful_bytes_get());
+  a.free(q);
+  a.free(keep);
+  CHECK_EQUAL(0u, a.live_block_bytes_get());
+}
+
+TEST(MallocTests, ReallocGrowsRootInPlace) {
+  TestBuf tb;
+  BuddyAllocator a(tb.base, BUF_SZ);
+  void *p = a.malloc(8);
+  // p is the whole heap, so the heap doubles under it
+  void *q = a.realloc(p, 10000);
+  CHECK(q == p);
+  a.free(q);
+}
+
+TEST(MallocTests, ReallocMovesWhenBuddyTaken) {
+  TestBuf tb;
+  BuddyAllocator a(tb.base, BUF_SZ);
+  char *p = (char *)a.malloc(8);
+  void *right = a.malloc(8);
+  for (int i = 0; i < 8; i++)
+    p[i] = (char)(i + 1);
+  char *q = (char *)a.realloc(p, 200);
+  CHECK(q != p);
+  for (int i = 0; i < 8; i++)
+    CHECK_EQUAL(i + 1, (int)q[i]);
+  CHECK_EQUAL(2u, a.live_alloc_count_get());
+  CHECK_EQUAL(208u, a.live_useful_bytes_get());
+  a.free(q);
+  a.free(right);
+  CHECK_EQUAL(0u, a.live_alloc_count_get());
+}
+
+TEST(MallocTests, ReallocShrinkKeepsBlock) {
+  TestBuf tb;
+  BuddyAllocator a(tb.base, BUF_SZ);
+  void *p = a.malloc(500);
+  void *q = a.realloc(p, 20);
+  CHECK(q == p);
+  CHECK_EQUAL(20u, a.live_useful_bytes_get());
+  a.free(q);
+}
+
+TEST(MallocTests, ReallocNullAndZero) {
+  TestBuf tb;
+  BuddyAllocator a(tb.base, BUF_SZ);
+  void *p = a.realloc(nullptr, 16);
+  CHECK(p != nullptr);
+  CHECK(a.realloc(p, 0) == nullptr);
+  CHECK_EQUAL(0u, a.live_alloc_count_get());
+}
+
+// ── L1: per-order free lists ─────────────────────────────────────────────────
+
+// After a fragmenting alloc/free sequence, freeing everything must merge the
+// heap back into a single root block on a single list.
+TEST(MallocTests, FragmentedHeapCoalesces) {
+  TestBuf tb;
+  BuddyAllocator a(tb.base, BUF_SZ);
+  const int N = 512;
+  void *ptrs[N];
+  unsigned int seed = 1;
+  for (int i = 0; i < N; i++) {
+    seed = seed * 1103515245u + 12345u;
+    ptrs[i] = a.malloc(1 + (seed >> 16) % 700);
+  }
+  for (int i = 0; i < N; i += 2)
+    a.free(ptrs[i]);
+  for (int i = 0; i < N; i += 2) {
+    seed = seed * 1103515245u + 12345u;
+    ptrs[i] = a.malloc(1 + (seed >> 16) % 300);
+  }
+  for (int i = N - 1; i >= 0; i--)
+    a.free(ptrs[i]);
+  CHECK_EQUAL(0u, a.live_block_bytes_get());
+  CHECK(a.free_orders == ((size_t)1 << BuddyAllocator::order_of(a.root_size)));
+  CHECK(a.free_heads[BuddyAllocator::order_of(a.root_size)] ==
+        (size_t)tb.base);
+}
+
+// ── T1: throughput against the single list first-fit allocator ───────────────
+
+// Keeps `slots` allocations live and replaces a random one per step, which
+// leaves many free blocks of mixed sizes scattered over the heap. Returns the
+// seconds taken and checks the heap is empty afterwards.
+template <typename Allocator>
+static double churn(Allocator &a, int slots, int steps, bool &ok) {
+  void *ptrs[1024] = {};
+  unsigned int seed = 7;
+  clock_t start = clock();
+  for (int i = 0; i < steps; i++) {
+    seed = seed * 1103515245u + 12345u;
+    int k = (int)((seed >> 8) % (unsigned int)slots);
+    size_t n = 1 + (seed >> 16) % ((seed & 15) == 0 ? 2048 : 256);
+    a.free(ptrs[k]);
+    ptrs[k] = a.malloc(n);
+  }
+  for (int k = 0; k < slots; k++)
+    a.free(ptrs[k]);
+  clock_t end = clock();
+  ok = a.live_alloc_count_get() == 0;
+  return (double)(end - start) / CLOCKS_PER_SEC;
+}
+
+TEST(MallocTests, ThroughputVsFirstFit) {
+  const int slots = 1024;
+  const int steps = 100000;
+  bool ok_new = false;
+  bool ok_old = false;
+  double t_new, t_old;
+  {
+    TestBuf tb;
+    BuddyAllocator a(tb.base, BUF_SZ);
+    t_new = churn(a, slots, steps, ok_new);
+  }
+  {
+    TestBuf tb;
+    FirstFitBuddyAllocator a(tb.base, BUF_SZ);
+    t_old = churn(a, slots, steps, ok_old);
+  }
+  CHECK(ok_new);
+  CHECK(ok_old);
+  printf("    per-order lists: %.0f ops/s, first-fit: %.0f ops/s\n",
+         steps / (t_new > 0 ? t_new : 1e-9),
+         steps / (t_old > 0 ? t_old : 1e-9));
+}
+
+// ── S1: slab front end ───────────────────────────────────────────────────────
+
+TEST(SlabTests, SmallAllocsUseSlabs) {
+  TestBuf tb;
+  BuddyAllocator b(tb.base, BUF_SZ);
+  SlabAllocator a(b);
+  void *p = a.malloc(40);
+  CHECK(a.is_slab_object(p));
+  CHECK_EQUAL(1u, a.live_alloc_count_get());
+  CHECK_EQUAL(48u, a.live_useful_bytes_get());
+  CHECK_EQUAL(SlabAllocator::slab_size, a.live_slab_bytes_get());
+  a.free(p);
+  CHECK_EQUAL(0u, a.live_alloc_count_get());
+  CHECK_EQUAL(0u, a.live_useful_bytes_get());
+}
+
+TEST(SlabTests, LargeAllocsUseBuddy) {
+  TestBuf tb;
+  BuddyAllocator b(tb.base, BUF_SZ);
+  SlabAllocator a(b);
+  void *p = a.malloc(SlabAllocator::max_small + 1);
+  CHECK(!a.is_slab_object(p));
+  CHECK_EQUAL(0u, a.live_slab_bytes_get());
+  CHECK_EQUAL(SlabAllocator::max_small + 1, a.live_useful_bytes_get());
+  a.free(p);
+  CHECK_EQUAL(0u, b.live_alloc_count_get());
+}
+
+TEST(SlabTests, ObjectsAlignedAndDisjoint) {
+  TestBuf tb;
+  BuddyAllocator b(tb.base, BUF_SZ);
+  SlabAllocator a(b);
+  const int N = 300;
+  unsigned char *ptrs[N];
+  for (int i = 0; i < N; i++) {
+    size_t n = 1 + (size_t)(i * 37) % SlabAllocator::max_small;
+    ptrs[i] = (unsigned char *)a.malloc(n);
+    CHECK_EQUAL(0u, (size_t)ptrs[i] % 8);
+    __builtin_memset(ptrs[i], i & 0xff, n);
+  }
+  for (int i = 0; i < N; i++) {
+    size_t n = 1 + (size_t)(i * 37) % SlabAllocator::max_small;
+    for (size_t k = 0; k < n; k++)
+      CHECK_EQUAL(i & 0xff, (int)ptrs[i][k]);
+  }
+  for (int i = 0; i < N; i++)
+    a.free(ptrs[i]);
+  CHECK_EQUAL(0u, a.live_alloc_count_get());
+}
+
+TEST(SlabTests, FreedObjectReused) {
+  TestBuf tb;
+  BuddyAllocator b(tb.base, BUF_SZ);
+  SlabAllocator a(b);
+  void *p1 = a.malloc(24);
+  void *p2 = a.malloc(24);
+  a.free(p1);
+  void *p3 = a.malloc(20);
+  CHECK(p3 == p1);
+  a.free(p2);
+  a.free(p3);
+}
+
+// Emptied slabs go back to the buddy heap, except one kept per class.
+TEST(SlabTests, EmptySlabsReleased) {
+  TestBuf tb;
+  BuddyAllocator b(tb.base, BUF_SZ);
+  SlabAllocator a(b);
+  const int N = 1000;
+  void *ptrs[N];
+  for (int i = 0; i < N; i++)
+    ptrs[i] = a.malloc(16);
+  CHECK(a.live_slab_bytes_get() > SlabAllocator::slab_size);
+  for (int i = 0; i < N; i++)
+    a.free(ptrs[i]);
+  CHECK_EQUAL(SlabAllocator::slab_size, a.live_slab_bytes_get());
+  CHECK_EQUAL(0u, a.live_alloc_count_get());
+}
+
+TEST(SlabTests, SavesBytesWhenFull) {
+  TestBuf tb;
+  BuddyAllocator b(tb.base, BUF_SZ);
+  SlabAllocator a(b);
+  const int N = 1000;
+  void *ptrs[N];
+  for (int i = 0; i < N; i++)
+    ptrs[i] = a.malloc(16);
+  // a 16 byte object is a 64 byte buddy block on 64-bit, 32 on 32-bit
+  CHECK(a.live_slab_saved_bytes_get() > 0);
+  CHECK(a.live_block_bytes_get() - a.live_useful_bytes_get() <
+        (size_t)N * 16);
+  for (int i = 0; i < N; i++)
+    a.free(ptrs[i]);
+}
+
+TEST(SlabTests, ReallocWithinClassStays) {
+  TestBuf tb;
+  BuddyAllocator b(tb.base, BUF_SZ);
+  SlabAllocator a(b);
+  void *p = a.malloc(17);
+  CHECK(a.realloc(p, 24) == p);
+  a.free(p);
+}
+
+TEST(SlabTests, ReallocOutOfClassMoves) {
+  TestBuf tb;
+  BuddyAllocator b(tb.base, BUF_SZ);
+  SlabAllocator a(b);
+  char *p = (char *)a.malloc(20);
+  for (int i = 0; i < 20; i++)
+    p[i] = (char)i;
+  char *q = (char *)a.realloc(p, 100);
+  CHECK(q != p);
+  for (int i = 0; i < 20; i++)
+    CHECK_EQUAL(i, (int)q[i]);
+  char *r = (char *)a.realloc(q, 5000);
+  CHECK(!a.is_slab_object(r));
+  for (int i = 0; i < 20; i++)
+    CHECK_EQUAL(i, (int)r[i]);
+  CHECK_EQUAL(1u, a.live_alloc_count_get());
+  a.free(r);
+  CHECK_EQUAL(0u, a.live_alloc_count_get());
+}
+
+// Allocates `count` objects of the sizes a loaded design is made of, then
+// frees them all, `rounds` times. Returns the seconds taken and the live block
+// bytes at the peak.
+template <typename Allocator>
+static double build_teardown(Allocator &a, int count, int rounds,
+                             size_t &peak) {
+  static void *ptrs[8192];
+  const size_t sizes[3] = {24, 40, 100};
+  clock_t start = clock();
+  for (int r = 0; r < rounds; r++) {
+    for (int i = 0; i < count; i++)
+      ptrs[i] = a.malloc(sizes[i % 3]);
+    peak = a.live_block_bytes_get();
+    for (int i = 0; i < count; i++)
+      a.free(ptrs[i]);
+  }
+  clock_t end = clock();
+  return (double)(end - start) / CLOCKS_PER_SEC;
+}
+
+TEST(SlabTests, ThroughputVsBuddy) {
+  const int count = 8192;
+  const int rounds = 20;
+  size_t peak_slab = 0;
+  size_t peak_buddy = 0;
+  double t_slab, t_buddy;
+  {
+    TestBuf tb;
+    BuddyAllocator b(tb.base, BUF_SZ);
+    SlabAllocator a(b);
+    t_slab = build_teardown(a, count, rounds, peak_slab);
+    CHECK_EQUAL(0u, a.live_alloc_count_get());
+  }
+  {
+    TestBuf tb;
+    BuddyAllocator a(tb.base, BUF_SZ);
+    t_buddy = build_teardown(a, count, rounds, peak_buddy);
+    CHECK_EQUAL(0u, a.live_alloc_count_get());
+  }
+  CHECK(peak_slab < peak_buddy);
+  double ops = 2.0 * count * rounds;
+  printf("    slabs: %.0f ops/s, %zu bytes; buddy only: %.0f ops/s, %zu "
+         "bytes\n",
+         ops / (t_slab > 0 ? t_slab : 1e-9), peak_slab,
+         ops / (t_buddy > 0 ? t_buddy : 1e-9), peak_buddy);
+}
+
+ASAN_XFAIL_TEST(SlabTests, DoubleFree) {
+  TestBuf tb;
+  BuddyAllocator b(tb.base, BUF_SZ);
+  SlabAllocator a(b);
+  void *keep = a.malloc(32);
+  void *p = a.malloc(32);
+  a.free(p);
+  a.free(p);
+  a.free(keep);
+}
+
+ASAN_XFAIL_TEST(SlabTests, UseAfterFreeWrite) {
+  TestBuf tb;
+  BuddyAllocator b(tb.base, BUF_SZ);
+  SlabAllocator a(b);
+  void *keep = a.malloc(32);
+  int *p = (int *)a.malloc(sizeof(int));
+  a.free(p);
+  *p = 99;
+  a.free(keep);
+}
+
 // ── F5: double-free detection (ASan via BUDDY_POISON) ────────────────────────
 
 ASAN_XFAIL_TEST(MallocTests, DoubleFree) {
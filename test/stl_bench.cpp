@@ -0,0 +1,163 @@
+// Container workloads modelled on the renderer's per-frame structures, built
+// twice: stl_bench against stl_mock (the containers the web build uses) and
+// stl_bench-std against the host standard library. Both builds must print the
+// same checksums; the timings compare the two. The stl_mock build also runs
+// the map workloads against the unordered_map stl_mock had before, under a
+// "_legacy" suffix.
+//
+// Usage: stl_bench [rounds]
+//   rounds  repetitions of every workload (default 200)
+
+#ifdef __wasm__
+#include "stl_mock.h"
+
+#include "legacy_unordered_map.h"
+#else
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#endif
+
+#include <stdint.h>
+#include <stdio.h>
+#include <time.h>
+
+static uint64_t checksum = 0;
+
+static void mix(uint64_t value) {
+  checksum = (checksum ^ value) * 0x100000001b3ull;
+}
+
+// like block_graphics_layer: cleared and refilled every frame
+struct layer {
+  std::vector<uint32_t> indices;
+  std::vector<float> coords;
+  std::vector<float> colors;
+};
+
+// like ui_button_single with its texts
+struct button_text {
+  std::string text;
+  float scale = 1;
+};
+
+struct button {
+  int id = 0;
+  float x = 0, y = 0;
+  std::vector<button_text> texts;
+};
+
+struct point {
+  double x, y;
+};
+
+struct trail {
+  std::vector<point> datapoints;
+};
+
+static void push_ints() {
+  std::vector<int> vec;
+  for (int i = 0; i < 10000; i++)
+    vec.push_back(i);
+  mix(vec[9999] + vec.size());
+}
+
+static void layers() {
+  std::vector<layer> all;
+  for (int z = 0; z < 12; z++) {
+    all.emplace_back();
+    // only a few layers get geometry, as in a typical frame
+    if (z % 4)
+      continue;
+    for (uint32_t i = 0; i < 300; i++) {
+      all[z].indices.push_back(i);
+      all[z].coords.push_back((float)i);
+      all[z].coords.push_back((float)-i);
+      all[z].colors.push_back(0.5f);
+    }
+  }
+  mix(all.size() + all[8].indices.size());
+}
+
+static void buttons() {
+  std::vector<button> all;
+  for (int i = 0; i < 40; i++) {
+    button b;
+    b.id = i;
+    b.texts.push_back(button_text{std::to_string(i), 2});
+    b.texts.push_back(button_text{"label", 1});
+    all.push_back(std::move(b));
+  }
+  mix(all.size() + all[39].texts.size());
+}
+
+static void trails() {
+  std::vector<trail> all;
+  for (int goal = 0; goal < 4; goal++) {
+    all.emplace_back();
+    for (int i = 0; i < 2500; i++)
+      all[goal].datapoints.push_back(point{(double)i, (double)goal});
+  }
+  mix(all.size() + all[3].datapoints.size());
+}
+
+// like the design pointer maps: build once, look up many times
+template <typename Map> static void pointer_map() {
+  static char objects[20000];
+  Map map;
+  for (int i = 0; i < 20000; i++)
+    map.insert(std::make_pair((void *)&objects[i], (void *)&objects[19999 - i]));
+  uint64_t found = 0;
+  for (int i = 0; i < 20000; i += 3)
+    found += (char *)map.at(&objects[i]) - objects;
+  mix(found);
+}
+
+// a sliding window of live keys, with misses, sized up front
+template <typename Map> static void id_churn() {
+  Map map;
+  map.reserve(1024);
+  uint64_t found = 0;
+  for (int i = 0; i < 20000; i++) {
+    map.insert(std::make_pair(i, i * 7));
+    if (i >= 1000)
+      map.erase(i - 1000);
+    found += map.count(i / 2) + map.count(i + 1);
+  }
+  found += map.at(19999) + map.size();
+  mix(found);
+}
+
+static void run(const char *name, void (*workload)(), int rounds) {
+  clock_t start = clock();
+  for (int i = 0; i < rounds; i++)
+    workload();
+  clock_t end = clock();
+  double us = (double)(end - start) * 1e6 / CLOCKS_PER_SEC / rounds;
+  printf("%-18s %9.1f us/round  checksum %016llx\n", name, us,
+         (unsigned long long)checksum);
+}
+
+int main(int argc, char **argv) {
+  // no atoi: with stl_mock, stdlib.h is the web build's
+  int rounds = 0;
+  for (const char *c = argc > 1 ? argv[1] : "200"; *c; c++)
+    rounds = rounds * 10 + (*c - '0');
+#ifdef __wasm__
+  printf("stl_mock\n");
+#else
+  printf("std\n");
+#endif
+  run("push_ints", push_ints, rounds);
+  run("layers", layers, rounds);
+  run("buttons", buttons, rounds);
+  run("trails", trails, rounds);
+  run("pointer_map", pointer_map<std::unordered_map<void *, void *>>, rounds);
+  run("id_churn", id_churn<std::unordered_map<int, int>>, rounds);
+#ifdef __wasm__
+  run("pointer_map_legacy",
+      pointer_map<legacy_unordered_map<void *, void *>>, rounds);
+#endif
+  return 0;
+}
@@ -132,6 +132,131 @@ TEST(VectorTests, LargeResize) {
   CHECK_EQUAL(42, vec[999]);
 }
 
+TEST(VectorTests, GrowKeepsTrivialData) {
+  // trivially copyable elements are moved by realloc
+  struct point {
+    float x, y;
+  };
+  std::vector<point> vec;
+  for (int i = 0; i < 10000; ++i)
+    vec.push_back(point{(float)i, (float)-i});
+  CHECK_EQUAL(10000, (int)vec.size());
+  for (int i = 0; i < 10000; ++i) {
+    CHECK_EQUAL((float)i, vec[i].x);
+    CHECK_EQUAL((float)-i, vec[i].y);
+  }
+}
+
+TEST(VectorTests, GrowKeepsNonTrivialData) {
+  std::vector<std::string> vec;
+  for (int i = 0; i < 100; ++i)
+    vec.push_back(std::to_string(i));
+  for (int i = 0; i < 100; ++i)
+    CHECK(strcmp(std::to_string(i).c_str(), vec[i].c_str()) == 0);
+}
+
+TEST(VectorTests, EmptyDoesNotAllocate) {
+  std::vector<int> vec;
+  CHECK(vec._storage == nullptr);
+  CHECK_EQUAL(0, (int)vec.capacity());
+  vec.push_back(1);
+  CHECK(vec._storage != nullptr);
+}
+
+TEST(VectorTests, MoveConstruct) {
+  std::vector<int> a;
+  for (int i = 0; i < 20; ++i)
+    a.push_back(i);
+  int *storage = a._storage;
+  std::vector<int> b(std::move(a));
+  CHECK(b._storage == storage);
+  CHECK_EQUAL(20, (int)b.size());
+  CHECK_EQUAL(19, b[19]);
+  CHECK_EQUAL(0, (int)a.size());
+  CHECK(a._storage == nullptr);
+}
+
+TEST(VectorTests, MoveAssign) {
+  std::vector<int> a;
+  std::vector<int> b;
+  a.push_back(7);
+  b.push_back(1);
+  b.push_back(2);
+  b = std::move(a);
+  CHECK_EQUAL(1, (int)b.size());
+  CHECK_EQUAL(7, b[0]);
+  CHECK_EQUAL(0, (int)a.size());
+  // a moved-from vector is still usable
+  a.push_back(3);
+  CHECK_EQUAL(3, a[0]);
+}
+
+TEST(VectorTests, SelfCopyAssign) {
+  std::vector<int> a;
+  a.push_back(5);
+  std::vector<int> &ref = a;
+  a = ref;
+  CHECK_EQUAL(1, (int)a.size());
+  CHECK_EQUAL(5, a[0]);
+}
+
+TEST(VectorTests, PushBackMovesStrings) {
+  std::vector<std::string> vec;
+  std::string s = "moved";
+  vec.push_back(std::move(s));
+  CHECK(strcmp(vec[0].c_str(), "moved") == 0);
+  CHECK_EQUAL(0, (int)s.size());
+}
+
+TEST(VectorTests, EmplaceBackArgs) {
+  struct pt {
+    int x, y;
+    pt() : x(0), y(0) {}
+    pt(int x_, int y_) : x(x_), y(y_) {}
+  };
+  std::vector<pt> vec;
+  pt &ref = vec.emplace_back(3, 4);
+  CHECK_EQUAL(3, ref.x);
+  CHECK_EQUAL(4, vec[0].y);
+  vec.emplace_back();
+  CHECK_EQUAL(0, vec[1].x);
+}
+
+TEST(VectorTests, ReserveKeepsData) {
+  std::vector<int> vec;
+  vec.push_back(1);
+  vec.reserve(1000);
+  CHECK_EQUAL(1000, (int)vec.capacity());
+  CHECK_EQUAL(1, vec[0]);
+  int *storage = vec._storage;
+  for (int i = 1; i < 1000; ++i)
+    vec.push_back(i);
+  CHECK(vec._storage == storage);
+}
+
+TEST(VectorTests, ShrinkToFit) {
+  std::vector<std::string> vec;
+  for (int i = 0; i < 20; ++i)
+    vec.push_back(std::to_string(i));
+  vec.resize(3);
+  vec.shrink_to_fit();
+  CHECK_EQUAL(3, (int)vec.capacity());
+  CHECK(strcmp(vec[2].c_str(), "2") == 0);
+  vec.clear();
+  vec.shrink_to_fit();
+  CHECK(vec._storage == nullptr);
+}
+
+TEST(VectorTests, GrowMovesNestedVectors) {
+  std::vector<std::vector<int>> outer;
+  for (int i = 0; i < 50; ++i) {
+    outer.emplace_back();
+    outer[i].push_back(i);
+  }
+  for (int i = 0; i < 50; ++i)
+    CHECK_EQUAL(i, outer[i][0]);
+}
+
 TEST(VectorTests, ConstSize) {
   // size() must be const so it can be called on a const reference
   std::vector<int> vec;
@@ -146,6 +271,16 @@ TEST_GROUP(StringTests){};
 
 TEST(StringTests, ConstructDestruct) { std::string str; }
 
+TEST(StringTests, MoveAssign) {
+  std::string a = "abc";
+  std::string b = "xy";
+  b = std::move(a);
+  CHECK(strcmp(b.c_str(), "abc") == 0);
+  CHECK_EQUAL(0, (int)a.size());
+  a = "again";
+  CHECK(strcmp(a.c_str(), "again") == 0);
+}
+
 TEST(StringTests, ToStringData) {
   std::string str = std::to_string(12345);
   for (int i = 0; i < 5; ++i)
@@ -295,6 +430,22 @@ TEST(UnorderedMapTests, EmptyCount) {
   CHECK_EQUAL(0, (int)map.count(1));
 }
 
+TEST(UnorderedMapTests, EmptyDoesNotAllocate) {
+  std::unordered_map<int, int> map;
+  CHECK_EQUAL(0, (int)map.count(1));
+  CHECK_EQUAL(0, (int)map.bucket_count());
+}
+
+TEST(UnorderedMapTests, MoveConstruct) {
+  std::unordered_map<int, int> a;
+  a.insert(std::make_pair(1, 10));
+  std::unordered_map<int, int> b(std::move(a));
+  CHECK_EQUAL(10, b.at(1));
+  CHECK_EQUAL(0, (int)a.count(1));
+  a.insert(std::make_pair(2, 20));
+  CHECK_EQUAL(20, a.at(2));
+}
+
 TEST(UnorderedMapTests, InsertAndCount) {
   std::unordered_map<int, int> map;
   map.insert(std::make_pair(1, 42));
@@ -362,6 +513,83 @@ TEST(UnorderedMapTests, LargerDataUnevenlyDistributed) {
   }
 }
 
+TEST(UnorderedMapTests, InsertReturnsNewSlot) {
+  std::unordered_map<int, int> map;
+  for (int i = 0; i < 200; ++i) {
+    std::pair<bool, int &> result = map.insert(std::make_pair(i, 0));
+    CHECK(result.first);
+    result.second = i * 3;
+  }
+  for (int i = 0; i < 200; ++i)
+    CHECK_EQUAL(i * 3, map.at(i));
+}
+
+TEST(UnorderedMapTests, Erase) {
+  std::unordered_map<int, int> map;
+  for (int i = 0; i < 100; ++i)
+    map.insert(std::make_pair(i, i));
+  for (int i = 0; i < 100; i += 2)
+    CHECK_EQUAL(1, (int)map.erase(i));
+  CHECK_EQUAL(0, (int)map.erase(0));
+  CHECK_EQUAL(50, (int)map.size());
+  for (int i = 0; i < 100; ++i)
+    CHECK_EQUAL(i % 2, (int)map.count(i));
+  for (int i = 1; i < 100; i += 2)
+    CHECK_EQUAL(i, map.at(i));
+}
+
+TEST(UnorderedMapTests, InsertAfterEraseChurn) {
+  // no tombstones: repeated insert/erase must not fill the table
+  std::unordered_map<int, int> map;
+  for (int i = 0; i < 10000; ++i) {
+    map.insert(std::make_pair(i, i));
+    if (i >= 20)
+      map.erase(i - 20);
+  }
+  CHECK_EQUAL(20, (int)map.size());
+  CHECK(map.bucket_count() <= 32);
+  for (int i = 9980; i < 10000; ++i)
+    CHECK_EQUAL(i, map.at(i));
+}
+
+TEST(UnorderedMapTests, ReserveAvoidsRehash) {
+  std::unordered_map<int, int> map;
+  map.reserve(1000);
+  size_t buckets = map.bucket_count();
+  CHECK(buckets >= 1000);
+  for (int i = 0; i < 1000; ++i)
+    map.insert(std::make_pair(i, -i));
+  CHECK_EQUAL((int)buckets, (int)map.bucket_count());
+  for (int i = 0; i < 1000; ++i)
+    CHECK_EQUAL(-i, map.at(i));
+}
+
+TEST(UnorderedMapTests, ClearKeepsBuckets) {
+  std::unordered_map<int, int> map;
+  for (int i = 0; i < 100; ++i)
+    map.insert(std::make_pair(i, i));
+  size_t buckets = map.bucket_count();
+  map.clear();
+  CHECK(map.empty());
+  CHECK_EQUAL(0, (int)map.count(5));
+  CHECK_EQUAL((int)buckets, (int)map.bucket_count());
+  map.insert(std::make_pair(5, 6));
+  CHECK_EQUAL(6, map.at(5));
+}
+
+TEST(UnorderedMapTests, PointerKeys) {
+  // aligned pointers share their low bits, the hash must still spread them
+  static double objects[1000];
+  std::unordered_map<void *, int> map;
+  for (int i = 0; i < 1000; ++i)
+    map.insert(std::make_pair((void *)&objects[i], i));
+  for (int i = 0; i < 1000; ++i)
+    CHECK_EQUAL(i, map.at(&objects[i]));
+  map.erase(&objects[500]);
+  CHECK_EQUAL(0, (int)map.count(&objects[500]));
+  CHECK_EQUAL(501, map.at(&objects[501]));
+}
+
 // ─────────────────────────────────────────────────────────────────────────────
 
 // ── xfail demos ──────────────────────────────────────────────────────────────
@@ -0,0 +1,78 @@
+import subprocess
+from pathlib import Path
+
+ROOT = Path(__file__).parent.parent
+CONVERT = ROOT / "design_convert"
+RUNNER = ROOT / "run_single_design_xml"
+
+# a goal box with a rod jointed to its corner and a wheel on the rod's far
+# end, over a tilted ground; numbers with no short binary form on purpose
+DESIGN = (
+    '<?xml version="1.0"?><retrieveLevel><levelId>42</levelId><level>'
+    "<levelBlocks><StaticRectangle><rotation>0.1</rotation>"
+    "<position><x>0</x><y>120.3</y></position><width>900.7</width>"
+    "<height>20</height><goalBlock>false</goalBlock><joints></joints>"
+    "</StaticRectangle></levelBlocks>"
+    '<playerBlocks><JointedDynamicRectangle id="0"><rotation>0</rotation>'
+    "<position><x>0</x><y>0</y></position><width>20</width><height>20</height>"
+    "<goalBlock>true</goalBlock><joints></joints></JointedDynamicRectangle>"
+    '<HollowRod id="1"><rotation>0</rotation>'
+    "<position><x>30</x><y>10</y></position><width>40</width><height>4</height>"
+    "<goalBlock>false</goalBlock><joints><jointedTo>0</jointedTo></joints>"
+    "</HollowRod>"
+    '<NoSpinWheel id="2"><rotation>0.3333333333333333</rotation>'
+    "<position><x>50</x><y>10</y></position><width>20</width>"
+    "<height>20</height><goalBlock>false</goalBlock>"
+    "<joints><jointedTo>1</jointedTo></joints></NoSpinWheel></playerBlocks>"
+    "<start><position><x>0</x><y>0</y></position><width>300.25</width>"
+    "<height>200</height></start>"
+    "<end><position><x>200</x><y>100</y></position><width>100</width>"
+    "<height>100</height></end></level></retrieveLevel>"
+).encode()
+
+
+def _run(args, stdin):
+    result = subprocess.run(args, input=stdin, capture_output=True, timeout=30)
+    assert result.returncode == 0, result.stderr.decode()
+    return result.stdout
+
+
+def test_round_trip_is_exact():
+    binary = _run([str(CONVERT), "bin"], DESIGN)
+    xml = _run([str(CONVERT), "xml"], binary)
+    assert _run([str(CONVERT), "bin"], xml) == binary
+
+
+def test_binary_is_compact():
+    binary = _run([str(CONVERT), "bin"], DESIGN)
+    assert binary[:4] == b"FCDB"
+    assert len(binary) * 3 < len(DESIGN)
+
+
+def test_binary_simulates_like_xml():
+    binary = _run([str(CONVERT), "bin"], DESIGN)
+    assert _run([str(RUNNER), "500"], binary) == _run([str(RUNNER), "500"], DESIGN)
+
+
+def test_truncated_binary_rejected():
+    binary = _run([str(CONVERT), "bin"], DESIGN)
+    result = subprocess.run(
+        [str(CONVERT), "xml"], input=binary[:-1], capture_output=True, timeout=30
+    )
+    assert result.returncode != 0
+
+
+def test_wrapping_block_counts_rejected():
+    binary = _run([str(CONVERT), "bin"], DESIGN)
+    # 1 level and 3 player blocks; these pairs also add up to 4 in 32 bits
+    for level, player in ((0xFFFFFFFF, 5), (5, 0xFFFFFFFF)):
+        bad = (
+            binary[:12]
+            + level.to_bytes(4, "little")
+            + player.to_bytes(4, "little")
+            + binary[20:]
+        )
+        result = subprocess.run(
+            [str(CONVERT), "xml"], input=bad, capture_output=True, timeout=30
+        )
+        assert result.returncode == 1, result.stderr.decode()
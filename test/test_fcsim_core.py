@@ -0,0 +1,79 @@
+import ctypes
+import subprocess
+from pathlib import Path
+
+import pytest
+
+from test_design_convert import DESIGN
+
+ROOT = Path(__file__).parent.parent
+HARNESS = ROOT / "fcsim_core_test"
+RUNNER = ROOT / "run_single_design_xml"
+MAX_TICKS = "300"
+
+# the goal area moved under the goal box, which reaches it on tick 16
+SOLVING = DESIGN.replace(
+    b"<x>200</x><y>100</y></position><width>100</width>",
+    b"<x>60</x><y>80</y></position><width>200</width>",
+)
+
+
+def _run(args, stdin):
+    result = subprocess.run(args, input=stdin, capture_output=True, timeout=60)
+    assert result.returncode == 0, result.stdout.decode() + result.stderr.decode()
+    return result
+
+
+@pytest.mark.parametrize("design", [DESIGN, SOLVING], ids=["unsolved", "solved"])
+def test_matches_runner(design):
+    lib = _run([str(HARNESS), MAX_TICKS, "4"], design)
+    cli = _run([str(RUNNER), MAX_TICKS], design)
+    lines = lib.stdout.decode().splitlines()
+    assert lines[:2] == cli.stdout.decode().splitlines()
+    assert "threads agree: 4 of 4" in lines
+    assert "truncated design rejected: yes" in lines
+    # the same body states before every tick
+    assert lib.stderr == cli.stderr
+
+
+def test_solve_tick():
+    lines = _run([str(HARNESS), MAX_TICKS], SOLVING).stdout.decode().splitlines()
+    assert lines[:2] == ["16", "16"]
+
+
+def _library():
+    lib = ctypes.CDLL(str(ROOT / "libfcsim_core.so"))
+    lib.fcsim_design_load.restype = ctypes.c_void_p
+    lib.fcsim_design_load.argtypes = [ctypes.c_char_p, ctypes.c_size_t]
+    lib.fcsim_design_free.argtypes = [ctypes.c_void_p]
+    lib.fcsim_world_create.restype = ctypes.c_void_p
+    lib.fcsim_world_create.argtypes = [ctypes.c_void_p]
+    lib.fcsim_world_free.argtypes = [ctypes.c_void_p]
+    lib.fcsim_world_step.restype = ctypes.c_int64
+    lib.fcsim_world_step.argtypes = [ctypes.c_void_p, ctypes.c_int64]
+    lib.fcsim_world_run.restype = ctypes.c_int64
+    lib.fcsim_world_run.argtypes = [ctypes.c_void_p, ctypes.c_int64]
+    return lib
+
+
+def test_shared_library():
+    lib = _library()
+    design = lib.fcsim_design_load(SOLVING, len(SOLVING))
+    assert design
+    world = lib.fcsim_world_create(design)
+    assert lib.fcsim_world_run(world, 300) == 16
+    lib.fcsim_world_free(world)
+    lib.fcsim_design_free(design)
+    assert not lib.fcsim_design_load(b"<retrieveLevel>", 15)
+
+
+def test_run_past_max_ticks():
+    lib = _library()
+    design = lib.fcsim_design_load(DESIGN, len(DESIGN))
+    world = lib.fcsim_world_create(design)
+    assert lib.fcsim_world_step(world, 50) == 50
+    # already past the limit: returns without stepping
+    assert lib.fcsim_world_run(world, 20) == -1
+    assert lib.fcsim_world_step(world, 0) == 50
+    lib.fcsim_world_free(world)
+    lib.fcsim_design_free(design)
@@ -0,0 +1,24 @@
+import subprocess
+from pathlib import Path
+
+import pytest
+
+ROOT = Path(__file__).parent.parent
+
+# The harness takes [count] [threads]; CI runs a modest count. For a full
+# equivalence run, invoke the binary directly, e.g. ./fpmath_test 4000000000
+COUNT = "2000000"
+
+
+@pytest.mark.parametrize("binary", ["fpmath_test", "fpmath_test-fpatan"])
+def test_fp_atan2_equivalence(binary):
+    result = subprocess.run(
+        [str(ROOT / binary), COUNT],
+        capture_output=True,
+        text=True,
+        timeout=120,
+    )
+    assert result.returncode == 0, result.stdout + result.stderr
+    assert "\nmismatches: 0" in result.stdout
+    assert "strtod mismatches: 0" in result.stdout
+    assert "dtoa mismatches: 0" in result.stdout
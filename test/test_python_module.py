@@ -0,0 +1,163 @@
+import subprocess
+import sys
+import threading
+from pathlib import Path
+
+import pytest
+
+from test_design_convert import DESIGN
+from test_fcsim_core import SOLVING
+
+ROOT = Path(__file__).parent.parent
+RUNNER = ROOT / "run_single_design_xml"
+MAX_TICKS = 300
+
+sys.path.insert(0, str(ROOT))
+import fcsim_core  # noqa: E402
+
+
+def _runner(design, max_ticks):
+    result = subprocess.run(
+        [str(RUNNER), str(max_ticks)], input=design, capture_output=True, timeout=60
+    )
+    assert result.returncode == 0, result.stderr.decode()
+    return result
+
+
+def _trace(stderr):
+    """[[(x, y, vx, vy, angle, angular velocity)] per design block] per tick"""
+    ticks = []
+    for line in stderr.decode().splitlines():
+        if line.startswith("Tick "):
+            ticks.append([])
+        elif line.startswith("- ID = "):
+            pos = line.split("Pos = (")[1].split(")")[0].split(", ")
+            vel = line.split("Vel = (")[1].split(")")[0].split(", ")
+            ang = line.split("Ang = ")[1].split(",")[0]
+            ang_vel = line.split("AngVel = ")[1]
+            ticks[-1].append(tuple(float(v) for v in pos + vel + [ang, ang_vel]))
+    return ticks
+
+
+@pytest.mark.parametrize("design", [DESIGN, SOLVING], ids=["unsolved", "solved"])
+def test_run_matches_runner(design):
+    cli = _runner(design, MAX_TICKS).stdout.decode().split()
+    world = fcsim_core.World(fcsim_core.Design(design))
+    solve_tick = world.run(MAX_TICKS)
+    assert [str(solve_tick), str(world.tick)] == cli
+    assert world.solve_tick == solve_tick
+    assert world.goal_reached == (solve_tick != -1)
+
+
+def test_record_matches_trace():
+    ticks = 20
+    design = fcsim_core.Design(DESIGN)
+    # the runner traces the state before each tick it steps
+    trace = _trace(_runner(DESIGN, ticks + 1).stderr)
+    states = memoryview(fcsim_core.World(design).record(ticks)).tolist()
+    player = [i for i, block in enumerate(design.blocks) if not block[3]]
+    for tick in range(1, ticks + 1):
+        got = [states[tick - 1][i] for i in player]
+        # x, y, angle, vx, vy, angular velocity
+        got = [(s[0], s[1], s[3], s[4], s[2], s[5]) for s in got]
+        assert got == trace[tick], f"tick {tick}"
+
+
+def test_body_states_buffer():
+    design = fcsim_core.Design(DESIGN)
+    world = fcsim_core.World(design)
+    states = world.record(3)
+    view = memoryview(states)
+    assert view.format == "d"
+    assert view.shape == (3, len(design.blocks), 6) == states.shape
+    assert view.c_contiguous
+    assert len(states) == 3
+    # no copy: every view is of the same memory
+    flat = view.cast("B").cast("d")
+    flat[0] = 1234.5
+    assert memoryview(states).tolist()[0][0][0] == 1234.5
+
+    snapshot = memoryview(world.snapshot())
+    assert snapshot.shape == (len(design.blocks), 6)
+    assert snapshot.tolist() == view.tolist()[2]
+
+
+def test_step():
+    world = fcsim_core.World(fcsim_core.Design(SOLVING))
+    assert world.step() == 1
+    assert world.step(15) == 16
+    assert world.solve_tick == 16
+    # step goes on past the solve, unlike run
+    assert world.step(4) == 20
+    assert world.run(MAX_TICKS) == 16
+    assert world.tick == 20
+
+
+def test_busy_world():
+    world = fcsim_core.World(fcsim_core.Design(DESIGN))
+    ticks = 20000
+    worker = threading.Thread(target=world.record, args=(ticks,))
+    worker.start()
+    seen = set()
+    while worker.is_alive():
+        # never a tick from the middle of the recording
+        try:
+            seen.add(world.tick)
+        except RuntimeError:
+            seen.add("busy")
+        try:
+            world.snapshot()
+        except RuntimeError:
+            pass
+    worker.join()
+    assert seen <= {0, ticks, "busy"}
+    assert world.tick == ticks
+
+
+def test_blocks_and_fingerprint():
+    design = fcsim_core.Design(DESIGN)
+    again = fcsim_core.Design(DESIGN)
+    assert design.fingerprint == again.fingerprint
+    assert design.fingerprint != fcsim_core.Design(SOLVING).fingerprint
+    blocks = design.blocks
+    assert [b for b in blocks if b[2]] == [(0, 4, True, False)]
+    assert blocks[0][3] and not blocks[-1][3]
+
+
+@pytest.mark.parametrize("threads", [0, 1, 3])
+def test_evaluate_many(threads):
+    designs = [fcsim_core.Design(d) for d in (DESIGN, SOLVING) * 4]
+    expected = []
+    for design in designs:
+        world = fcsim_core.World(design)
+        expected.append((world.run(MAX_TICKS), world.tick))
+    got = fcsim_core.evaluate_many(designs, MAX_TICKS, threads=threads)
+    assert got == expected
+    assert fcsim_core.evaluate_many([], MAX_TICKS) == []
+
+
+def test_evaluate_many_list_changed():
+    ticks = 20000
+    expected = []
+    for design in (DESIGN, SOLVING):
+        world = fcsim_core.World(fcsim_core.Design(design))
+        expected.append((world.run(ticks), world.tick))
+    # the list holds the only reference to each design
+    designs = [fcsim_core.Design(d) for d in (DESIGN, SOLVING) * 32]
+    clearer = threading.Timer(0.02, designs.clear)
+    clearer.start()
+    got = fcsim_core.evaluate_many(designs, ticks, threads=1)
+    clearer.join()
+    assert designs == []
+    assert got == expected * 32
+
+
+def test_bad_input():
+    with pytest.raises(ValueError):
+        fcsim_core.Design(DESIGN[: len(DESIGN) // 2])
+    with pytest.raises(ValueError):
+        fcsim_core.load_ftlib("10 1  4 1 0 0")
+    with pytest.raises(TypeError):
+        fcsim_core.evaluate_many([DESIGN], MAX_TICKS)
+    with pytest.raises(ValueError):
+        fcsim_core.World(fcsim_core.Design(DESIGN)).record(-1)
@@ -0,0 +1,84 @@
+import os
+import subprocess
+from pathlib import Path
+
+from test_design_convert import DESIGN
+from test_run_single_design import CASES
+
+ROOT = Path(__file__).parent.parent
+HEADER = 8
+RECORD = 48
+
+
+def _run(binary, args, stdin, cache):
+    env = dict(os.environ, FCSIM_RESULT_CACHE=str(cache))
+    result = subprocess.run(
+        [str(ROOT / binary)] + args,
+        input=stdin,
+        capture_output=True,
+        env=env,
+        timeout=60,
+    )
+    assert result.returncode == 0, result.stderr.decode()
+    return result.stdout.decode()
+
+
+def _ftlib(stdin, cache):
+    return _run("run_single_design", [], stdin.encode(), cache)
+
+
+def test_hit_gives_same_result(tmp_path):
+    cache = tmp_path / "results.fcrc"
+    for _, stdin, solve_tick, end_tick in CASES:
+        expected = f"{solve_tick}\n{end_tick}\n"
+        assert _ftlib(stdin, cache) == expected
+        size = cache.stat().st_size
+        assert _ftlib(stdin, cache) == expected
+        # answered from the cache, so nothing new was stored
+        assert cache.stat().st_size == size
+    assert cache.stat().st_size == HEADER + RECORD * len(CASES)
+
+
+def test_max_ticks_is_part_of_the_key(tmp_path):
+    cache = tmp_path / "results.fcrc"
+    stdin = CASES[1][1]
+    assert _ftlib(stdin, cache) == "-1\n10\n"
+    assert _ftlib("20" + stdin[2:], cache) == "-1\n20\n"
+
+
+def test_xml_runner_single_and_stream(tmp_path):
+    cache = tmp_path / "results.fcrc"
+    single = _run("run_single_design_xml", ["300"], DESIGN, cache)
+    stream = _run("run_single_design_xml", ["300", "--stream"], DESIGN * 3, cache)
+    # the same design in either mode is one entry
+    assert stream == (" ".join(single.split()) + "\n") * 3
+    assert cache.stat().st_size == HEADER + RECORD
+
+
+def test_corrupted_record_is_ignored(tmp_path):
+    cache = tmp_path / "results.fcrc"
+    stdin = CASES[0][1]
+    _ftlib(stdin, cache)
+    data = bytearray(cache.read_bytes())
+    data[HEADER + 24] ^= 0x40  # solve_tick
+    cache.write_bytes(bytes(data))
+    assert _ftlib(stdin, cache) == "1\n1\n"
+    assert cache.stat().st_size == HEADER + 2 * RECORD
+
+
+def test_torn_record_is_cut_off(tmp_path):
+    cache = tmp_path / "results.fcrc"
+    stdin = CASES[0][1]
+    _ftlib(stdin, cache)
+    cache.write_bytes(cache.read_bytes()[: HEADER + 20])
+    assert _ftlib(stdin, cache) == "1\n1\n"
+    assert cache.stat().st_size == HEADER + RECORD
+    assert _ftlib(stdin, cache) == "1\n1\n"
+    assert cache.stat().st_size == HEADER + RECORD
+
+
+def test_other_files_are_left_alone(tmp_path):
+    cache = tmp_path / "not_a_cache.txt"
+    cache.write_bytes(b"some other file\n")
+    assert _ftlib(CASES[0][1], cache) == "1\n1\n"
+    assert cache.read_bytes() == b"some other file\n"
@@ -26,6 +26,41 @@ CASES = [
     ),
 ]
 
+# Every ftlib piece type once: the static and dynamic pieces are level blocks,
+# the circles give diameters, and the rods are jointed to the wheels and goal
+# pieces. The goal pieces reach the goal area on tick 38.
+ALL_PIECES = """300 12
+0 0 0 300 400 20 0 -1 -1
+1 1 -150 200 60 60 0 -1 -1
+2 2 100 100 30 30 0.3 -1 -1
+3 3 -100 0 40 40 0 -1 -1
+4 4 0 0 40 40 0 -1 -1
+5 5 60 0 30 30 0 -1 -1
+6 6 -60 0 30 30 0 -1 -1
+7 7 -60 60 30 30 0 -1 -1
+8 8 60 60 30 30 0 -1 -1
+9 9 -60 30 60 4 1.5707963267948966 6 7
+10 10 30 0 60 8 0 4 5
+10 11 0 60 120 8 0 7 8
+-500 -500 1000 1000  0 250 200 60
+"""
+
+# (id, FCSIM_* type, goal, level) of each ALL_PIECES block as loaded
+ALL_PIECES_BLOCKS = [
+    (0, 0, False, True),
+    (1, 1, False, True),
+    (2, 2, False, True),
+    (3, 3, False, True),
+    (4, 4, True, False),
+    (5, 5, True, False),
+    (6, 8, False, False),
+    (7, 9, False, False),
+    (8, 10, False, False),
+    (9, 11, False, False),
+    (10, 12, False, False),
+    (11, 12, False, False),
+]
+
 
 def pytest_generate_tests(metafunc):
     if "case" in metafunc.fixturenames:
@@ -54,3 +89,38 @@ def test_run_single_design(case):
     assert (
         end_tick == expected_end_tick
     ), f"end_tick: expected {expected_end_tick}, got {end_tick}"
+
+
+def test_run_single_design_in_process(case):
+    """The same cases through the Python module, with no process per case"""
+    from test_python_module import fcsim_core
+
+    description, stdin_str, expected_solve_tick, expected_end_tick = case
+    design, max_ticks = fcsim_core.load_ftlib(stdin_str)
+    world = fcsim_core.World(design)
+    assert world.run(max_ticks) == expected_solve_tick
+    assert world.tick == expected_end_tick
+
+
+def test_all_pieces_in_process():
+    """Every piece type, circles and joints load and run the same in process"""
+    from test_python_module import _trace, fcsim_core
+
+    result = subprocess.run(
+        [str(BINARY)], input=ALL_PIECES.encode(), capture_output=True, timeout=10
+    )
+    assert result.returncode == 0, result.stderr.decode()
+    assert result.stdout.decode().split() == ["38", "38"]
+    # the runner traces the state before each tick it steps
+    trace = _trace(result.stderr)
+
+    design, max_ticks = fcsim_core.load_ftlib(ALL_PIECES)
+    assert max_ticks == 300
+    assert design.blocks == ALL_PIECES_BLOCKS
+    states = memoryview(fcsim_core.World(design).record(37)).tolist()
+    player = [i for i, block in enumerate(ALL_PIECES_BLOCKS) if not block[3]]
+    for tick in range(1, 38):
+        # x, y, angle, vx, vy, angular velocity
+        got = [states[tick - 1][i] for i in player]
+        got = [(s[0], s[1], s[3], s[4], s[2], s[5]) for s in got]
+        assert got == trace[tick], f"tick {tick}"
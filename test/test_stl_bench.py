@@ -0,0 +1,29 @@
+import subprocess
+from pathlib import Path
+
+ROOT = Path(__file__).parent.parent
+
+# CI only checks that both builds agree. For timings, run the binaries
+# directly with more rounds, e.g. ./stl_bench 2000 && ./stl_bench-std 2000
+ROUNDS = "5"
+
+
+def _checksums(binary):
+    result = subprocess.run(
+        [str(ROOT / binary), ROUNDS],
+        capture_output=True,
+        text=True,
+        timeout=120,
+    )
+    assert result.returncode == 0, result.stdout + result.stderr
+    lines = result.stdout.strip().splitlines()[1:]
+    return [(line.split()[0], line.split()[-1]) for line in lines]
+
+
+def test_stl_mock_matches_std():
+    # the stl_mock build runs its extra _legacy workloads last, so the
+    # workloads both builds run come first and carry the same checksums
+    mock = _checksums("stl_bench")
+    std = _checksums("stl_bench-std")
+    assert mock[: len(std)] == std
+    assert all(name.endswith("_legacy") for name, _ in mock[len(std) :])
@@ -0,0 +1,45 @@
+import subprocess
+from pathlib import Path
+
+from test_design_convert import DESIGN
+
+RUNNER = Path(__file__).parent.parent / "run_single_design_xml"
+MAX_TICKS = "300"
+
+
+def _single():
+    result = subprocess.run(
+        [str(RUNNER), MAX_TICKS], input=DESIGN, capture_output=True, timeout=30
+    )
+    assert result.returncode == 0, result.stderr.decode()
+    return " ".join(result.stdout.decode().split()) + "\n"
+
+
+def _stream(args, stdin=None):
+    return subprocess.run(
+        [str(RUNNER), MAX_TICKS, "--stream"] + args,
+        input=stdin,
+        capture_output=True,
+        timeout=60,
+    )
+
+
+def test_stream_from_pipe():
+    corpus = DESIGN + b"\n" + DESIGN + DESIGN + b"\n\n"
+    result = _stream([], corpus)
+    assert result.returncode == 0, result.stderr.decode()
+    assert result.stdout.decode() == _single() * 3
+
+
+def test_stream_from_file(tmp_path):
+    corpus = tmp_path / "corpus.xml"
+    corpus.write_bytes(DESIGN * 4)
+    result = _stream([str(corpus)])
+    assert result.returncode == 0, result.stderr.decode()
+    assert result.stdout.decode() == _single() * 4
+
+
+def test_stream_stops_at_bad_document():
+    result = _stream([], DESIGN + DESIGN[:-40])
+    assert result.returncode != 0
+    assert result.stdout.decode() == _single()